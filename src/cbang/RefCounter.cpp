@@ -60,6 +60,22 @@ void RefCounter::_setCounter(
 void RefCounter::raise(const string &msg) {REFERENCE_ERROR(msg);}
 
 
+void RefCounter::released(bool weak, uint64_t prev) {
+  if (!(weak ? prev & 0xffffffff : prev >> 32)) raise("Already zero!");
+
+  if (!weak) {
+    dealloc();
+
+    // Drop the weak reference held on behalf of the strong references.  If
+    // it is the only one left nobody else can reach the counter.
+    if (counts.load(memory_order_acquire) != 1 &&
+        counts.fetch_sub(1, memory_order_acq_rel) != 1) return;
+  }
+
+  delete this;
+}
+
+
 void RefCounter::log(unsigned level, const char *fmt, ...) {
   if (!level) return;
 
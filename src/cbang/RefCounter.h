@@ -35,6 +35,8 @@
 #include "Deallocators.h"
 
 #include <atomic>
+#include <new>
+#include <utility>
 #include <string>
 #include <cstdint>
 
@@ -43,9 +45,24 @@ namespace cb {
   class RefCounted;
 
 
-  /// This class is used by SmartPointer to count pointer references
+  /**
+   * This class is used by SmartPointer to count pointer references.  The
+   * counts live here so copying and releasing a SmartPointer is inline and
+   * needs no virtual calls.  Subclasses only decide what happens when the
+   * strong count reaches zero.
+   *
+   * The strong count is kept in the upper 32 bits and the weak count in the
+   * lower.  While any strong reference exists the strong references together
+   * hold one weak reference, so the counter is deleted exactly once, by
+   * whichever thread drops the weak count to zero.
+   */
   class RefCounter {
+  public:
+    static constexpr uint64_t STRONG = 0x100000000ULL;
+
   protected:
+    std::atomic<uint64_t> counts{STRONG | 1}; // Start with one strong
+
     virtual ~RefCounter() {} // Prevent deallocation by others
 
   public:
@@ -54,17 +71,54 @@ namespace cb {
     static void _setCounter(const void *ptr, RefCounter *counter) {}
     static void _setCounter(const RefCounted *ptr, RefCounter *counter);
 
-    virtual bool isActive() const = 0;
-    virtual unsigned getCount(bool weak) const = 0;
-    virtual void incCount(bool weak) = 0;
-    virtual bool tryIncStrong() = 0;
-    virtual void decCount(bool weak) = 0;
+    bool isActive() const
+      {return counts.load(std::memory_order_acquire) >> 32;}
+
+
+    unsigned getCount(bool weak) const {
+      uint64_t c = counts.load(std::memory_order_acquire);
+      if (!weak) return c >> 32;
+      return (c & 0xffffffff) - ((c >> 32) ? 1 : 0);
+    }
+
+
+    void incCount(bool weak) {
+      // The caller already holds a reference so no ordering is needed
+      counts.fetch_add(weak ? 1 : STRONG, std::memory_order_relaxed);
+    }
+
+
+    bool tryIncStrong() {
+      uint64_t c = counts.load(std::memory_order_relaxed);
+      do {
+        if (!(c >> 32)) return false; // Object already destroyed
+      } while (!counts.compare_exchange_weak(c, c + STRONG,
+        std::memory_order_acq_rel, std::memory_order_relaxed));
+      return true;
+    }
+
+
+    void decCount(bool weak) {
+      uint64_t prev =
+        counts.fetch_sub(weak ? 1 : STRONG, std::memory_order_acq_rel);
+
+      // Fast path, the count did not reach zero
+      if (1 < (weak ? prev & 0xffffffff : prev >> 32)) return;
+      released(weak, prev);
+    }
+
+
     virtual void adopted() = 0;
 
     static void raise(const std::string &msg);
 
     [[gnu::format(printf, 3, 4)]]
     void log(unsigned level, const char *fmt, ...);
+
+  protected:
+    /// Called once, when the strong count reaches zero
+    virtual void dealloc() = 0;
+    void released(bool weak, uint64_t prev);
   };
 
 
@@ -78,13 +132,10 @@ namespace cb {
   class RefCounterImpl : public RefCounter {
   protected:
     T *ptr;
-    std::atomic<uint64_t> counts{0x100000000ULL}; // Start with one strong
 
     RefCounterImpl(T *ptr) : ptr(ptr) {}
 
   public:
-    static unsigned trace;
-
     static RefCounter *getCounter(T *ptr, bool weak) {
       RefCounter *counter = RefCounter::_getCounter(ptr);
 
@@ -104,85 +155,58 @@ namespace cb {
     }
 
     // From RefCounter
-    bool isActive() const override {return getCount(false);}
-
-    unsigned getCount(bool weak) const override {
-      return weak ? (counts & 0xffffffff) : (counts >> 32);
-    }
-
-    void incCount(bool weak) override {
-      uint64_t delta = weak ? 1 : 0x100000000ULL;
-      uint64_t prev  = counts.fetch_add(delta, std::memory_order_acq_rel);
-      uint32_t c     = (weak ? prev & 0xffffffff : prev >> 32) + 1;
-      log(trace, "incCount() count=%u", c);
+    void adopted() override {
+      if (counts.load() != (STRONG | 1))
+        raise("Can't adopt pointer with multiple references!");
+      _setCounter(ptr, 0);
+      delete this;
     }
 
-    bool tryIncStrong() override {
-      uint64_t c = counts.load(std::memory_order_relaxed);
-      do {
-        if (!(c >> 32)) return false; // Object already destroyed
-      } while (!counts.compare_exchange_weak(c, c + 0x100000000ULL,
-        std::memory_order_acq_rel, std::memory_order_relaxed));
-      return true;
+  protected:
+    void dealloc() override {
+      T *_ptr = ptr;
+      ptr = 0;
+      if (_ptr) DeallocT::dealloc(_ptr);
     }
+  };
 
-    void decCount(bool weak) override {
-      // Decrement the appropriate half atomically
-      uint64_t delta = weak ? 1 : 0x100000000ULL;
-      uint64_t prev = counts.fetch_sub(delta, std::memory_order_acq_rel);
-
-      uint32_t strongPrev = prev >> 32;
-      uint32_t weakPrev   = prev & 0xffffffff;
-
-      uint32_t c = weak ? weakPrev : strongPrev;
-      if (!c) raise("Already zero!");
 
-      log(trace, "decCount() count=%u", c - 1);
+  /// Holds the object in the same allocation as its counter.  See makeShared()
+  template<typename T>
+  class RefCounterShared : public RefCounter {
+    alignas(T) char storage[sizeof(T)];
 
-      if (!weak && strongPrev == 1) {
-        // Strong count just hit zero — deallocate the object
-        T *_ptr = ptr;
-        ptr = 0;
-        if (_ptr) DeallocT::dealloc(_ptr);
+  public:
+    template <typename... Args>
+    RefCounterShared(Args &&...args)
+      {new (storage) T(std::forward<Args>(args)...);}
 
-        // If there are also no weak refs, destroy the counter itself
-        if (!weakPrev) delete this;
-      }
+    T *get() {return (T *)storage;}
 
-      // Delete if weak count just hit zero and strong was already gone
-      if (weak && weakPrev == 1 && !strongPrev) delete this;
-    }
-
-    void adopted() override {
-      uint64_t c      = counts.load(std::memory_order_relaxed);
-      uint32_t strong = c >> 32;
-      uint32_t weak   = c & 0xffffffff;
+    // From RefCounter
+    void adopted() override
+      {raise("Can't adopt pointer created by makeShared()");}
 
-      if (1 < strong + weak)
-        raise("Can't adopt pointer with multiple references!");
-      _setCounter(ptr, 0);
-      delete this;
-    }
+  protected:
+    void dealloc() override {get()->~T();}
   };
 
 
-  template<typename T, class DeallocT>
-  unsigned RefCounterImpl<T, DeallocT>::trace = 0;
-
-
   class RefCounterPhonyImpl : public RefCounter {
     static RefCounterPhonyImpl singleton;
     RefCounterPhonyImpl() {}
 
   public:
-    static RefCounter *getCounter(const void *, bool) {return &singleton;}
+    static RefCounter *getCounter(const void *, bool) {
+      singleton.incCount(false);
+      return &singleton;
+    }
 
     // From RefCounter
-    bool isActive() const override {return true;}
-    unsigned getCount(bool weak) const override {return 1;}
-    void incCount(bool weak) override {}
-    bool tryIncStrong() override {return true;}
-    void decCount(bool weak) override {}
     void adopted() override {}
+
+  protected:
+    // The singleton keeps its own reference so this is never called
+    void dealloc() override {}
   };
 }
@@ -81,6 +81,9 @@ namespace cb {
    */
   class SmartPointerBase {
   public:
+    /// Tag for taking over a reference which has already been counted
+    struct Counted {};
+
     static void castError();
     static void referenceError(const std::string &msg);
   };
@@ -116,6 +119,17 @@ namespace cb {
      */
     SmartPointer(const PointerT &smartPtr) {*this = smartPtr;}
 
+    /// Take the reference from @param smartPtr without touching the count.
+    SmartPointer(PointerT &&smartPtr) noexcept :
+      refCounter(smartPtr.refCounter), ptr(smartPtr.ptr) {
+      smartPtr.refCounter = 0;
+      smartPtr.ptr = 0;
+    }
+
+    /// Take over a reference already counted in @param _refCounter.
+    SmartPointer(T *_ptr, RefCounter *_refCounter, Counted) :
+      refCounter(_refCounter), ptr(_ptr) {}
+
     /**
      * Create a smart pointer from a pointer value.  If ptr is
      * non-NULL the reference count will be set to one.
@@ -239,15 +253,26 @@ namespace cb {
       release();
 
       if (smartPtr.isSet()) {
+        // A strong source keeps the object alive, no need to check
         refCounter = smartPtr.refCounter;
+        refCounter->incCount(weak);
+        ptr = smartPtr.ptr;
+      }
 
-        if (weak) refCounter->incCount(true);
-        else if (!refCounter->tryIncStrong()) {
-          refCounter = 0;
-          ptr = 0;
-          return *this;
-        }
+      return *this;
+    }
+
+    /// Move assignment.  Takes the reference from @param smartPtr.
+    PointerT &operator=(PointerT &&smartPtr) noexcept {
+      if (this != &smartPtr) {
+        RefCounter *_refCounter = refCounter;
+
+        refCounter = smartPtr.refCounter;
         ptr = smartPtr.ptr;
+        smartPtr.refCounter = 0;
+        smartPtr.ptr = 0;
+
+        if (_refCounter) _refCounter->decCount(weak);
       }
 
       return *this;
@@ -301,10 +326,23 @@ namespace cb {
     /// Convert to a base type or weak pointer.
     template
       <typename _BaseT, bool _weak, typename _DeallocT, typename _CounterT>
-    operator SmartPointer<_BaseT, _weak, _DeallocT, _CounterT> () const {
+    operator SmartPointer<_BaseT, _weak, _DeallocT, _CounterT> () const & {
       return SmartPointer<_BaseT, _weak, _DeallocT, _CounterT>(ptr, refCounter);
     }
 
+    /// Convert a temporary, handing over its reference when possible.
+    template
+      <typename _BaseT, bool _weak, typename _DeallocT, typename _CounterT>
+    operator SmartPointer<_BaseT, _weak, _DeallocT, _CounterT> () && {
+      using TargetT = SmartPointer<_BaseT, _weak, _DeallocT, _CounterT>;
+      if (_weak != weak) return TargetT(ptr, refCounter);
+
+      TargetT target(ptr, refCounter, Counted());
+      ptr = 0;
+      refCounter = 0;
+      return target;
+    }
+
     /// Dynamic cast
     template <typename CastT>
     CastT *castPtr() const {
@@ -376,7 +414,7 @@ namespace cb {
     bool isNull() const {return !isSet();}
 
     /// @return True if the pointer is non-NULL, false otherwise.
-    bool isSet() const {return refCounter && refCounter->isActive() && ptr;}
+    bool isSet() const {return ptr && refCounter && refCounter->isActive();}
 
     bool isPhony() const {return dynamic_cast<CounterPhony *>(refCounter);}
 
@@ -410,6 +448,19 @@ namespace cb {
 
   template<typename T> inline static SmartPointer<T> ArrayPtr(T *ptr)
   {return typename SmartPointer<T>::Array(ptr);}
+
+
+  /**
+   * Construct a T and its reference counter in a single allocation.
+   * The object must not take a SmartPointer to itself in its constructor.
+   */
+  template<typename T, typename... Args>
+  inline static SmartPointer<T> makeShared(Args &&...args) {
+    auto counter = new RefCounterShared<T>(std::forward<Args>(args)...);
+    T *ptr = counter->get();
+    RefCounter::_setCounter(ptr, counter);
+    return SmartPointer<T>(ptr, counter, SmartPointerBase::Counted());
+  }
 }
 
 #define CBANG_SP(T)        cb::SmartPointer<T>
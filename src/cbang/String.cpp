@@ -89,17 +89,16 @@ namespace {
     bool big = x < -1e20 || 1e20 < x;
     string s = String::printf(big ? "%.*e" : "%.*f", precision, x);
 
-    int chop = 0;
+    // Drop trailing zeros from the fraction, keeping any exponent
     char point = use_facet<numpunct<char> >(cout.getloc()).decimal_point();
+    size_t e = big ? s.find('e') : s.length();
 
-    for (auto it = s.rbegin(); it != s.rend(); it++)
-      if (*it == '0' || *it == point) {
-        chop++;
-        if (*it == point) break;
-
-      } else break;
-
-    if (chop) s = s.substr(0, s.length() - chop);
+    if (s.find(point) < e) {
+      size_t i = e;
+      while (s[i - 1] == '0') i--;
+      if (s[i - 1] == point) i--;
+      s.erase(i, e - i);
+    }
 
     return s == "-0" ? "0" : s;
   }
@@ -169,6 +169,8 @@ namespace cb {
       void operator()(
         HTTP::Request &req, const HTTP::RequestCont &next) override;
       bool operator()(HTTP::Request &req) override;
+      // DB connections and timeseries websockets belong to the main loop
+      bool isThreadSafe() const override {return false;}
 
       using HandlerGroup::operator();
     };
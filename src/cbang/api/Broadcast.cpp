@@ -0,0 +1,81 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2021-2026, Cauldron Development  Oy
+                Copyright (c) 2003-2021, Cauldron Development LLC
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include "Broadcast.h"
+
+#include <cbang/json/Sink.h>
+
+using namespace std;
+using namespace cb;
+using namespace cb::API;
+
+
+const Event::Buffer &Broadcast::getFrames(
+  const JSON::ValuePtr &ref, format_t format) {
+  // Serialize as JSONWebsocket::send() would, with the shortest precision
+  const auto json = WS::JSONWebsocket::FORMAT_JSON;
+  string key;
+  if (ref.isSet())
+    WS::JSONWebsocket::encode(
+      json, key, [&] (JSON::Sink &sink) {ref->write(sink);});
+
+  auto it = frames.find({format, key});
+  if (it != frames.end()) return it->second;
+
+  // Wrap the serialized value the same way Context::reply() does
+  string msg;
+  auto opcode = WS::OpCode::WS_OP_BINARY;
+
+  if (format == json) {
+    if (data.empty())
+      WS::JSONWebsocket::encode(
+        json, data, [this] (JSON::Sink &sink) {value->write(sink);});
+
+    msg = key.empty() ? data : "{\"$ref\":" + key + ",\"data\":" + data + "}";
+    opcode = WS::OpCode::WS_OP_TEXT;
+
+  } else WS::JSONWebsocket::encode(format, msg, [&] (JSON::Sink &sink) {
+      if (ref.isNull()) return value->write(sink);
+
+      sink.beginDict();
+      sink.insert("$ref", *ref);
+      sink.beginInsert("data");
+      value->write(sink);
+      sink.endDict();
+    });
+
+  auto &buf = frames[{format, key}] = WS::Websocket::frame(msg, opcode);
+
+  // The FD pool threads drop their references to the frames
+  buf.enableLocking();
+  return buf;
+}
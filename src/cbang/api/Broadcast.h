@@ -0,0 +1,63 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2021-2026, Cauldron Development  Oy
+                Copyright (c) 2003-2021, Cauldron Development LLC
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#pragma once
+
+#include <cbang/json/Value.h>
+#include <cbang/event/Buffer.h>
+#include <cbang/ws/JSONWebsocket.h>
+
+#include <map>
+#include <string>
+
+
+namespace cb {
+  namespace API {
+    /// A Timeseries entry sent to many Websocket subscribers.  The value is
+    /// serialized once and framed once per distinct ``$ref`` and format.  The
+    /// frames are shared by reference between all the connections.
+    class Broadcast {
+      typedef WS::JSONWebsocket::format_t format_t;
+
+      JSON::ValuePtr value;
+      std::string data;
+      std::map<std::pair<format_t, std::string>, Event::Buffer> frames;
+
+    public:
+      Broadcast(const JSON::ValuePtr &value) : value(value) {}
+
+      const JSON::ValuePtr &getValue() const {return value;}
+      const Event::Buffer &getFrames(const JSON::ValuePtr &ref,
+        format_t format = WS::JSONWebsocket::FORMAT_JSON);
+    };
+  }
+}
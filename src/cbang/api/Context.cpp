@@ -49,6 +49,12 @@ Context::Context(API &api, const WebsocketPtr &ws) :
   Context(api, ws->getRequest()) {this->ws = ws;}
 
 
+JSON::ValuePtr Context::getRef() const {
+  if (ws.isNull()) return 0;
+  return resolver->select("msg.$ref");
+}
+
+
 void Context::parseBody() {
   if (!req.getInputBuffer().getLength()) return;
 
@@ -100,7 +106,7 @@ void Context::reply(
   HTTP::Status code, function<void (JSON::Sink &sink)> cb) const {
 
   if (ws.isSet()) {
-    auto ref = resolver->select("msg.$ref");
+    auto ref = getRef();
 
     if (ref.isNull()) ws->send(cb);
     else ws->send([&] (JSON::Sink &sink) {
@@ -64,6 +64,8 @@ namespace cb {
       const JSON::ValuePtr &getArgs() const {return args;}
       void setArgs(const JSON::ValuePtr &args) {this->args = args;}
 
+      JSON::ValuePtr getRef() const;
+
       void parseBody();
 
       void setSession(const SmartPointer<HTTP::Session> &session);
@@ -43,17 +43,39 @@ using namespace cb;
 using namespace cb::API;
 
 
-Query::Query(const QueryDef &def, callback_t cb) :
-  def(def), cb(cb), db(def.getDBConnection()) {
+Query::Query(const QueryDef &def, callback_t cb) : def(def), cb(cb) {
   if (!cb) THROW("Callback not set");
 }
 
 
+Query::~Query() {releaseDB(true);}
+
+
 void Query::exec(const string &sql, const vector<JSON::ValuePtr> &params) {
   // Stay alive until DB callbacks are complete
   auto self = SmartPtr(this);
-  auto cb = [self] (state_t state) {self->callback(state);};
-  db->query(cb, sql, params);
+
+  auto cb =
+    [self] (state_t state) {
+      self->callback(state);
+
+      // Return the connection to the pool
+      if (state == MariaDB::EventDB::EVENTDB_DONE ||
+          state == MariaDB::EventDB::EVENTDB_ERROR)
+        self->releaseDB(state == MariaDB::EventDB::EVENTDB_ERROR);
+    };
+
+  auto dbCB =
+    [self, cb, sql, params] (const SmartPointer<MariaDB::EventDB> &db) {
+      if (db.isNull())
+        return self->errorReply(HTTP_SERVICE_UNAVAILABLE,
+                                "Timed out waiting for a DB connection");
+
+      self->db = db;
+      db->query(cb, sql, params);
+    };
+
+  def.getDBConnection(dbCB);
 }
 
 
@@ -98,6 +120,14 @@ void Query::errorReply(HTTP::Status code, const string &msg) {
 }
 
 
+void Query::releaseDB(bool reset) {
+  if (db.isNull()) return;
+  auto db = this->db;
+  this->db.release();
+  def.releaseDBConnection(db, reset);
+}
+
+
 void Query::returnPass(MariaDB::EventDB::state_t state) {
   // Run the query and discard any results
   if (state != MariaDB::EventDB::EVENTDB_ROW) returnOk(state);
@@ -68,7 +68,7 @@ namespace cb {
 
     public:
       Query(const QueryDef &def, callback_t cb);
-      virtual ~Query() {}
+      virtual ~Query();
 
       void setContentType(const std::string &contentType)
         {this->contentType = contentType;}
@@ -82,6 +82,7 @@ namespace cb {
 
       void reply(HTTP::Status code = HTTP_OK);
       void errorReply(HTTP::Status code, const std::string &msg = "");
+      void releaseDB(bool reset);
 
       // MariaDB::EventDB callbacks
       void returnPass  (state_t state);
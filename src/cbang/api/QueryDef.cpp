@@ -57,8 +57,14 @@ QueryDef::QueryDef(API &api, const JSON::ValuePtr &config) :
 }
 
 
-SmartPointer<MariaDB::EventDB> QueryDef::getDBConnection() const {
-  return api.getDBConnector().getConnection();
+void QueryDef::getDBConnection(MariaDB::Connector::callback_t cb) const {
+  api.getDBConnector().getConnection(cb);
+}
+
+
+void QueryDef::releaseDBConnection(
+  const SmartPointer<MariaDB::EventDB> &db, bool reset) const {
+  api.getDBConnector().release(db, reset);
 }
 
 
@@ -35,6 +35,8 @@
 #include "Query.h"
 #include "Resolver.h"
 
+#include <cbang/db/maria/Connector.h>
+
 
 namespace cb {
   namespace API {
@@ -53,7 +55,9 @@ namespace cb {
       virtual ~QueryDef() {}
 
       const std::string &getSQL() const {return sql;}
-      virtual SmartPointer<MariaDB::EventDB> getDBConnection() const;
+      virtual void getDBConnection(MariaDB::Connector::callback_t cb) const;
+      void releaseDBConnection(
+        const SmartPointer<MariaDB::EventDB> &db, bool reset) const;
 
       SmartPointer<Query> query(const std::string &sql,
         Query::callback_t cb) const;
@@ -0,0 +1,139 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2021-2026, Cauldron Development  Oy
+                Copyright (c) 2003-2021, Cauldron Development LLC
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include "Rollup.h"
+
+#include <cbang/json/Sink.h>
+
+using namespace std;
+using namespace cb;
+using namespace cb::API;
+
+
+void Rollup::reset(uint64_t start) {
+  this->start = start;
+  count = 0;
+  last.release();
+  stats.clear();
+}
+
+
+void Rollup::load(uint64_t start, const JSON::Value &stored) {
+  reset(start);
+
+  count = stored.getU32("count", 0);
+  last  = stored.get("last", 0);
+  if (!count || !stored.has("avg")) return;
+
+  auto &min = *stored.get("min");
+  auto &max = *stored.get("max");
+  auto &avg = *stored.get("avg");
+
+  // Per field counts are not stored, assume every sample had every field
+  if (avg.isNumber())
+    load("", min.getNumber(), max.getNumber(), avg.getNumber());
+
+  else
+    for (auto e: avg.entries())
+      load(e.key(), min.getNumber(e.key()), max.getNumber(e.key()),
+        e.value()->getNumber());
+}
+
+
+void Rollup::add(const JSON::ValuePtr &value) {
+  count++;
+  last = value;
+
+  if (value->isNumber()) add("", value->getNumber());
+
+  else if (value->isDict())
+    for (auto e: value->entries())
+      if (e.value()->isNumber()) add(e.key(), e.value()->getNumber());
+}
+
+
+void Rollup::write(JSON::Sink &sink) const {
+  sink.beginDict();
+  sink.insert("count", count);
+
+  writeStat(sink, "min", [] (const Stats &s) {return s.min;});
+  writeStat(sink, "max", [] (const Stats &s) {return s.max;});
+  writeStat(sink, "avg", [] (const Stats &s) {return s.sum / s.count;});
+
+  if (last.isSet()) sink.insert("last", *last);
+  sink.endDict();
+}
+
+
+void Rollup::add(const string &name, double value) {
+  for (auto &s: stats)
+    if (s.name == name) {
+      if (value < s.min) s.min = value;
+      if (s.max < value) s.max = value;
+      s.sum += value;
+      s.count++;
+      return;
+    }
+
+  Stats s;
+  s.name  = name;
+  s.count = 1;
+  s.min   = s.max = s.sum = value;
+  stats.push_back(s);
+}
+
+
+void Rollup::load(const string &name, double min, double max, double avg) {
+  Stats s;
+  s.name  = name;
+  s.count = count;
+  s.min   = min;
+  s.max   = max;
+  s.sum   = avg * count;
+  stats.push_back(s);
+}
+
+
+void Rollup::writeStat(JSON::Sink &sink, const string &name,
+  double (*get)(const Stats &stats)) const {
+  if (stats.empty()) return;
+
+  sink.beginInsert(name);
+
+  // A numeric sample has a single unnamed stat
+  if (stats.size() == 1 && stats[0].name.empty())
+    return sink.write(get(stats[0]));
+
+  sink.beginDict();
+  for (auto &s: stats) sink.insert(s.name, get(s));
+  sink.endDict();
+}
@@ -0,0 +1,76 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2021-2026, Cauldron Development  Oy
+                Copyright (c) 2003-2021, Cauldron Development LLC
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#pragma once
+
+#include <cbang/json/Value.h>
+
+#include <string>
+#include <vector>
+
+
+namespace cb {
+  namespace API {
+    /// Accumulates the Timeseries samples which fall in one rollup interval.
+    /// Numeric values, or the numeric fields of dict values, are reduced to
+    /// their min, max and average.  The last sample is kept whole.
+    class Rollup {
+      struct Stats {
+        std::string name;
+        unsigned count = 0;
+        double min = 0;
+        double max = 0;
+        double sum = 0;
+      };
+
+      uint64_t start = 0;
+      unsigned count = 0;
+      JSON::ValuePtr last;
+      std::vector<Stats> stats;
+
+    public:
+      uint64_t getStart() const {return start;}
+      unsigned getCount() const {return count;}
+
+      void reset(uint64_t start);
+      void load(uint64_t start, const JSON::Value &stored);
+      void add(const JSON::ValuePtr &value);
+      void write(JSON::Sink &sink) const;
+
+    protected:
+      void add(const std::string &name, double value);
+      void load(const std::string &name, double min, double max, double avg);
+      void writeStat(JSON::Sink &sink, const std::string &name,
+        double (*get)(const Stats &stats)) const;
+    };
+  }
+}
@@ -56,7 +56,8 @@ void Subscriber::first(const JSON::ValuePtr &results) {
 }
 
 
-void Subscriber::next(const JSON::ValuePtr &result) {
-  if (init) cb(0, result);
-  else pending.push_back(result);
+void Subscriber::next(Broadcast &msg) {
+  if (!init) pending.push_back(msg.getValue());
+  else if (send) send(msg);
+  else cb(0, msg.getValue());
 }
\ No newline at end of file
@@ -32,6 +32,8 @@
 
 #pragma once
 
+#include "Broadcast.h"
+
 #include <cbang/json/Value.h>
 
 #include <functional>
@@ -45,22 +47,29 @@ namespace cb {
     public:
       using cb_t = std::function<void (
         const SmartPointer<Exception> &err, const JSON::ValuePtr &data)>;
+      using send_t = std::function<void (Broadcast &msg)>;
 
     protected:
       cb_t cb;
+      send_t send;
       SmartPointer<Timeseries> timeseries;
       uint64_t id;
+      uint64_t interval;
       bool init = true;
       std::vector<JSON::ValuePtr> pending;
 
     public:
-      Subscriber(cb_t cb, const SmartPointer<Timeseries> &timeseries,
-        uint64_t id) : cb(cb), timeseries(timeseries), id(id) {}
+      Subscriber(cb_t cb, send_t send,
+        const SmartPointer<Timeseries> &timeseries, uint64_t id,
+        uint64_t interval = 0) : cb(cb), send(send), timeseries(timeseries),
+        id(id), interval(interval) {}
       ~Subscriber();
 
+      uint64_t getInterval() const {return interval;}
+
       void error(const SmartPointer<Exception> &e);
       void first(const JSON::ValuePtr &results);
-      void next(const JSON::ValuePtr &results);
+      void next(Broadcast &msg);
     };
   }
 }
@@ -36,10 +36,16 @@
 #include "Resolver.h"
 
 #include <cbang/api/handler/TimeseriesHandler.h>
-#include <cbang/json/Reader.h>
+#include <cbang/json/BufferReader.h>
+#include <cbang/json/Builder.h>
+#include <cbang/json/CBORWriter.h>
+#include <cbang/json/CBORReader.h>
+#include <cbang/net/Swab.h>
 #include <cbang/log/Logger.h>
 
 #include <cmath>
+#include <cstring>
+#include <vector>
 
 using namespace std;
 using namespace cb;
@@ -50,6 +56,19 @@ using namespace cb::API;
 #define TIME_FMT "%Y%m%d%H%M%S"
 
 
+/*
+  Entries are stored with an 8 byte big-endian timestamp key and a CBOR value.
+  Older databases used a 14 character TIME_FMT key and a JSON text value.
+  Binary keys sort before the text keys, so both are read, newest first, until
+  the old entries age out.
+
+  Each rollup tier is a sub-namespace, "@" followed by the binary interval,
+  which sorts after both kinds of entry keys.  Its values are Rollup dicts
+  keyed by the start of their interval.  The current interval is rewritten as
+  samples arrive, so it is always up to date.
+*/
+
+
 namespace {
   JSON::ValuePtr makeEntry(uint64_t ts, const JSON::ValuePtr &value) {
     JSON::ValuePtr d = new JSON::Dict;
@@ -57,56 +76,171 @@ namespace {
     d->insert("time",  Time(ts).toString());
     return d;
   }
+
+
+  // Query results, decoded straight into the reply when written
+  class Entries : public JSON::List {
+    SmartPointer<EventLevelDB::results_t> results;
+
+  public:
+    Entries(const SmartPointer<EventLevelDB::results_t> &results) :
+      results(results) {}
+
+    // From JSON::Value
+    unsigned size() const override {return results->size();}
+
+    JSON::ValuePtr copy(bool deep = false) const override {
+      JSON::Builder builder;
+      write(builder);
+      return builder.getRoot();
+    }
+
+    void write(JSON::Sink &sink) const override {
+      sink.beginList();
+
+      for (auto &result: *results) {
+        bool binary = result.first.size() == 8;
+
+        sink.appendDict();
+        sink.beginInsert("value");
+        if (binary) JSON::CBORReader::parse(result.second, sink);
+        else JSON::BufferReader::parse(result.second, sink);
+
+        auto time = binary ? Timeseries::decodeTime(result.first) :
+          Time::parse(result.first, TIME_FMT);
+        sink.insert("time", Time(time).toString());
+        sink.endDict();
+      }
+
+      sink.endList();
+    }
+  };
 }
 
 
 Timeseries::Timeseries(TimeseriesHandler &handler, const string &key) :
-  handler(handler), key(key), db(handler.db.ns(key + "\0"s)) {}
+  handler(handler), key(key), db(handler.db.ns(key + "\0"s)) {
+  for (auto interval: handler.rollups)
+    tiers[interval].db = db.ns(rollupNS(interval));
+}
+
+
+uint64_t Timeseries::getInterval(uint64_t resolution) const {
+  // Use the coarsest tier which is no coarser than requested
+  uint64_t interval = 0;
+
+  for (auto &p: tiers)
+    if (p.first <= resolution) interval = p.first;
+
+  return interval;
+}
 
 
-void Timeseries::query(uint64_t since, unsigned maxResults, const cb_t &cb) {
-  auto _cb = [this, cb] (
+void Timeseries::query(uint64_t since, unsigned maxResults,
+  uint64_t resolution, const cb_t &cb) {
+  auto done = [this, cb] (
     const EventLevelDB::Status &status,
     const SmartPointer<EventLevelDB::results_t> &results) {
     if (!status.isOk()) return cb(status.getException(), 0);
+    LOG_DEBUG(5, results->size() << " results");
+    cb(0, new Entries(results));
+  };
 
-    JSON::ValuePtr data = new JSON::List;
-
-    for (auto &result: *results) {
-      auto time  = Time::parse(result.first, TIME_FMT);
-      auto value = JSON::Reader::parse(result.second);
-      data->append(makeEntry(time, value));
-    }
+  uint64_t interval = getInterval(resolution);
+  if (interval) {
+    // Include the interval containing ``since``
+    uint64_t start = since / interval * interval;
+    string last = start ? encodeTime(start - 1) : string();
 
-    LOG_DEBUG(5, data->size() << " results");
+    LOG_DEBUG(5, "getting max " << maxResults << " " << interval
+      << " second rollups since " << Time(start).toString());
+    return tiers.at(interval).db.range(done, "", last, true, 0, maxResults);
+  }
 
-    cb(0, data);
+  auto _cb = [=] (
+    const EventLevelDB::Status &status,
+    const SmartPointer<EventLevelDB::results_t> &results) {
+    if (!status.isOk() || maxResults <= results->size())
+      return done(status, results);
+
+    // Continue with entries in the old text format
+    auto textCB = [results, done] (
+      const EventLevelDB::Status &status,
+      const SmartPointer<EventLevelDB::results_t> &textResults) {
+      if (status.isOk())
+        results->insert(
+          results->end(), textResults->begin(), textResults->end());
+      done(status, results);
+    };
+
+    string last = since ? Time(since).toString(TIME_FMT) : "00000000000000";
+    db.range(textCB, "99999999999999", last, true, 0,
+      maxResults - results->size());
   };
 
-  string last = since ? Time(since).toString(TIME_FMT) : "00000000000000";
-  LOG_DEBUG(5, "getting max " << maxResults << " results since " << last);
-  db.range(_cb, "99999999999999", last, true, 0, maxResults);
+  LOG_DEBUG(5, "getting max " << maxResults << " results since "
+    << Time(since).toString());
+  db.range(_cb, "0", encodeTime(since), true, 0, maxResults);
 }
 
 
-void Timeseries::broadcast(uint64_t time, const JSON::ValuePtr &value) {
+void Timeseries::broadcast(uint64_t time, const JSON::ValuePtr &value,
+  uint64_t interval) {
   if (subscribers.empty()) return;
 
-  auto entry = makeEntry(time, value);
-  for (auto p: subscribers)
-    if (p.second.isSet()) p.second->next(entry);
+  // Subscribers may unsubscribe while the entry is being sent
+  vector<SmartPointer<Subscriber>> targets;
+  for (auto &p: subscribers)
+    if (p.second.isSet() && p.second->getInterval() == interval)
+      targets.push_back(p.second);
+
+  // The entry is serialized on demand and shared by all subscribers
+  Broadcast msg(makeEntry(time, value));
+  for (auto &subscriber: targets) subscriber->next(msg);
+}
+
+
+void Timeseries::rollup(LevelDB::Batch &batch, uint64_t time,
+  const JSON::ValuePtr &value) {
+  for (auto &p: tiers) {
+    uint64_t interval = p.first;
+    uint64_t start    = time / interval * interval;
+    Rollup  &rollup   = p.second.rollup;
+
+    // Resume from the stored aggregate, e.g. after a restart
+    if (!rollup.getCount() || rollup.getStart() != start) {
+      rollup.reset(start);
+
+      try {
+        string stored = p.second.db.LevelDB::get(encodeTime(start), "");
+        if (!stored.empty())
+          rollup.load(start, *JSON::CBORReader::parse(stored));
+      } CATCH_WARNING;
+    }
+
+    rollup.add(value);
+
+    batch.set(key + "\0"s + rollupNS(interval) + encodeTime(start),
+      JSON::CBORWriter::encode(rollup));
+
+    if (hasSubscribers(interval))
+      broadcast(start, JSON::Builder::build(
+        [&] (JSON::Sink &sink) {rollup.write(sink);}), interval);
+  }
 }
 
 
-SmartPointer<Subscriber> Timeseries::subscribe(
-  uint64_t id, uint64_t since, unsigned maxResults, const cb_t &cb) {
+SmartPointer<Subscriber> Timeseries::subscribe(uint64_t id, uint64_t since,
+  unsigned maxResults, uint64_t resolution, const cb_t &cb,
+  const send_t &send) {
 
   auto it = subscribers.find(id);
   if (it != subscribers.end() && it->second.isSet())
     THROWX("Timeseries already has subscriber with id " << id,
       HTTP::Status::HTTP_CONFLICT);
 
-  auto subscriber = SmartPtr(new Subscriber(cb, this, id));
+  uint64_t interval = getInterval(resolution);
+  auto subscriber = SmartPtr(new Subscriber(cb, send, this, id, interval));
   subscribers[id] = subscriber; // Save weak pointer
 
   auto _cb = [this, cb, id] (const SmartPointer<Exception> &err,
@@ -119,7 +253,7 @@ SmartPointer<Subscriber> Timeseries::subscribe(
     }
   };
 
-  query(since, maxResults, _cb);
+  query(since, maxResults, interval, _cb);
 
   return subscriber;
 }
@@ -130,3 +264,35 @@ void Timeseries::unsubscribe(uint64_t id) {
     THROWX("Timeseries does not have subscriber with id " << id,
       HTTP::Status::HTTP_NOT_FOUND);
 }
+
+
+string Timeseries::encodeTime(uint64_t ts) {
+  ts = hton64(ts);
+  return string((const char *)&ts, 8);
+}
+
+
+uint64_t Timeseries::decodeTime(const string &key) {
+  uint64_t ts;
+  memcpy(&ts, key.data(), 8);
+  return hton64(ts);
+}
+
+
+string Timeseries::encodeValue(const JSON::Value &value) {
+  return JSON::CBORWriter::encode(value);
+}
+
+
+bool Timeseries::hasSubscribers(uint64_t interval) const {
+  for (auto &p: subscribers)
+    if (p.second.isSet() && p.second->getInterval() == interval)
+      return true;
+
+  return false;
+}
+
+
+string Timeseries::rollupNS(uint64_t interval) {
+  return "@" + encodeTime(interval);
+}
@@ -33,6 +33,7 @@
 #pragma once
 
 #include "Subscriber.h"
+#include "Rollup.h"
 
 #include <cbang/event/Event.h>
 #include <cbang/db/EventLevelDB.h>
@@ -47,7 +48,8 @@ namespace cb {
 
     class Timeseries : public RefCounted {
     public:
-      using cb_t = Subscriber::cb_t;
+      using cb_t   = Subscriber::cb_t;
+      using send_t = Subscriber::send_t;
 
     protected:
       TimeseriesHandler &handler;
@@ -56,17 +58,37 @@ namespace cb {
       JSON::ValuePtr     last;
       std::map<uint64_t, SmartPointer<Subscriber>::Weak> subscribers;
 
+      struct Tier {
+        EventLevelDB db;
+        Rollup       rollup;
+      };
+
+      std::map<uint64_t, Tier> tiers;
+
     public:
       Timeseries(TimeseriesHandler &handler, const std::string &key);
 
-      void query(uint64_t since, unsigned maxResults, const cb_t &cb);
-      void broadcast(uint64_t time, const JSON::ValuePtr &value);
+      uint64_t getInterval(uint64_t resolution) const;
 
-      SmartPointer<Subscriber> subscribe(
-        uint64_t id, uint64_t since, unsigned maxResults, const cb_t &cb);
+      void query(uint64_t since, unsigned maxResults, uint64_t resolution,
+        const cb_t &cb);
+      void broadcast(uint64_t time, const JSON::ValuePtr &value,
+        uint64_t interval = 0);
+      void rollup(LevelDB::Batch &batch, uint64_t time,
+        const JSON::ValuePtr &value);
+
+      SmartPointer<Subscriber> subscribe(uint64_t id, uint64_t since,
+        unsigned maxResults, uint64_t resolution, const cb_t &cb,
+        const send_t &send = 0);
       void unsubscribe(uint64_t id);
 
+      static std::string encodeTime(uint64_t ts);
+      static uint64_t decodeTime(const std::string &key);
+      static std::string encodeValue(const JSON::Value &value);
+
     protected:
+      bool hasSubscribers(uint64_t interval) const;
+      static std::string rollupNS(uint64_t interval);
       void query(uint64_t ts);
       void query();
     };
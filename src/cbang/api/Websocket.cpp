@@ -45,8 +45,8 @@ using namespace cb::API;
 Websocket::~Websocket() {LOG_DEBUG(3, "~Websocket() ID " << getID());}
 
 
-void Websocket::subscribe(Timeseries &ts, uint64_t since,
-  unsigned maxCount, Timeseries::cb_t cb) {
+void Websocket::subscribe(Timeseries &ts, uint64_t since, unsigned maxCount,
+  uint64_t resolution, const JSON::ValuePtr &ref, Timeseries::cb_t cb) {
 
   auto _cb = [&, cb] (const SmartPointer<Exception> &err,
     const JSON::ValuePtr &data) {
@@ -57,7 +57,17 @@ void Websocket::subscribe(Timeseries &ts, uint64_t since,
     }
   };
 
-  subscriptions[&ts] = ts.subscribe(getID(), since, maxCount, _cb);
+  // Broadcasts are framed once and the frames shared between subscribers
+  auto send = [&, ref] (Broadcast &msg) {
+    try {
+      sendFrames(msg.getFrames(ref, getFormat()));
+    } catch (const Exception &e) {
+      unsubscribe(ts); // Cannot send so unsubscribe
+    }
+  };
+
+  subscriptions[&ts] =
+    ts.subscribe(getID(), since, maxCount, resolution, _cb, send);
 }
 
 
@@ -57,7 +57,7 @@ namespace cb {
       HTTP::Request &getRequest() const {return *req;}
 
       void subscribe(Timeseries &timeseries, uint64_t since, unsigned maxCount,
-        Timeseries::cb_t cb);
+        uint64_t resolution, const JSON::ValuePtr &ref, Timeseries::cb_t cb);
       void unsubscribe(Timeseries &timeseries);
 
       using WS::Websocket::send;
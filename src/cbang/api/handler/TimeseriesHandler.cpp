@@ -70,7 +70,9 @@
 #include <cbang/time/Timer.h>
 #include <cbang/openssl/Digest.h>
 #include <cbang/http/Status.h>
-#include <cbang/json/Reader.h>
+#include <cbang/json/BufferReader.h>
+
+#include <algorithm>
 
 using namespace std;
 using namespace cb;
@@ -78,7 +80,6 @@ using namespace cb::API;
 
 #undef CBANG_LOG_PREFIX
 #define CBANG_LOG_PREFIX "TS:" << name << ":"
-#define TIME_FMT "%Y%m%d%H%M%S"
 
 
 TimeseriesHandler::TimeseriesHandler(
@@ -90,6 +91,21 @@ TimeseriesHandler::TimeseriesHandler(
   if (name.empty()) THROW("Timeseries requires a name");
   if (!period) THROW("Timeseries period cannot be zero");
 
+  // Rollup tiers
+  if (config->has("rollups")) {
+    for (auto it: *config->get("rollups")) {
+      uint64_t interval = HumanDuration::parse(it->asString());
+
+      if (interval <= period || interval % period)
+        THROW("Timeseries rollup '" << it->asString()
+          << "' must be a multiple of the period");
+
+      rollups.push_back(interval);
+    }
+
+    sort(rollups.begin(), rollups.end());
+  }
+
   // Query return type
   if (!config->hasString("return")) ret = "list";
   if (ret == "hlist") THROW("Timeseries return type cannot be 'hlist'");
@@ -172,7 +188,7 @@ void TimeseriesHandler::process() {
       schedule();
 
       try {
-        if (success) last = JSON::Reader::parse(value);
+        if (success) last = JSON::BufferReader::parse(value);
       } catch (const Exception &e) {
         LOG_ERROR("Failed to parse last timeseries result: " << e);
       }
@@ -215,14 +231,22 @@ void TimeseriesHandler::process() {
         // If there's only one key, store just its value
         if (result->size() == 1) result = *result->begin();
 
+        // Rollups also count unchanged results
+        auto ts = get(key);
+        if (!rollups.empty()) {
+          if (batch.isNull()) batch = new LevelDB::Batch(db.batch());
+          ts->rollup(*batch, getTimePeriod(resultsTime), result);
+        }
+
         // Don't record if result is unchanged
         auto it = last->find(key);
         if (it != last->end() && **it == *result) continue;
         last->insert(key, result);
 
         if (batch.isNull()) batch = new LevelDB::Batch(db.batch());
-        batch->set(key + "\0"s + resultsTimeKey, result->toString());
-        get(key)->broadcast(resultsTime, result);
+        batch->set(key + "\0"s + resultsTimeKey,
+          Timeseries::encodeValue(*result));
+        ts->broadcast(resultsTime, result);
       }
     } catch (const Exception &e) {
       LOG_ERROR(e);
@@ -239,13 +263,19 @@ void TimeseriesHandler::process() {
 void TimeseriesHandler::query(uint64_t time) {
   auto cb = [=] (HTTP::Status status, const JSON::ValuePtr &results) {
     if (status == HTTP::Status::HTTP_OK) try {
-      resultsTimeKey = Time(getTimePeriod(time)).toString(TIME_FMT);
+      resultsTimeKey = Timeseries::encodeTime(getTimePeriod(time));
 
       if (ret != "list") {
+        if (!rollups.empty()) {
+          auto batch = db.batch();
+          get("")->rollup(batch, getTimePeriod(time), results);
+          batch.commit();
+        }
+
         if (*last != *results) {
           last = results;
           db.set("\0"s, last->toString());
-          db.set("\0"s + resultsTimeKey, results->toString());
+          db.set("\0"s + resultsTimeKey, Timeseries::encodeValue(*results));
           get("")->broadcast(time, results);
         }
 
@@ -273,6 +303,8 @@ void TimeseriesHandler::action(const CtxPtr &ctx) {
   auto action   = resolver->selectString("args.action", "query");
   auto since    = resolver->selectTime("args.since", 0);
   auto maxCount = resolver->selectU64("args.max_count", 0);
+  auto resStr     = resolver->selectString("args.resolution", "");
+  auto resolution = resStr.empty() ? 0 : HumanDuration::parse(resStr);
 
   // Get Timeseries
   auto key = ret == "list" ? resolveKey(*resolver->select("args")) : "";
@@ -286,11 +318,13 @@ void TimeseriesHandler::action(const CtxPtr &ctx) {
       else ctx->reply(*err);
     };
 
-  if (action == "query") return ts->query(since, maxCount, cb);
+  if (action == "query") return ts->query(since, maxCount, resolution, cb);
 
   auto ws = ctx->getWebsocket();
   if (ws.isSet())  {
-    if (action == "subscribe")   return ws->subscribe(*ts, since, maxCount, cb);
+    if (action == "subscribe")
+      return ws->subscribe(
+        *ts, since, maxCount, resolution, ctx->getRef(), cb);
     if (action == "unsubscribe") return ws->unsubscribe(*ts);
   }
 
@@ -298,10 +332,14 @@ void TimeseriesHandler::action(const CtxPtr &ctx) {
 }
 
 
-SmartPointer<MariaDB::EventDB> TimeseriesHandler::getDBConnection() const {
-  auto db = QueryDef::getDBConnection();
-  db->setPriority(8); // Lower priority to avoid blocking regular API requests
-  return db;
+void TimeseriesHandler::getDBConnection(
+  MariaDB::Connector::callback_t cb) const {
+  QueryDef::getDBConnection(
+    [cb] (const SmartPointer<MariaDB::EventDB> &db) {
+      // Lower priority to avoid blocking regular API requests
+      if (db.isSet()) db->setPriority(8);
+      cb(db);
+    });
 }
 
 
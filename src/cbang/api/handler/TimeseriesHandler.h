@@ -47,6 +47,7 @@ namespace cb {
       std::string     name;
       EventLevelDB    db;
       uint64_t        period;
+      std::vector<uint64_t> rollups;
       JSON::ValuePtr  key;
       Event::EventPtr event;
 
@@ -78,7 +79,8 @@ namespace cb {
       void action(const CtxPtr &ctx);
 
       // From QueryDef
-      SmartPointer<MariaDB::EventDB> getDBConnection() const override;
+      void getDBConnection(
+        MariaDB::Connector::callback_t cb) const override;
 
       // From Handler
       void operator()(const CtxPtr &ctx, const Cont &next) override;
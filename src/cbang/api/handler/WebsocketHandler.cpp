@@ -41,13 +41,20 @@
 #include <cbang/api/ws/WSQueryHandler.h>
 #include <cbang/api/handler/ArgsHandler.h>
 
+using namespace std;
 using namespace cb;
 using namespace cb::API;
 
 
 WebsocketHandler::WebsocketHandler(API &api, const JSON::ValuePtr &config) :
-  api(api) {
+  api(api), maxQueued(config->getU64("max-queued", 1 << 20)) {
   if (config->has("on-message")) loadHandlers(config->get("on-message"));
+
+  // What to do with broadcasts to a client which is not keeping up
+  string overflow = config->getString("overflow", "drop");
+  if      (overflow == "drop")  this->overflow = Websocket::OVERFLOW_DROP;
+  else if (overflow == "close") this->overflow = Websocket::OVERFLOW_CLOSE;
+  else THROW("Invalid websocket overflow policy '" << overflow << "'");
 }
 
 
@@ -130,6 +137,8 @@ void WebsocketHandler::operator()(const CtxPtr &ctx, const Cont &next) {
   if (String::toLower(req.inFind("Upgrade")) != "websocket") return next(ctx);
 
   auto ws = SmartPtr(new Websocket(*this, req));
+  ws->setMaxQueued(maxQueued);
+  ws->setOverflow(overflow);
   ws->upgrade(req);
   add(ws);
 }
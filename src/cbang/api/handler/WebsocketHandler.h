@@ -46,6 +46,9 @@ namespace cb {
       std::map<uint64_t, WebsocketPtr> websockets;
       std::vector<SmartPointer<Handler>> handlers;
 
+      uint64_t maxQueued;
+      Websocket::overflow_t overflow;
+
     public:
       WebsocketHandler(API &api, const JSON::ValuePtr &config);
 
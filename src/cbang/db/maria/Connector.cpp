@@ -32,12 +32,23 @@
 
 #include "Connector.h"
 
+#include <cbang/Catch.h>
 #include <cbang/config/Options.h>
+#include <cbang/event/Base.h>
+#include <cbang/event/Event.h>
+#include <cbang/time/Timer.h>
+#include <cbang/log/Logger.h>
+#include <cbang/util/WeakCallback.h>
 
+using namespace std;
 using namespace cb;
 using namespace cb::MariaDB;
 
 
+Connector::Connector(Event::Base &base) :
+  base(base), event(base.newEvent([this] {process();}, 0)) {}
+
+
 void Connector::addOptions(Options &options) {
   options.pushCategory("Database");
   options.addTarget("db-host",    host,     "DB host name");
@@ -45,14 +56,25 @@ void Connector::addOptions(Options &options) {
   options.addTarget("db-pass",    password, "DB password")->setObscured();;
   options.addTarget("db-name",    database, "DB name");
   options.addTarget("db-port",    port,     "DB port");
-  options.addTarget("db-timeout", timeout,  "DB timeout");
+  options.addTarget("db-timeout", timeout,  "DB timeout.  Also the maximum "
+                    "time to wait for a free connection.");
+  options.addTarget("db-max-connections", maxConnections,
+                    "Maximum number of open DB connections.  Zero for no "
+                    "limit.");
+  options.addTarget("db-max-idle", maxIdle,
+                    "Maximum number of idle DB connections kept for reuse");
+  options.addTarget("db-idle-timeout", idleTimeout,
+                    "Close DB connections idle longer than this many seconds");
+  options.addTarget("db-ping-interval", pingInterval,
+                    "Ping DB connections idle longer than this many seconds "
+                    "before reuse");
+  options.addTarget("db-statement-cache", stmtCacheSize,
+                    "Number of prepared statements cached per DB connection");
   options.popCategory();
 }
 
 
 SmartPointer<MariaDB::EventDB> Connector::getConnection() {
-  // TODO Limit the total number of active connections
-
   auto db = SmartPtr(new MariaDB::EventDB(base));
 
   // Configure
@@ -63,9 +85,133 @@ SmartPointer<MariaDB::EventDB> Connector::getConnection() {
   db->enableNonBlocking();
   db->setCharacterSet("utf8mb4");
   db->setPriority(priority);
+  db->setStatementCacheSize(stmtCacheSize);
 
   // Connect
   db->connectNB(host, user, password, database, port);
 
   return db;
 }
+
+
+void Connector::getConnection(callback_t cb) {
+  waiters.push_back(Waiter{cb, Timer::now() + timeout});
+  process();
+}
+
+
+void Connector::release(const SmartPointer<EventDB> &db, bool reset) {
+  // Connections returned mid-call or broken cannot be reused
+  if (db->isPending() || !db->isConnected()) return drop();
+
+  if (reset) {
+    auto cb =
+      [this, db] (EventDB::state_t state) {
+        if (state == EventDB::EVENTDB_DONE) recycle(db);
+        else if (state == EventDB::EVENTDB_ERROR) drop();
+      };
+
+    return db->reset(WeakCall(this, cb));
+  }
+
+  recycle(db);
+}
+
+
+void Connector::lease(callback_t cb) {
+  auto db    = idle.back().db;
+  auto since = idle.back().since;
+  idle.pop_back();
+
+  if (since + pingInterval < Timer::now()) {
+    auto pingCB =
+      [this, db, cb] (EventDB::state_t state) {
+        if (state == EventDB::EVENTDB_DONE && db->isConnected())
+          return use(db, cb);
+
+        LOG_DEBUG(3, "Dropping stale DB connection");
+        drop();
+
+        // Retry at the head of the queue
+        waiters.push_front(Waiter{cb, Timer::now() + timeout});
+        schedule();
+      };
+
+    return db->ping(WeakCall(this, pingCB));
+  }
+
+  use(db, cb);
+}
+
+
+void Connector::use(const SmartPointer<EventDB> &db, callback_t cb) {
+  db->setPriority(priority);
+  TRY_CATCH_ERROR(cb(db));
+}
+
+
+void Connector::recycle(const SmartPointer<EventDB> &db) {
+  idle.push_back(Idle{db, Timer::now()});
+
+  // Defer waiters until the caller has unwound
+  if (!waiters.empty()) schedule();
+}
+
+
+void Connector::drop() {
+  if (numOpen) numOpen--;
+  if (!waiters.empty()) schedule();
+}
+
+
+void Connector::schedule() {event->activate();}
+
+
+void Connector::process() {
+  double now = Timer::now();
+
+  // Serve waiters in FIFO order
+  while (!waiters.empty()) {
+    auto cb = waiters.front().cb;
+
+    if (waiters.front().expires < now) {
+      waiters.pop_front();
+      LOG_WARNING("Timed out waiting for a DB connection");
+      TRY_CATCH_ERROR(cb(0));
+      continue;
+    }
+
+    if (idle.empty() && maxConnections && maxConnections <= numOpen) break;
+    waiters.pop_front();
+
+    if (idle.empty()) {
+      numOpen++;
+      SmartPointer<EventDB> db;
+      TRY_CATCH_ERROR(db = getConnection());
+      if (db.isSet()) use(db, cb);
+      else {numOpen--; TRY_CATCH_ERROR(cb(0));}
+
+    } else lease(cb);
+  }
+
+  // Close excess and expired idle connections, oldest first
+  while (!idle.empty() && (maxIdle < idle.size() ||
+                           idle.front().since + idleTimeout < now)) {
+    auto db = idle.front().db;
+    idle.pop_front();
+    numOpen--;
+
+    // The callback holds the DB until the close completes
+    db->close([db] (EventDB::state_t state) {});
+  }
+
+  // Wake up for the next waiter timeout or idle expiration
+  double next = 0;
+  if (!waiters.empty()) next = waiters.front().expires;
+  if (!idle.empty()) {
+    double expires = idle.front().since + idleTimeout;
+    if (!next || expires < next) next = expires;
+  }
+
+  if (next) event->add(next < now ? 0 : next - now);
+}
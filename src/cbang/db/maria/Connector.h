@@ -36,13 +36,27 @@
 
 #include <cbang/SmartPointer.h>
 
+#include <list>
+#include <functional>
+
 
 namespace cb {
   class Options;
-  namespace Event {class Base;}
+  namespace Event {class Base; class Event;}
 
   namespace MariaDB {
-    class Connector {
+    /***
+     * Opens and pools DB connections.
+     *
+     * At most ``maxConnections`` are open at once, zero means no limit.
+     * Idle connections are kept warm for reuse and requests for a connection
+     * beyond the limit wait in FIFO order for up to ``timeout`` seconds.
+     */
+    class Connector : public RefCounted {
+    public:
+      typedef std::function<void (const SmartPointer<EventDB> &)> callback_t;
+
+    protected:
       Event::Base &base;
 
       std::string user;
@@ -53,8 +67,30 @@ namespace cb {
       unsigned    timeout  = 5;
       int         priority = 0;
 
+      unsigned maxConnections = 16;
+      unsigned maxIdle        = 8;
+      unsigned idleTimeout    = 300;
+      unsigned pingInterval   = 30;
+      unsigned stmtCacheSize  = 32;
+
+      struct Idle {
+        SmartPointer<EventDB> db;
+        double since;
+      };
+
+      struct Waiter {
+        callback_t cb;
+        double expires;
+      };
+
+      std::list<Idle> idle;        // Most recently returned last
+      std::list<Waiter> waiters;
+      unsigned numOpen = 0;
+
+      SmartPointer<Event::Event> event;
+
     public:
-      Connector(Event::Base &base) : base(base) {}
+      Connector(Event::Base &base);
 
       void addOptions(Options &options);
 
@@ -66,6 +102,16 @@ namespace cb {
       unsigned           getTimeout()  const {return timeout;}
       int                getPriority() const {return priority;}
 
+      unsigned getMaxConnections()     const {return maxConnections;}
+      unsigned getMaxIdle()            const {return maxIdle;}
+      unsigned getIdleTimeout()        const {return idleTimeout;}
+      unsigned getPingInterval()       const {return pingInterval;}
+      unsigned getStatementCacheSize() const {return stmtCacheSize;}
+
+      unsigned getNumOpen()    const {return numOpen;}
+      unsigned getNumIdle()    const {return idle.size();}
+      unsigned getNumWaiting() const {return waiters.size();}
+
       void setUser    (const std::string &user)     {this->user     = user;}
       void setPassword(const std::string &password) {this->password = password;}
       void getDatabase(const std::string &database) {this->database = database;}
@@ -74,7 +120,32 @@ namespace cb {
       void getTimeout (unsigned timeout)            {this->timeout  = timeout;}
       void getPriority(int priority)                {this->priority = priority;}
 
+      void setMaxConnections(unsigned x)     {maxConnections = x;}
+      void setMaxIdle(unsigned x)            {maxIdle        = x;}
+      void setIdleTimeout(unsigned x)        {idleTimeout    = x;}
+      void setPingInterval(unsigned x)       {pingInterval   = x;}
+      void setStatementCacheSize(unsigned x) {stmtCacheSize  = x;}
+
+      /// Open a new connection outside of the pool
       SmartPointer<MariaDB::EventDB> getConnection();
+
+      /***
+       * Lease a pooled connection.  @param cb is called with a connected
+       * or connecting DB or with null if none became available in time.
+       * The connection must be returned with release().
+       */
+      void getConnection(callback_t cb);
+
+      /// Return a leased connection.  Set @param reset after errors.
+      void release(const SmartPointer<EventDB> &db, bool reset = false);
+
+    protected:
+      void lease(callback_t cb);
+      void use(const SmartPointer<EventDB> &db, callback_t cb);
+      void recycle(const SmartPointer<EventDB> &db);
+      void drop();
+      void schedule();
+      void process();
     };
   }
 }
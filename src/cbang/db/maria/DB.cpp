@@ -105,9 +105,9 @@ DB::DB(st_mysql *db) :
 
 DB::~DB() {
   LOG_DEBUG(5, CBANG_FUNC << "()");
-  freeMeta();
-  if (stmt) mysql_stmt_close(stmt);
+  closeStatements();
   if (db) mysql_close(db);
+  freeRetired();
   delete binding;
 }
 
@@ -211,6 +211,28 @@ void DB::enableNonBlocking() {
 }
 
 
+void DB::setStatementCacheSize(unsigned size) {
+  stmtCacheSize = size;
+
+  while (size < stmtLRU.size()) {
+    auto &entry = stmtLRU.back();
+    if (entry.second == stmt) useStatement(0);
+    stmtCache.erase(entry.first);
+    retireStatement(entry.second);
+    stmtLRU.pop_back();
+  }
+}
+
+
+void DB::closeStatements() {
+  useStatement(0);
+
+  for (auto &entry: stmtLRU) retireStatement(entry.second);
+  stmtLRU.clear();
+  stmtCache.clear();
+}
+
+
 void DB::connect(const string &host, const string &user, const string &password,
                  const string &dbName, unsigned port, const string &socketName,
                  flags_t flags) {
@@ -253,17 +275,21 @@ bool DB::connectNB(const string &host, const string &user,
 
 void DB::resetConnection() {
   assertNotPending();
+  closeStatements(); // The server drops all prepared statements
 
   if (mysql_reset_connection(db))
     RAISE_DB_ERROR("Failed to reset DB connection");
+
+  freeRetired();
 }
 
 
 bool DB::resetConnectionNB() {
   assertNotPending();
+  closeStatements(); // The server drops all prepared statements
 
   int ret = 0;
-  mysql_reset_connection_start(&ret, db);
+  status = mysql_reset_connection_start(&ret, db);
 
   if (status) {
     continueFunc = &DB::resetConnectionContinue;
@@ -271,6 +297,7 @@ bool DB::resetConnectionNB() {
   }
 
   if (ret) RAISE_DB_ERROR("Failed to reset DB connection");
+  freeRetired();
 
   return true;
 }
@@ -329,10 +356,13 @@ bool DB::pingNB() {
 void DB::close() {
   if (!connected) return;
 
+  closeStatements();
+
   if (db) {
     mysql_close(db);
     db = mysql_init(0);
   }
+  freeRetired();
   connected = false;
 }
 
@@ -344,6 +374,8 @@ bool DB::closeNB() {
   assertNotPending();
   assertNonBlocking();
 
+  closeStatements();
+
   status = mysql_close_start(db);
   if (status) {
     continueFunc = &DB::closeContinue;
@@ -351,6 +383,7 @@ bool DB::closeNB() {
   }
 
   db = mysql_init(0);
+  freeRetired();
   connected = false;
   return true;
 }
@@ -391,9 +424,6 @@ bool DB::queryNB(const string &s, const vector<JSON::ValuePtr> &params) {
   assertNotPending();
   assertNonBlocking();
 
-  if (!stmt && !(stmt = mysql_stmt_init(db)))
-    RAISE_DB_ERROR("Failed to allocate statement");
-
   rowReady = false;
 
   // Convert params to bound buffers; nulls bind NULL, booleans bind 1/0
@@ -407,6 +437,30 @@ bool DB::queryNB(const string &s, const vector<JSON::ValuePtr> &params) {
       p->isBoolean() ? string(p->getBoolean() ? "1" : "0") : p->asString());
   }
 
+  preparing = s;
+  return closeRetiredNB() && startPrepare();
+}
+
+
+bool DB::startPrepare() {
+  const string &s = preparing;
+
+  // Skip prepare if the statement is cached
+  if (stmtCacheSize) {
+    auto it = stmtCache.find(s);
+
+    if (it != stmtCache.end()) {
+      stmtLRU.splice(stmtLRU.begin(), stmtLRU, it->second);
+      useStatement(it->second->second);
+      return startExecute();
+    }
+
+    if (stmtCached) useStatement(0);
+  }
+
+  if (!stmt && !(stmt = mysql_stmt_init(db)))
+    RAISE_DB_ERROR("Failed to allocate statement");
+
   int ret = 0;
   status = mysql_stmt_prepare_start(&ret, stmt, s.data(), s.length());
   LOG_DEBUG(5, CBANG_FUNC << "() status=" << status);
@@ -414,6 +468,7 @@ bool DB::queryNB(const string &s, const vector<JSON::ValuePtr> &params) {
   if (status) {continueFunc = &DB::prepareContinue; return false;}
   if (ret) RAISE_DB_ERROR("Prepare failed");
 
+  cacheStatement();
   return startExecute();
 }
 
@@ -458,6 +513,56 @@ bool DB::startExecute() {
 void DB::freeMeta() {if (meta) {mysql_free_result(meta); meta = 0;}}
 
 
+void DB::useStatement(st_mysql_stmt *stmt) {
+  freeMeta();
+  if (this->stmt && !stmtCached) retireStatement(this->stmt);
+  this->stmt = stmt;
+  stmtCached = stmt;
+}
+
+
+void DB::cacheStatement() {
+  if (!stmtCacheSize || stmtCached) return;
+
+  stmtLRU.push_front(make_pair(preparing, stmt));
+  stmtCache[preparing] = stmtLRU.begin();
+  stmtCached = true;
+
+  while (stmtCacheSize < stmtLRU.size()) {
+    auto &entry = stmtLRU.back();
+    stmtCache.erase(entry.first);
+    retireStatement(entry.second);
+    stmtLRU.pop_back();
+  }
+}
+
+
+void DB::retireStatement(st_mysql_stmt *stmt) {
+  // Closing talks to the server, so it is done before the next query
+  stmtRetired.push_back(stmt);
+}
+
+
+bool DB::closeRetiredNB() {
+  while (!stmtRetired.empty()) {
+    my_bool ret = 0;
+    status = mysql_stmt_close_start(&ret, stmtRetired.back());
+
+    if (status) {continueFunc = &DB::closeRetiredContinue; return false;}
+    stmtRetired.pop_back();
+  }
+
+  return true;
+}
+
+
+void DB::freeRetired() {
+  // The connection was closed or reset so closing sends nothing
+  for (auto stmt: stmtRetired) mysql_stmt_close(stmt);
+  stmtRetired.clear();
+}
+
+
 void DB::setupResultBind() {
   unsigned n = mysql_num_fields(meta);
   binding->resize(n);
@@ -1002,6 +1107,7 @@ bool DB::closeContinue(unsigned ready) {
   if (status) return false;
 
   db = mysql_init(0);
+  freeRetired();
   connected = false;
   return true;
 }
@@ -1029,6 +1135,7 @@ bool DB::resetConnectionContinue(unsigned ready) {
   if (status) return false;
 
   if (ret) RAISE_DB_ERROR("Failed to reset DB connection");
+  freeRetired();
 
   return true;
 }
@@ -1073,12 +1180,24 @@ bool DB::useContinue(unsigned ready) {
 }
 
 
+bool DB::closeRetiredContinue(unsigned ready) {
+  my_bool ret = 0;
+  status = mysql_stmt_close_cont(&ret, stmtRetired.back(), ready);
+  if (status) return false;
+
+  // The handle is freed even if the server could not be told
+  stmtRetired.pop_back();
+  return closeRetiredNB() && startPrepare();
+}
+
+
 bool DB::prepareContinue(unsigned ready) {
   int ret = 0;
   status = mysql_stmt_prepare_cont(&ret, stmt, ready);
   if (status) return false;
   if (ret) RAISE_DB_ERROR("Prepare failed");
 
+  cacheStatement();
   return startExecute();
 }
 
@@ -39,6 +39,8 @@
 #include <string>
 #include <vector>
 #include <set>
+#include <list>
+#include <unordered_map>
 #include <cstdint>
 
 
@@ -106,6 +108,16 @@ namespace cb {
       int status;
       continue_func_t continueFunc;
 
+      // Prepared statements by SQL text, most recently used first
+      typedef std::list<std::pair<std::string, st_mysql_stmt *>> stmt_lru_t;
+      stmt_lru_t stmtLRU;
+      std::unordered_map<std::string, stmt_lru_t::iterator> stmtCache;
+      unsigned stmtCacheSize = 0;
+      bool stmtCached = false;     // ``stmt`` is owned by the cache
+      std::string preparing;
+      // Statements waiting to be closed without blocking the event loop
+      std::vector<st_mysql_stmt *> stmtRetired;
+
     public:
       DB(st_mysql *db = 0);
       ~DB();
@@ -128,6 +140,12 @@ namespace cb {
       void setCharacterSet(const std::string &name);
       void enableNonBlocking();
 
+      // Statement cache
+      unsigned getStatementCacheSize() const {return stmtCacheSize;}
+      void setStatementCacheSize(unsigned size);
+      unsigned getNumCachedStatements() const {return stmtLRU.size();}
+      void closeStatements();
+
       // Connection
       void connect(const std::string &host = "localhost",
                    const std::string &user = "root",
@@ -275,10 +293,16 @@ namespace cb {
 
     protected:
       // Prepared-statement helpers
+      bool startPrepare();      // prepare, unless cached, then execute
       bool startExecute();      // bind params + execute (after prepare)
       void setupResultBind();   // result metadata + bind output columns
       void processFetch();      // pull the fetched row into bound buffers
       void freeMeta();
+      void useStatement(st_mysql_stmt *stmt);
+      void cacheStatement();
+      void retireStatement(st_mysql_stmt *stmt);
+      bool closeRetiredNB();
+      void freeRetired();       // only once the server dropped the statements
 
       // Continue non-blocking calls
       bool closeContinue(unsigned ready);
@@ -287,6 +311,7 @@ namespace cb {
       bool changeUserContinue(unsigned ready);
       bool pingContinue(unsigned ready);
       bool useContinue(unsigned ready);
+      bool closeRetiredContinue(unsigned ready);
       bool prepareContinue(unsigned ready);
       bool executeContinue(unsigned ready);
       bool storeResultContinue(unsigned ready);
@@ -86,6 +86,17 @@ void EventDB::ping(callback_t cb) {
 }
 
 
+void EventDB::reset(callback_t cb) {
+  try {
+    if (resetConnectionNB()) TRY_CATCH_ERROR(cb(EVENTDB_DONE));
+    else callback(cb);
+
+  } catch (const Exception &e) {
+    TRY_CATCH_ERROR(cb(EventDB::EVENTDB_ERROR));
+  }
+}
+
+
 void EventDB::close(callback_t cb) {
   try {
     if (closeNB()) TRY_CATCH_ERROR(cb(EVENTDB_DONE));
@@ -169,13 +180,17 @@ void EventDB::callback(callback_t cb) {
   auto response =
     [this, cb] (Event::Event &e, int fd, unsigned flags) {
       try {
-        if (continueNB(eventFlagsToDBReady(flags)))
-          TRY_CATCH_ERROR(cb(EventDB::EVENTDB_DONE));
-        else renewEvent(); // The wait flags may have changed
+        if (!continueNB(eventFlagsToDBReady(flags)))
+          return renewEvent(); // The wait flags may have changed
+
+        TRY_CATCH_ERROR(cb(EventDB::EVENTDB_DONE));
 
       } catch (const Exception &e) {
         TRY_CATCH_ERROR(cb(EventDB::EVENTDB_ERROR));
       }
+
+      // Drop the callback, and anything it holds, unless it started a new call
+      if (event.get() == &e) endEvent();
     };
 
   newEvent(response);
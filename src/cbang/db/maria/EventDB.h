@@ -103,6 +103,13 @@ namespace cb {
         ping(std::bind(member, obj, _1));
       }
 
+      void reset(callback_t cb);
+      template <class T>
+      void reset(T *obj, typename Callback<T>::member_t member) {
+        using namespace std::placeholders;
+        reset(std::bind(member, obj, _1));
+      }
+
       void close(callback_t cb);
       template <class T>
       void close(T *obj, typename Callback<T>::member_t member) {
@@ -31,6 +31,7 @@
 \******************************************************************************/
 
 #include "Buffer.h"
+#include "FileSegment.h"
 
 #include <cbang/Exception.h>
 #include <cbang/Catch.h>
@@ -133,6 +134,14 @@ void Buffer::setFlags(uint64_t flags) {
 }
 
 
+void Buffer::enableSendfile() {setFlags(EVBUFFER_FLAG_DRAINS_TO_FD);}
+
+
+void Buffer::enableLocking() {
+  if (evbuffer_enable_locking(evb, 0)) THROW("Failed to enable buffer locking");
+}
+
+
 void Buffer::freeze(bool enable, bool front) {
   if ((enable ? evbuffer_freeze : evbuffer_unfreeze)(evb, front))
     THROW("Failed to " << (enable ? "freeze" : "unfreeze") << " buffer at "
@@ -290,6 +299,20 @@ void Buffer::addRef(const Buffer &buf) {
 }
 
 
+void Buffer::addRef(string &&s) {
+  if (s.empty()) return;
+
+  // The buffer owns the string until libevent releases it
+  auto str = new string(std::move(s));
+  auto cleanup = [] (const void *, size_t, void *str) {delete (string *)str;};
+
+  if (evbuffer_add_reference(evb, str->data(), str->size(), cleanup, str)) {
+    delete str;
+    THROW("Add string reference failed");
+  }
+}
+
+
 void Buffer::add(const char *data, unsigned length) {
   if (evbuffer_add(evb, data, length)) THROW("Buffer add failed");
 }
@@ -311,6 +334,13 @@ void Buffer::addFile(const string &path) {
 }
 
 
+void Buffer::addFile(const FileSegment &seg, uint64_t offset,
+                     int64_t length) {
+  if (evbuffer_add_file_segment(evb, seg.getSegment(), offset, length))
+    THROW("Failed to add file segment to buffer");
+}
+
+
 void Buffer::prepend(const Buffer &buf) {
   if (evbuffer_prepend_buffer(evb, buf.getBuffer()))
     THROW("Prepend buffer failed");
@@ -331,7 +361,10 @@ void Buffer::callback(int added, int deleted, int orig) {
 }
 
 
-int Buffer::indexOf(const string &s) const {
-  auto ptr = evbuffer_search(evb, s.data(), s.length(), 0);
-  return ptr.pos;
+int Buffer::indexOf(const string &s, unsigned start) const {
+  if (!start) return evbuffer_search(evb, s.data(), s.length(), 0).pos;
+
+  evbuffer_ptr ptr;
+  if (evbuffer_ptr_set(evb, &ptr, start, EVBUFFER_PTR_SET)) return -1;
+  return evbuffer_search(evb, s.data(), s.length(), &ptr).pos;
 }
@@ -54,6 +54,8 @@ struct iovec;
 
 namespace cb {
   namespace Event {
+    class FileSegment;
+
     class Buffer {
     public:
       typedef std::function<void (int added, int deleted, int orig)> callback_t;
@@ -87,6 +89,9 @@ namespace cb {
       void setCallback(const callback_t &cb, unsigned flags = 0);
 
       void setFlags(uint64_t flags);
+      void enableSendfile();
+      /// Required before other threads reference this buffer with addRef()
+      void enableLocking();
       void freeze(bool enable, bool front);
       void clear();
       void expand(unsigned length);
@@ -116,10 +121,13 @@ namespace cb {
 
       void add(const Buffer &buf);
       void addRef(const Buffer &buf);
+      void addRef(std::string &&s);
       void add(const char *data, unsigned length);
       void add(const char *s);
       void add(const std::string &s);
       void addFile(const std::string &path);
+      void addFile(const FileSegment &seg, uint64_t offset = 0,
+                   int64_t length = -1);
 
       void prepend(const Buffer &buf);
       void prepend(const char *data, unsigned length);
@@ -128,7 +136,7 @@ namespace cb {
 
       void callback(int added, int deleted, int orig);
 
-      int indexOf(const std::string &s) const;
+      int indexOf(const std::string &s, unsigned start = 0) const;
     };
   }
 }
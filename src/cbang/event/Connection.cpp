@@ -48,7 +48,7 @@ using namespace std;
 #define CBANG_LOG_PREFIX "CON" << getID() << ':'
 
 
-uint64_t Connection::nextID = 0;
+std::atomic<uint64_t> Connection::nextID(0);
 
 
 Connection::Connection(Base &base) :
@@ -40,6 +40,7 @@
 #include <cbang/util/RateCollection.h>
 
 #include <functional>
+#include <atomic>
 
 
 namespace cb {
@@ -59,7 +60,7 @@ namespace cb {
       SmartPointer<Socket> socket;
       SockAddr peerAddr;
 
-      static uint64_t nextID;
+      static std::atomic<uint64_t> nextID;
       uint64_t id = ++nextID;
 
       SmartPointer<RateCollection> stats;
@@ -110,11 +110,18 @@ void FD::read(const SmartPointer<Transfer> transfer) {
 
 void FD::read(Transfer::cb_t cb, const Buffer &buffer, unsigned length,
               const string &until) {
-  read(new TransferRead(fd, ssl, cb, buffer, length, until));
+  read(makeShared<TransferRead>(fd, ssl, cb, buffer, length, until));
 }
 
 
-void FD::canRead(Transfer::cb_t cb) {read(new Transfer(fd, ssl, cb));}
+void FD::readAtLeast(Transfer::cb_t cb, const Buffer &buffer,
+                     unsigned minimum, unsigned length) {
+  // Finish once the buffer holds minimum bytes but take up to length if ready
+  read(makeShared<TransferRead>(fd, ssl, cb, buffer, length, "", minimum));
+}
+
+
+void FD::canRead(Transfer::cb_t cb) {read(makeShared<Transfer>(fd, ssl, cb));}
 
 
 void FD::write(const SmartPointer<Transfer> transfer) {
@@ -125,12 +132,12 @@ void FD::write(const SmartPointer<Transfer> transfer) {
 
 
 void FD::write(Transfer::cb_t cb, const Buffer &buffer) {
-  write(new TransferWrite(fd, ssl, cb, buffer));
+  write(makeShared<TransferWrite>(fd, ssl, cb, buffer));
 }
 
 
 void FD::canWrite(Transfer::cb_t cb) {
-  write(new Transfer(fd, ssl, cb));
+  write(makeShared<Transfer>(fd, ssl, cb));
 }
 
 
@@ -104,6 +104,8 @@ namespace cb {
       void read(const SmartPointer<Transfer> transfer);
       void read(Transfer::cb_t cb, const Buffer &buffer, unsigned length,
                 const std::string &until = std::string());
+      void readAtLeast(Transfer::cb_t cb, const Buffer &buffer,
+                       unsigned minimum, unsigned length);
       void canRead(Transfer::cb_t cb);
 
       void write(const SmartPointer<Transfer> transfer);
@@ -33,6 +33,7 @@
 #include "FDPool.h"
 #include "FDPoolEPoll.h"
 #include "FDPoolEvent.h"
+#include "FDPoolSharded.h"
 
 #include <cbang/os/SystemUtilities.h>
 
@@ -54,7 +55,24 @@ SmartPointer<FDPool> FDPool::create(Base &base) {
   if (String::toLower(type) == "event") return new FDPoolEvent(base);
 
 #ifdef HAVE_EPOLL
-  if (String::toLower(type) == "epoll") return new FDPoolEPoll(base);
+  if (String::toLower(type) == "epoll") {
+    // Write on the event thread first when the socket has room
+    const char *writes = SystemUtilities::getenv("CBANG_EVENT_POOL_INLINE");
+
+    // Shard FDs across several pool threads
+    const char *threads = SystemUtilities::getenv("CBANG_EVENT_POOL_THREADS");
+    unsigned count = threads ? String::parseU32(threads) : 1;
+
+    if (1 < count) {
+      SmartPointer<FDPoolSharded> pool = new FDPoolSharded(base, count);
+      if (writes) pool->setInlineWrites(String::parseBool(writes));
+      return pool;
+    }
+
+    SmartPointer<FDPoolEPoll> pool = new FDPoolEPoll(base);
+    if (writes) pool->setInlineWrites(String::parseBool(writes));
+    return pool;
+  }
 #endif
 
   THROW("Unsupported event pool type: " << type);
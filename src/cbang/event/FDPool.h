@@ -55,7 +55,7 @@ namespace cb {
       static SmartPointer<FDPool> create(Base &base);
 
       const SmartPointer<RateCollection> &getStats() const {return stats;}
-      void setStats(const SmartPointer<RateCollection> &stats)
+      virtual void setStats(const SmartPointer<RateCollection> &stats)
         {this->stats = stats;}
 
       virtual void setEventPriority(int priority) = 0;
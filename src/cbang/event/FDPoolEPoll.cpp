@@ -45,6 +45,8 @@
 #include <cerrno>
 
 #include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <poll.h>
 #include <unistd.h>
 
 using namespace cb::Event;
@@ -154,7 +156,7 @@ void FDPoolEPoll::FDQueue::transfer() {
     if (front()->isFinished()) {
       cmd = read ? CMD_READ_FINISHED : CMD_WRITE_FINISHED;
       pool.queueProgress(cmd, fdr.getFD(), now, front()->getLength());
-      pool.queueComplete(front());
+      pool.queueComplete(front(), !read);
       pop();
     }
   }
@@ -174,7 +176,7 @@ void FDPoolEPoll::FDQueue::flush() {
 
 
 void FDPoolEPoll::FDQueue::add(const SmartPointer<Transfer> &tran) {
-  if (closed) fdr.getPool().queueComplete(tran);
+  if (closed) fdr.getPool().queueComplete(tran, !read);
   else push(tran);
 }
 
@@ -183,7 +185,7 @@ void FDPoolEPoll::FDQueue::close() {
   closed = true;
 
   while (!empty()) {
-    fdr.getPool().queueComplete(front());
+    fdr.getPool().queueComplete(front(), !read);
     pop();
   }
 }
@@ -249,7 +251,7 @@ void FDPoolEPoll::FDRec::flush() {
 void FDPoolEPoll::FDRec::process(cmd_t cmd,
                                  const SmartPointer<Transfer> &tran) {
   if ((cmd == CMD_READ || cmd == CMD_WRITE) && tran->isFinished())
-    return pool.queueComplete(tran);
+    return pool.queueComplete(tran, cmd == CMD_WRITE);
 
   switch (cmd) {
   case CMD_READ:  readQ.add(tran);  break;
@@ -294,13 +296,28 @@ FDPoolEPoll::FDPoolEPoll(Base &base) :
   event(base.newEvent([this] {processResults();})) {
 
   fd = epoll_create1(EPOLL_CLOEXEC);
-  if (!fd) THROW("Failed to create epoll");
+  if (fd == -1) THROW("Failed to create epoll: " << SysError());
+
+  // Commands ring the doorbell so the pool thread does not wait for epoll
+  wakeFD = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (wakeFD == -1) THROW("Failed to create eventfd: " << SysError());
+
+  struct epoll_event ev;
+  memset(&ev, 0, sizeof(ev));
+  ev.events = EPOLLIN;
+  ev.data.fd = wakeFD;
+  if (epoll_ctl(fd, EPOLL_CTL_ADD, wakeFD, &ev))
+    THROW("Failed to add eventfd to epoll: " << SysError());
+
   start();
 }
 
 
 FDPoolEPoll::~FDPoolEPoll() {
+  stop();
+  wake();
   join();
+  if (wakeFD != -1) close(wakeFD);
   if (fd != -1) close(fd);
 }
 
@@ -317,6 +334,9 @@ void FDPoolEPoll::read(const SmartPointer<Transfer> &t) {
 
 void FDPoolEPoll::write(const SmartPointer<Transfer> &t) {
   if (t.isNull()) THROW("Transfer cannot be null");
+  if (inlineWrites && writeInline(t)) return;
+
+  writing[t->getFD()]++;
   queueCommand(CMD_WRITE, t->getFD(), t);
 }
 
@@ -346,8 +366,8 @@ void FDPoolEPoll::queueTimeout(uint64_t time, bool read, int fd) {
 }
 
 
-void FDPoolEPoll::queueComplete(const SmartPointer<Transfer> &t) {
-  results.push({CMD_COMPLETE, t->getFD(), t, 0, 0});
+void FDPoolEPoll::queueComplete(const SmartPointer<Transfer> &t, bool write) {
+  results.push({CMD_COMPLETE, t->getFD(), t, 0, write});
   queuedResults = true;
 }
 
@@ -374,6 +394,53 @@ void FDPoolEPoll::queueCommand(cmd_t cmd, int fd,
                                const SmartPointer<Transfer> &tran) {
   LOG_DEBUG(5, CBANG_FUNC << "() fd=" << fd << " cmd=" << cmd);
   cmds.push({cmd, fd, tran});
+  wake();
+}
+
+
+void FDPoolEPoll::wake() {
+  // Ring once per burst, the pool thread rearms before reading commands
+  if (wakePending.exchange(true)) return;
+
+  uint64_t one = 1;
+  if (::write(wakeFD, &one, sizeof(one)) != sizeof(one) && errno != EAGAIN)
+    LOG_ERROR("Failed to wake FD pool: " << SysError());
+}
+
+
+bool FDPoolEPoll::writeInline(const SmartPointer<Transfer> &t) {
+  // Earlier writes must finish first.  The pool thread may be using the SSL
+  // state for a read so only plain sockets are written here.
+  int fd = t->getFD();
+  if (t->getSSL().isSet() || writing.count(fd) || flushing.count(fd))
+    return false;
+
+  auto it = fds.find(fd);
+  if (it == fds.end()) return false;
+
+  // A failed write ends the transfer, so only try when the socket has room
+  struct pollfd pfd = {fd, POLLOUT, 0};
+  if (poll(&pfd, 1, 0) != 1 || pfd.revents != POLLOUT) return false;
+
+  FD &f = *it->second;
+  uint64_t now = Time::now();
+  f.progressStart(false, t->getLength(), now);
+
+  int ret = t->transfer();
+  if (0 < ret) {
+    if (getStats().isSet()) getStats()->event("write", ret, now);
+    f.progressEvent(false, ret, now);
+  }
+
+  if (!t->isFinished()) return false; // Pool writes the rest
+
+  f.progressEnd(false, t->getLength());
+
+  // Complete from the event loop as the pool would
+  written.push_back(t);
+  event->activate();
+
+  return true;
 }
 
 
@@ -386,10 +453,24 @@ FDPoolEPoll::FDRec &FDPoolEPoll::getFD(int fd) {
 
 
 void FDPoolEPoll::processResults() {
+  if (!written.empty()) {
+    vector<SmartPointer<Transfer> > done;
+    done.swap(written);
+
+    for (auto &t: done)
+      if (fds.count(t->getFD()) && !flushing.count(t->getFD()))
+        TRY_CATCH_ERROR(t->complete());
+  }
+
   while (!results.empty()) {
     auto &cmd = results.top();
     LOG_DEBUG(5, CBANG_FUNC << "() fd=" << cmd.fd << " cmd=" << cmd.cmd);
 
+    if (cmd.cmd == CMD_COMPLETE && cmd.value) {
+      auto it = writing.find(cmd.fd);
+      if (it != writing.end() && !--it->second) writing.erase(it);
+    }
+
     auto it = fds.find(cmd.fd);
     if (it == fds.end()) {
       results.pop();
@@ -408,6 +489,7 @@ void FDPoolEPoll::processResults() {
     case CMD_FLUSHED:
       Socket::close(cmd.fd);
       flushing.erase(cmd.fd);
+      writing.erase(cmd.fd);
       fds.erase(cmd.fd);
       break;
 
@@ -461,12 +543,22 @@ void FDPoolEPoll::run() {
 
     for (int i = 0; i < count; i++)
       try {
+        if (records[i].data.fd == wakeFD) {
+          uint64_t value;
+          if (::read(wakeFD, &value, sizeof(value)) < 0 && errno != EAGAIN)
+            LOG_ERROR("Failed to read FD pool doorbell: " << SysError());
+          continue;
+        }
+
         unsigned events = epoll_to_fd_events(records[i].events);
         auto &fd        = getFD(records[i].data.fd);
         CHECK_STATUS(fd.transfer(events));
       } CATCH_ERROR;
 
-    // Process pending commands
+    // Process pending commands.  Rearm the doorbell first so that commands
+    // queued from here on ring it again.
+    wakePending.exchange(false);
+
     while (!cmds.empty()) {
       auto &cmd = cmds.top();
       auto &fd  = getFD(cmd.fd);
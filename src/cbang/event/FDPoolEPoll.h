@@ -45,6 +45,8 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <queue>
+#include <vector>
+#include <atomic>
 
 
 namespace cb {
@@ -54,6 +56,9 @@ namespace cb {
     class FDPoolEPoll :
       public FDPool, public Thread, public FDPoolEPollCommand::Enum {
       int fd = -1;
+      int wakeFD = -1;
+      std::atomic<bool> wakePending{false};
+      bool inlineWrites = true;
 
       SmartPointer<Event> event;
 
@@ -162,6 +167,9 @@ namespace cb {
       typedef std::unordered_map<int, FD *> fds_t;
       fds_t fds;
 
+      std::unordered_map<int, unsigned> writing;
+      std::vector<SmartPointer<Transfer> > written;
+
       bool queuedResults = false;
 
     public:
@@ -170,6 +178,9 @@ namespace cb {
 
       int getFD() const {return fd;}
 
+      bool getInlineWrites() const {return inlineWrites;}
+      void setInlineWrites(bool x) {inlineWrites = x;}
+
       // From FDPool
       void setEventPriority(int priority) override;
       int getEventPriority() const override;
@@ -180,13 +191,15 @@ namespace cb {
       void flush(int fd) override;
 
       void queueTimeout(uint64_t time, bool read, int fd);
-      void queueComplete(const SmartPointer<Transfer> &t);
+      void queueComplete(const SmartPointer<Transfer> &t, bool write);
       void queueFlushed(int fd);
       void queueProgress(cmd_t cmd, int fd, uint64_t time, int value);
 
     protected:
       void queueStatus(int fd, int status);
       void queueCommand(cmd_t cmd, int fd, const SmartPointer<Transfer> &tran);
+      void wake();
+      bool writeInline(const SmartPointer<Transfer> &t);
       FDRec &getFD(int fd);
       void processResults();
 
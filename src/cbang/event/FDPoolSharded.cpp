@@ -0,0 +1,157 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2021-2026, Cauldron Development  Oy
+                Copyright (c) 2003-2021, Cauldron Development LLC
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+
+#include "FDPoolSharded.h"
+
+#ifdef HAVE_EPOLL
+
+#include <cbang/String.h>
+#include <cbang/log/Logger.h>
+
+using namespace cb::Event;
+using namespace cb;
+using namespace std;
+
+
+void FDPoolSharded::ShardStats::event(
+  const string &key, double value, uint64_t now) {
+  bytes.event(value, now);
+
+  if (parent.isSet()) {
+    parent->event(key, value, now);
+    parent->event(ns + key, value, now);
+  }
+}
+
+
+FDPoolSharded::FDPoolSharded(Base &base, unsigned count) {
+  if (!count) THROW("FD pool requires at least one shard");
+
+  shards.resize(count);
+
+  for (unsigned i = 0; i < count; i++) {
+    shards[i].pool  = new FDPoolEPoll(base);
+    shards[i].stats = new ShardStats("shard" + String(i) + ".");
+    shards[i].pool->setStats(shards[i].stats);
+  }
+}
+
+
+void FDPoolSharded::setInlineWrites(bool x) {
+  for (auto &shard: shards) shard.pool->setInlineWrites(x);
+}
+
+
+void FDPoolSharded::setStats(const SmartPointer<RateCollection> &stats) {
+  FDPool::setStats(stats);
+  for (auto &shard: shards) shard.stats->setParent(stats);
+}
+
+
+void FDPoolSharded::setEventPriority(int priority) {
+  for (auto &shard: shards) shard.pool->setEventPriority(priority);
+}
+
+
+int FDPoolSharded::getEventPriority() const {
+  return shards[0].pool->getEventPriority();
+}
+
+
+void FDPoolSharded::read(const SmartPointer<Transfer> &t) {
+  if (t.isNull()) THROW("Transfer cannot be null");
+  shards[lookup(t->getFD())].pool->read(t);
+}
+
+
+void FDPoolSharded::write(const SmartPointer<Transfer> &t) {
+  if (t.isNull()) THROW("Transfer cannot be null");
+  shards[lookup(t->getFD())].pool->write(t);
+}
+
+
+void FDPoolSharded::open(FD &fd) {
+  if (fd.getFD() < 0) THROW("Invalid fd " << fd.getFD());
+  if (assigned.count(fd.getFD()))
+    THROW("FD " << fd.getFD() << " already in pool");
+
+  unsigned i = select();
+  shards[i].pool->open(fd);
+  shards[i].fds++;
+  assigned[fd.getFD()] = i;
+
+  LOG_DEBUG(5, CBANG_FUNC << "() fd=" << fd.getFD() << " shard=" << i);
+}
+
+
+void FDPoolSharded::flush(int fd) {
+  if (fd < 0) THROW("Invalid fd " << fd);
+
+  unsigned i = lookup(fd);
+  shards[i].pool->flush(fd);
+
+  // The shard closes the socket so its number cannot be reused before then
+  auto it = assigned.find(fd);
+  if (it != assigned.end()) {
+    shards[i].fds--;
+    assigned.erase(it);
+  }
+}
+
+
+unsigned FDPoolSharded::select() const {
+  // Least active bytes first then fewest FDs
+  uint64_t now = Time::now();
+  unsigned best = 0;
+  double bestBytes = shards[0].stats->getBytes(now);
+
+  for (unsigned i = 1; i < shards.size(); i++) {
+    double bytes = shards[i].stats->getBytes(now);
+
+    if (bytes < bestBytes ||
+        (bytes == bestBytes && shards[i].fds < shards[best].fds)) {
+      best = i;
+      bestBytes = bytes;
+    }
+  }
+
+  return best;
+}
+
+
+unsigned FDPoolSharded::lookup(int fd) const {
+  auto it = assigned.find(fd);
+  return it == assigned.end() ? fd % shards.size() : it->second;
+}
+
+#endif // HAVE_EPOLL
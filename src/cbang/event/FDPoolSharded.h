@@ -0,0 +1,105 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2021-2026, Cauldron Development  Oy
+                Copyright (c) 2003-2021, Cauldron Development LLC
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+
+#pragma once
+
+#include <cbang/config.h>
+
+#ifdef HAVE_EPOLL
+
+#include "FDPoolEPoll.h"
+
+#include <cbang/util/Rate.h>
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+
+namespace cb {
+  namespace Event {
+    class Base;
+
+    /// Shards FDs across several epoll pools, each with its own thread
+    class FDPoolSharded : public FDPool {
+      class ShardStats : public RateCollection {
+        std::string ns;
+        SmartPointer<RateCollection> parent;
+        Rate bytes;
+
+      public:
+        ShardStats(const std::string &ns) : ns(ns), bytes(10) {}
+
+        void setParent(const SmartPointer<RateCollection> &parent)
+          {this->parent = parent;}
+        double getBytes(uint64_t now) const {return bytes.get(now);}
+
+        // From RateCollection
+        void event(const std::string &key, double value,
+                   uint64_t now) override;
+      };
+
+      struct Shard {
+        SmartPointer<FDPoolEPoll> pool;
+        SmartPointer<ShardStats> stats;
+        unsigned fds = 0;
+      };
+
+      std::vector<Shard> shards;
+      std::unordered_map<int, unsigned> assigned;
+
+    public:
+      FDPoolSharded(Base &base, unsigned count);
+
+      unsigned getShardCount() const {return shards.size();}
+      FDPoolEPoll &getShard(unsigned i) {return *shards.at(i).pool;}
+
+      void setInlineWrites(bool x);
+
+      // From FDPool
+      void setStats(const SmartPointer<RateCollection> &stats) override;
+      void setEventPriority(int priority) override;
+      int getEventPriority() const override;
+      void read (const SmartPointer<Transfer> &t) override;
+      void write(const SmartPointer<Transfer> &t) override;
+      void open(FD &fd) override;
+      void flush(int fd) override;
+
+    protected:
+      unsigned select() const;
+      unsigned lookup(int fd) const;
+    };
+  }
+}
+
+#endif // HAVE_EPOLL
@@ -0,0 +1,74 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2021-2026, Cauldron Development  Oy
+                Copyright (c) 2003-2021, Cauldron Development LLC
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+
+#include "FileSegment.h"
+
+#include <cbang/Exception.h>
+
+#include <event2/buffer.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace std;
+using namespace cb::Event;
+
+
+FileSegment::FileSegment(const string &path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd == -1) THROW("Failed to open file " << path);
+
+  struct stat buf;
+  if (fstat(fd, &buf)) {
+    ::close(fd);
+    THROW("Failed to get file size " << path);
+  }
+
+  length = buf.st_size;
+  seg = evbuffer_file_segment_new(fd, 0, length, EVBUF_FS_CLOSE_ON_FREE);
+
+  if (!seg) {
+    ::close(fd);
+    THROW("Failed to create file segment: " << path);
+  }
+}
+
+
+FileSegment::~FileSegment() {evbuffer_file_segment_free(seg);}
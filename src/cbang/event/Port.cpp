@@ -32,6 +32,7 @@
 
 #include "Port.h"
 #include "Server.h"
+#include "Base.h"
 #include "Event.h"
 
 #include <cbang/net/Socket.h>
@@ -43,9 +44,11 @@ using namespace cb;
 using namespace std;
 
 
-Port::Port(Server &server, const SockAddr addr,
-           const SmartPointer<SSLContext> &sslCtx, int priority) :
-  server(server), addr(addr), sslCtx(sslCtx), priority(priority) {}
+Port::Port(Server &server, Base &base, const SockAddr addr,
+           const SmartPointer<SSLContext> &sslCtx, int priority,
+           bool reusePort) :
+  server(server), base(base), addr(addr), sslCtx(sslCtx), priority(priority),
+  reusePort(reusePort) {}
 
 
 Port::~Port() {}
@@ -59,7 +62,8 @@ void Port::setPriority(int priority) {
 
 void Port::open() {
   socket = new Socket;
-  socket->open(Socket::NONBLOCKING | Socket::REUSEADDR, addr);
+  socket->open(Socket::NONBLOCKING | Socket::REUSEADDR |
+               (reusePort ? Socket::REUSEPORT : 0), addr);
   socket->listen(server.getConnectionBacklog());
   addEvent();
 }
@@ -96,7 +100,7 @@ void Port::accept() {
     }
 
     try {
-      server.accept(peerAddr, newSocket, sslCtx);
+      server.accept(base, peerAddr, newSocket, sslCtx);
 
     } catch (const SSLException &e) {
       LOG_DEBUG(4, e.getMessage());
@@ -108,8 +112,8 @@ void Port::accept() {
 void Port::addEvent(double delay) {
   if (event.isSet()) event->del();
 
-  if (delay) event = server.getBase().newEvent([this] {addEvent();}, 0);
-  else event = server.getBase().newEvent(
+  if (delay) event = base.newEvent([this] {addEvent();}, 0);
+  else event = base.newEvent(
     socket->get(), [this] {accept();}, EVENT_READ | EVENT_PERSIST);
 
   if (0 <= priority) event->setPriority(priority);
@@ -44,24 +44,29 @@ namespace cb {
   class Socket;
 
   namespace Event {
+    class Base;
     class Server;
     class Event;
 
     class Port : public Enum {
       Server &server;
+      Base &base;
       SockAddr addr;
       SmartPointer<SSLContext> sslCtx;
       int priority;
+      bool reusePort;
 
       SmartPointer<Socket> socket;
       SmartPointer<Event> event;
       Backoff backoff = Backoff(0.1, 5);
 
     public:
-      Port(Server &server, const SockAddr addr,
-           const SmartPointer<SSLContext> &sslCtx, int priority);
+      Port(Server &server, Base &base, const SockAddr addr,
+           const SmartPointer<SSLContext> &sslCtx, int priority,
+           bool reusePort = false);
       ~Port();
 
+      Base &getBase() {return base;}
       const SockAddr &getAddr() const {return addr;}
       bool isSecure() const {return sslCtx.isSet();}
 
@@ -38,6 +38,7 @@
 #include <cbang/log/Logger.h>
 #include <cbang/net/Socket.h>
 #include <cbang/config/Options.h>
+#include <cbang/thread/SmartLock.h>
 
 using namespace cb::Event;
 using namespace cb;
@@ -47,6 +48,18 @@ using namespace std;
 Server::Server(Base &base) : base(base), addrFilter(&base.getDNS()) {}
 
 
+Server::~Server() {
+  // Connections and ports must not be used by the workers once destroyed
+  for (auto &worker: workers) worker->join();
+}
+
+
+void Server::setThreads(unsigned threads) {
+  if (!ports.empty()) THROW("Cannot change server threads after binding");
+  this->threads = threads;
+}
+
+
 void Server::setTimeout(int timeout) {
   setReadTimeout(timeout);
   setWriteTimeout(timeout);
@@ -77,6 +90,13 @@ void Server::addOptions(Options &options) {
                     "Maximum simultaneous client connections per port");
   options.addTarget("max-ttl", maxConnectionTTL,
                     "Maximum client connection time in seconds");
+  options.addTarget("server-threads", threads,
+                    "Number of event loop threads serving connections.  Each "
+                    "thread listens on every port with SO_REUSEPORT and the "
+                    "kernel spreads new connections across them.  Zero "
+                    "serves all connections from the main event loop, as "
+                    "handlers which use DB connections or websocket "
+                    "broadcasts require.");
 
   options.popCategory();
 }
@@ -95,16 +115,40 @@ void Server::bind(const SockAddr &addr, const SmartPointer<SSLContext> &sslCtx,
                   int priority) {
   LOG_DEBUG(4, "Binding " << (sslCtx.isSet() ? "ssl " : "") << addr);
 
-  SmartPointer<Port> port = new Port(*this, addr, sslCtx, priority);
-  port->open();
-  ports.push_back(port);
+  if (!threads) {
+    SmartPointer<Port> port = new Port(*this, base, addr, sslCtx, priority);
+    port->open();
+    ports.push_back(port);
+    return;
+  }
+
+  startThreads();
+
+  for (auto &worker: workers) {
+    SmartPointer<Port> port =
+      new Port(*this, worker->getBase(), addr, sslCtx, priority, true);
+    port->open();
+    ports.push_back(port);
+  }
 }
 
 
 void Server::shutdown() {for (auto &port: ports) port->close();}
 
 
-void Server::accept(const SockAddr &peerAddr,
+Server::connections_t Server::getConnections() const {
+  SmartLock lock(&connectionsLock);
+  return connections;
+}
+
+
+unsigned Server::getConnectionCount() const {
+  SmartLock lock(&connectionsLock);
+  return connections.size();
+}
+
+
+void Server::accept(Base &base, const SockAddr &peerAddr,
                     const SmartPointer<Socket> &socket,
                     const SmartPointer<SSLContext> &sslCtx) {
   if (!isAllowed(peerAddr)) {
@@ -114,7 +158,7 @@ void Server::accept(const SockAddr &peerAddr,
 
   LOG_DEBUG(4, "New connection from " << peerAddr);
 
-  auto conn = createConnection();
+  auto conn = createConnection(base);
 
   conn->accept(peerAddr, socket, sslCtx);
   conn->setReadTimeout(readTimeout);
@@ -123,7 +167,11 @@ void Server::accept(const SockAddr &peerAddr,
   if (maxConnectionTTL) conn->setTTL(maxConnectionTTL);
 
   conn->setServer(this);
-  connections.insert(conn);
+
+  {
+    SmartLock lock(&connectionsLock);
+    connections.insert(conn);
+  }
 
   TRY_CATCH_ERROR(conn->onConnect(true));
 }
@@ -132,7 +180,10 @@ void Server::accept(const SockAddr &peerAddr,
 void Server::remove(const SmartPointer<Connection> &conn) {
   LOG_DEBUG(4, "Connection ended");
 
-  connections.erase(conn);
+  {
+    SmartLock lock(&connectionsLock);
+    connections.erase(conn);
+  }
 
   for (auto &port: ports) port->activate();
 }
@@ -143,6 +194,19 @@ bool Server::isAllowed(const SockAddr &peerAddr) const {
 }
 
 
-SmartPointer<Connection> Server::createConnection() {
+SmartPointer<Connection> Server::createConnection(Base &base) {
   return new Connection(base);
 }
+
+
+void Server::startThreads() {
+  if (!workers.empty()) return;
+
+  int priorities = base.hasPriorities() ? base.getNumPriorities() : -1;
+
+  for (unsigned i = 0; i < threads; i++) {
+    SmartPointer<ServerThread> worker = new ServerThread(priorities);
+    worker->start();
+    workers.push_back(worker);
+  }
+}
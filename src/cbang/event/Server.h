@@ -34,13 +34,16 @@
 
 #include "Connection.h"
 #include "Port.h"
+#include "ServerThread.h"
 
 #include <cbang/SmartPointer.h>
 #include <cbang/openssl/SSLContext.h>
 #include <cbang/net/AddressFilter.h>
+#include <cbang/thread/Mutex.h>
 
 #include <list>
 #include <set>
+#include <vector>
 #include <limits>
 
 
@@ -53,11 +56,15 @@ namespace cb {
     class Server : public Enum {
       Base &base;
 
+      unsigned threads = 0;
+      std::vector<SmartPointer<ServerThread>> workers;
+
       typedef std::list<SmartPointer<Port>> ports_t;
       ports_t ports;
 
       typedef std::set<SmartPointer<Connection>> connections_t;
       connections_t connections;
+      Mutex connectionsLock;
 
       int readTimeout = 50;
       int writeTimeout = 50;
@@ -71,12 +78,18 @@ namespace cb {
 
     public:
       Server(Base &base);
-      virtual ~Server() {}
+      virtual ~Server();
 
       Base &getBase() {return base;}
 
+      /// Zero accepts and serves all connections on the main event loop
+      unsigned getThreads() const {return threads;}
+      void setThreads(unsigned threads);
+      const std::vector<SmartPointer<ServerThread>> &getWorkers() const
+        {return workers;}
+
       const ports_t &getPorts() const {return ports;}
-      const connections_t &getConnections() const {return connections;}
+      connections_t getConnections() const;
 
       int getReadTimeout() const {return readTimeout;}
       void setReadTimeout(unsigned t) {readTimeout = t;}
@@ -98,11 +111,12 @@ namespace cb {
       void allow(const std::string &spec);
       void deny(const std::string &spec);
 
+      /// With worker threads the collection must be thread safe, as RateSet is
       const SmartPointer<RateCollection> &getStats() const {return stats;}
       void setStats(const SmartPointer<RateCollection> &stats)
       {this->stats = stats;}
 
-      unsigned getConnectionCount() const {return connections.size();}
+      unsigned getConnectionCount() const;
 
       virtual void addOptions(Options &options);
       virtual void init(Options &options);
@@ -111,12 +125,16 @@ namespace cb {
                 const SmartPointer<SSLContext> &sslCtx = 0, int priority = -1);
       void shutdown();
 
-      void accept(const SockAddr &peerAddr, const SmartPointer<Socket> &socket,
+      void accept(Base &base, const SockAddr &peerAddr,
+                  const SmartPointer<Socket> &socket,
                   const SmartPointer<SSLContext> &sslCtx);
       void remove(const SmartPointer<Connection> &conn);
 
       virtual bool isAllowed(const SockAddr &peerAddr) const;
-      virtual SmartPointer<Connection> createConnection();
+      virtual SmartPointer<Connection> createConnection(Base &base);
+
+    protected:
+      virtual void startThreads();
     };
   }
 }
@@ -51,8 +51,9 @@ using namespace std;
 
 TransferRead::TransferRead(int fd, const SmartPointer<SSL> &ssl, cb_t cb,
                            const Buffer &buffer, unsigned length,
-                           const string &until) :
-  Transfer(fd, ssl, cb, length), buffer(buffer), until(until) {checkFinished();}
+                           const string &until, unsigned minimum) :
+  Transfer(fd, ssl, cb, length), buffer(buffer), until(until),
+  minimum(minimum) {checkFinished();}
 
 
 bool TransferRead::isPending() const {
@@ -133,11 +134,25 @@ int TransferRead::read(Buffer &buffer, unsigned length) {
 }
 
 
+bool TransferRead::foundUntil() {
+  if (until.empty()) return false;
+
+  unsigned bytesRead = buffer.getLength();
+  if (bytesRead < until.length()) return false;
+  if (buffer.indexOf(until, searched) != -1) return true;
+
+  // Resume after the bytes already scanned but allow for a split delimiter
+  searched = bytesRead - until.length() + 1;
+  return false;
+}
+
+
 void TransferRead::checkFinished() {
   if (finished) return;
 
   unsigned bytesRead = buffer.getLength();
-  if (length <= bytesRead || (!until.empty() && buffer.indexOf(until) != -1)) {
+  if (length <= bytesRead || (minimum && minimum <= bytesRead) ||
+      foundUntil()) {
     finished = success = true;
     length = bytesRead;
   }
@@ -43,11 +43,14 @@ namespace cb {
     class TransferRead : public Transfer {
       Buffer buffer;
       std::string until;
+      unsigned searched = 0;
+      unsigned minimum;
 
     public:
       TransferRead(int fd, const SmartPointer<SSL> &ssl, cb_t cb,
                    const Buffer &buffer, unsigned length,
-                   const std::string &until = std::string());
+                   const std::string &until = std::string(),
+                   unsigned minimum = 0);
 
       // From Transfer
       bool isPending() const override;
@@ -55,6 +58,7 @@ namespace cb {
 
     protected:
       int read(Buffer &buffer, unsigned length);
+      bool foundUntil();
       void checkFinished();
     };
   }
@@ -75,7 +75,8 @@ int TransferWrite::write(Buffer &buffer, unsigned length) {
   if (!length) return 0;
 
 #ifdef HAVE_OPENSSL
-  if (ssl.isSet()) {
+  // With kernel TLS the socket is written directly, which allows sendfile
+  if (ssl.isSet() && !ssl->isKTLSSend()) {
     try {
       iovec space;
       buffer.peek(length, space);
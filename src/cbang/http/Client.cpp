@@ -45,33 +45,70 @@ using namespace cb::HTTP;
 
 Client::Client(
   Event::Base &base, const SmartPointer<SSLContext> &sslCtx) :
-  base(base), sslCtx(sslCtx) {}
+  base(base), sslCtx(sslCtx), pool(new ConnPool(*this)) {}
 
 
 Client::~Client() {}
 
 
+void Client::setStats(const SmartPointer<RateCollection> &stats) {
+  this->stats = stats;
+  pool->setStats(stats.isSet() ? new RateCollectionNS(stats, "pool.") : 0);
+}
+
+
 SmartPointer<Conn> Client::send(const SmartPointer<Request> &req) const {
+  return send(req, true);
+}
+
+
+SmartPointer<Conn> Client::send(
+  const SmartPointer<Request> &req, bool reuse) const {
   auto &uri = req->getURI();
 
   SmartPointer<Conn> conn = req->getConnection(); // Not a WeakPtr
-  if (conn.isNull()) {
-    conn = new ConnOut(base);
-    req->setConnection(conn);
-  }
 
-  // Configure connection
-  if (stats.isSet() && conn->getStats().isNull())
-    conn->setStats(new RateCollectionNS(stats, "conn."));
-  conn->setReadTimeout(readTimeout);
-  conn->setWriteTimeout(writeTimeout);
+  auto configure = [this] (Conn &conn) {
+    if (stats.isSet() && conn.getStats().isNull())
+      conn.setStats(new RateCollectionNS(stats, "conn."));
+    conn.setReadTimeout(readTimeout);
+    conn.setWriteTimeout(writeTimeout);
+  };
 
   // Check if already connected
-  if (req->isConnected()) {
+  if (conn.isSet() && req->isConnected()) {
+    configure(*conn);
     conn->queueRequest(req);
     return conn;
   }
 
+  URI proxy;
+  if (!uri.isUnix()) proxy = SystemInfo::instance().getProxy(uri);
+
+  // Direct connections, other than protocol upgrades, are pooled
+  bool pooled = conn.isNull() && pool->isEnabled() &&
+    proxy.getScheme().empty() && !req->outHas("Upgrade");
+
+  if (pooled) {
+    string key = ConnPool::getKey(uri, bindAddr);
+    if (!req->outHas("Connection")) req->outSet("Connection", "keep-alive");
+
+    if (reuse) conn = pool->get(key);
+
+    if (conn.isSet()) {
+      req->setConnection(conn);
+      configure(*conn);
+      conn->queueRequest(req);
+      return conn;
+    }
+
+    conn = pool->create(key);
+
+  } else if (conn.isNull()) conn = new ConnOut(base);
+
+  req->setConnection(conn);
+  configure(*conn);
+
   // SSL
   SmartPointer<SSLContext> sslCtx;
   if (uri.schemeRequiresSSL()) {
@@ -90,7 +127,6 @@ SmartPointer<Conn> Client::send(const SmartPointer<Request> &req) const {
 
   // Proxy
   URI connectURI = uri;
-  auto proxy = SystemInfo::instance().getProxy(uri);
   if (proxy.getScheme() == "http") {
     conn->queueRequest(new ProxyRequest(proxy, req, sslCtx));
     connectURI = proxy;
@@ -115,8 +151,7 @@ SmartPointer<Conn> Client::send(const SmartPointer<Request> &req) const {
 Client::RequestPtr Client::call(
   const URI &uri, Method method, const char *data, unsigned length,
   callback_t cb) {
-  auto con = SmartPtr(new ConnOut(base));
-  auto req = SmartPtr(new PendingRequest(*this, con, uri, method, cb));
+  auto req = SmartPtr(new PendingRequest(*this, 0, uri, method, cb));
 
   if (data) req->getRequest()->getOutputBuffer().add(data, length);
 
@@ -33,6 +33,7 @@
 #pragma once
 
 #include "PendingRequest.h"
+#include "ConnPool.h"
 
 #include <cbang/SmartPointer.h>
 #include <cbang/util/RateCollection.h>
@@ -56,6 +57,7 @@ namespace cb {
       unsigned readTimeout  = 0;
       unsigned writeTimeout = 0;
       SmartPointer<RateCollection> stats;
+      SmartPointer<ConnPool> pool;
 
     public:
       typedef SmartPointer<PendingRequest> RequestPtr;
@@ -85,8 +87,10 @@ namespace cb {
       void setWriteTimeout(unsigned timeout) {writeTimeout = timeout;}
 
       const SmartPointer<RateCollection> &getStats() const {return stats;}
-      void setStats(const SmartPointer<RateCollection> &stats)
-      {this->stats = stats;}
+      void setStats(const SmartPointer<RateCollection> &stats);
+
+      /// Idle keep-alive connections.  Set max idle to zero to disable.
+      ConnPool &getPool() const {return *pool;}
 
       SmartPointer<Conn> send(const SmartPointer<Request> &req) const;
 
@@ -119,6 +123,12 @@ namespace cb {
       call(const URI &uri, Method method,
            T *obj, typename Callback<T>::member_t member)
       {return call(uri, method, bind(obj, member));}
+
+    protected:
+      SmartPointer<Conn> send(const SmartPointer<Request> &req,
+                              bool reuse) const;
+
+      friend class ConnPool;
     };
   }
 }
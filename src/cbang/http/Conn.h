@@ -67,6 +67,8 @@ namespace cb {
       unsigned getMaxHeaderSize() const {return maxHeaderSize;}
       void setMaxHeaderSize(unsigned size) {maxHeaderSize = size;}
 
+      Event::Buffer &getInput() {return input;}
+
       unsigned getNumRequests() const {return requests.size();}
       const requests_t &getRequests() const {return requests;}
 
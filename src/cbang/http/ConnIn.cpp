@@ -48,8 +48,11 @@ using namespace std;
 #define CBANG_LOG_PREFIX "CON" << getID() << ':'
 
 
-ConnIn::ConnIn(Server &server) :
-  Conn(server.getBase()), server(server) {}
+ConnIn::ConnIn(Server &server) : ConnIn(server, server.getBase()) {}
+
+
+ConnIn::ConnIn(Server &server, Event::Base &base) :
+  Conn(base), server(server) {}
 
 
 void ConnIn::writeRequest(
@@ -80,8 +83,7 @@ void ConnIn::writeRequest(
     if (!req->isPersistent()) return close();
 
     // Handle another request
-    if (getNumRequests()) processRequest(getRequest());
-    else readHeader();
+    processNext();
   };
 
   write(WeakCall(this, cb2), buffer);
@@ -91,12 +93,19 @@ void ConnIn::writeRequest(
 void ConnIn::readHeader() {
   LOG_DEBUG(4, CBANG_FUNC << "()");
 
+  reading = true;
+
   auto cb = [this] (bool success) {
     if (maxHeaderSize && maxHeaderSize <= input.getLength())
       error(HTTP_BAD_REQUEST, "Header too large");
 
-    else if (!success) close();
-    else processHeader();
+    else if (success) processHeader();
+    else {
+      // Answer any pipelined requests before closing
+      reading = false;
+      readFailed = true;
+      if (!getNumRequests()) close();
+    }
   };
 
   // Read until end of header
@@ -104,6 +113,29 @@ void ConnIn::readHeader() {
 }
 
 
+void ConnIn::close() {
+  stalled = 0;
+  incoming.release();
+  Conn::close();
+}
+
+
+void ConnIn::readNext() {
+  if (reading || readFailed || stalled || getFD() < 0) return;
+
+  // Read ahead while earlier responses are still being generated or sent
+  if (getNumRequests()) {
+    if (maxPipelined <= getNumRequests()) return;
+
+    // Later bytes may belong to another protocol or no request at all
+    auto &last = requests.back();
+    if (!last->isPersistent() || last->inHas("Upgrade")) return;
+  }
+
+  readHeader();
+}
+
+
 void ConnIn::processHeader() {
   LOG_DEBUG(4, CBANG_FUNC << "()");
 
@@ -112,29 +144,53 @@ void ConnIn::processHeader() {
   URI uri;
   Version version;
   try {
-    string line;
-    input.readLine(line, maxHeaderSize);
-    vector<string> parts;
-    String::tokenize(line, parts, " ");
+    int length = input.indexOf("\r\n");
+    if (length < 0 || (maxHeaderSize && maxHeaderSize < (unsigned)length))
+      THROW("Invalid request line");
+
+    // Split the line in place
+    const char *line = input.pullup(length + 2);
+    const char *parts[3];
+    unsigned lengths[3];
+    unsigned count = 0;
+
+    for (int i = 0; i < length && count <= 3;) {
+      while (i < length && line[i] == ' ') i++;
+      if (i == length) break;
+
+      int start = i;
+      while (i < length && line[i] != ' ') i++;
+
+      if (count < 3) {
+        parts[count] = line + start;
+        lengths[count] = i - start;
+      }
+
+      count++;
+    }
 
-    if (parts.size() != 3)
-      THROW("Invalid request line: " << String::escapeC(line));
+    if (count != 3)
+      THROW("Invalid request line: " << String::escapeC(string(line, length)));
 
-    method = Method::parse(parts[0]);
-    uri = parts[1];
-    version = Request::parseHTTPVersion(parts[2]);
+    method = Method::parse(string(parts[0], lengths[0]));
+    uri = string(parts[1], lengths[1]);
+    version = Request::parseHTTPVersion(string(parts[2], lengths[2]));
+    input.drain(length + 2);
 
   } catch (const Exception &e) {
     return error(HTTP_BAD_REQUEST, e.getMessage());
   }
 
   // Read header block
-  auto hdrs = SmartPtr(new Headers);
+  auto arena = Arena::create();
+  auto hdrs = makeShared<Headers>(arena);
   if (!hdrs->parse(input)) return error(HTTP_BAD_REQUEST, "Incomplete headers");
 
   // Create new request (Don't create circular dependency)
-  auto req = server.createRequest({this, method, uri, version, hdrs});
+  auto req = server.createRequest(
+    {this, method, std::move(uri), version, hdrs, arena});
   push(req);
+  incoming = req;
 
   // If this is a request without a body, then we are done
   if (!req->mayHaveBody()) return processIfNext(req);
@@ -153,25 +209,20 @@ void ConnIn::processHeader() {
     // The logger already prefixes this with the connection id
     LOG_WARNING(getPeerAddr().toString(false) << ':' << "Ignoring upgrade to '"
                 << req->inFind("Upgrade") << "': " << method << ' '
-                << uri.getPath());
+                << req->getURI().getPath());
 
   // Handle 100 HTTP continue
   if (Version(1, 1) <= version) {
     string expect = String::toLower(req->inFind("Expect"));
 
     if (!expect.empty()) {
-      if (expect == "100-continue") {
-        string line = "HTTP/" + version.toString() + " 100 Continue\r\n\r\n";
+      if (expect != "100-continue")
+        return error(HTTP_EXPECTATION_FAILED, "Cannot continue");
 
-        auto cb = [this, req] (bool success) {
-          if (success) checkChunked(req);
-          else error(HTTP_BAD_REQUEST, "Failed to send continue");
-        };
-
-        write(WeakCall(this, cb), line);
-        return;
-
-      } else return error(HTTP_EXPECTATION_FAILED, "Cannot continue");
+      // Must not interleave with responses to earlier requests
+      if (getRequest() == req) sendContinue(req);
+      else stalled = [this, req] {sendContinue(req);};
+      return;
     }
   }
 
@@ -179,6 +230,21 @@ void ConnIn::processHeader() {
 }
 
 
+void ConnIn::sendContinue(const SmartPointer<Request> &req) {
+  LOG_DEBUG(4, CBANG_FUNC << "()");
+
+  string line =
+    "HTTP/" + req->getVersion().toString() + " 100 Continue\r\n\r\n";
+
+  auto cb = [this, req] (bool success) {
+    if (success) checkChunked(req);
+    else error(HTTP_BAD_REQUEST, "Failed to send continue");
+  };
+
+  write(WeakCall(this, cb), line);
+}
+
+
 void ConnIn::checkChunked(const SmartPointer<Request> &req) {
   LOG_DEBUG(4, CBANG_FUNC << "()");
 
@@ -238,8 +304,27 @@ void ConnIn::processRequest(const SmartPointer<Request> &req) {
 
 
 void ConnIn::processIfNext(const SmartPointer<Request> &req) {
+  reading = false;
+  incoming.release();
+
   if (getNumRequests() && getRequest() == req) processRequest(req);
-  // TODO Should read the next request in parallel if persistent connection
+  readNext();
+}
+
+
+void ConnIn::processNext() {
+  // The front request is ready unless its body is still being read
+  if (getNumRequests() && getRequest() != incoming)
+    processRequest(getRequest());
+
+  else if (stalled) {
+    auto cb = stalled;
+    stalled = 0;
+    return cb();
+
+  } else if (!getNumRequests() && readFailed) return close();
+
+  readNext();
 }
 
 
@@ -249,8 +334,19 @@ void ConnIn::error(Status code, const string &message) {
     code = HTTP_INTERNAL_SERVER_ERROR;
   }
 
+  // The position in the input stream is lost, stop reading requests
+  reading = false;
+  readFailed = true;
+
+  // Wait until earlier pipelined requests have been answered
+  if (getNumRequests() && getRequest() != incoming) {
+    stalled = [this, code, message] {error(code, message);};
+    return;
+  }
+
   LOG_DEBUG(3, "Error: " << code << ": " << message);
 
+  incoming.release();
   if (!getNumRequests()) close();
   else getRequest()->sendError(code, message);
 }
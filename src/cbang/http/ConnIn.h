@@ -41,11 +41,21 @@ namespace cb {
     class ConnIn : public Conn {
       Server &server;
 
+      unsigned maxPipelined = 0;
+      bool reading = false;
+      bool readFailed = false;
+      SmartPointer<Request> incoming;
+      std::function<void ()> stalled;
+
     public:
       ConnIn(Server &server);
+      ConnIn(Server &server, Event::Base &base);
 
       Server &getServer() {return server;}
 
+      unsigned getMaxPipelined() const {return maxPipelined;}
+      void setMaxPipelined(unsigned x) {maxPipelined = x;}
+
       // From Conn
       bool isIncoming() const override {return true;}
       void writeRequest(const SmartPointer<Request> &req, Event::Buffer buffer,
@@ -56,11 +66,17 @@ namespace cb {
       // From Event::Connection
       void onConnect(bool success) override {readHeader();}
 
+      // From FD
+      void close() override;
+
     protected:
+      void readNext();
       void processHeader();
+      void sendContinue(const SmartPointer<Request> &req);
       void checkChunked(const SmartPointer<Request> &req);
       void processRequest(const SmartPointer<Request> &req);
       void processIfNext(const SmartPointer<Request> &req);
+      void processNext();
       void error(Status code, const std::string &message);
     };
   }
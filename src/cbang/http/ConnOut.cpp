@@ -32,6 +32,7 @@
 
 #include "ConnOut.h"
 #include "Client.h"
+#include "ConnPool.h"
 
 #include <cbang/Catch.h>
 #include <cbang/net/Socket.h>
@@ -49,6 +50,21 @@ using namespace std;
 ConnOut::ConnOut(Event::Base &base) : Conn(base) {}
 
 
+void ConnOut::setPool(const SmartPointer<ConnPool> &pool, const string &key) {
+  this->pool = pool;
+  poolKey = key;
+}
+
+
+void ConnOut::close() {
+  auto self = SmartPtr(this); // Keep alive
+  Conn::close();
+
+  SmartPointer<ConnPool> pool = this->pool;
+  if (pool.isSet()) pool->remove(*this);
+}
+
+
 void ConnOut::onConnect(bool success) {
   if (success) dispatch();
   else fail(CONN_ERR_CONNECT, "Connection failed");
@@ -88,9 +104,21 @@ void ConnOut::fail(Event::ConnectionError err, const string &msg) {
   auto requests = this->requests;
   this->requests.clear();
 
+  // A reused connection may have been closed by the peer while idle.
+  // Requests that got no response are retried on a new connection.
+  SmartPointer<ConnPool> pool = this->pool;
+  bool first = true;
+
   while (requests.size()) {
-    TRY_CATCH_ERROR(requests.front()->onResponse(err));
+    auto &req = requests.front();
+    bool retry = reused && pool.isSet() &&
+      (!first || (input.isEmpty() && !req->getResponseCode()));
+
+    if (!retry || !pool->retry(req, first))
+      TRY_CATCH_ERROR(req->onResponse(err));
+
     requests.pop_front();
+    first = false;
   }
 
   close();
@@ -208,11 +236,18 @@ void ConnOut::process(const SmartPointer<Request> &req) {
   try {
     req->getInputBuffer().add(input);
 
+    // Release to the pool before the callback so it can reuse the connection
+    bool queued = getNumRequests();
+    bool keep = !req->needsClose() && (queued || release(req));
+
     // Callback
     req->onResponse(CONN_ERR_OK);
 
     // If not closing send next request
-    if (!req->needsClose()) return dispatch();
+    if (keep) {
+      if (queued) dispatch();
+      return;
+    }
   } CATCH_ERROR;
 
   close();
@@ -222,3 +257,11 @@ void ConnOut::process(const SmartPointer<Request> &req) {
 void ConnOut::dispatch() {
   if (isConnected() && getNumRequests()) getRequest()->write();
 }
+
+
+bool ConnOut::release(const SmartPointer<Request> &req) {
+  SmartPointer<ConnPool> pool = this->pool;
+  if (pool.isNull()) return true; // Not pooled, leave open
+
+  return req->isPersistent() && input.isEmpty() && pool->release(*this);
+}
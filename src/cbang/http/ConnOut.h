@@ -37,10 +37,24 @@
 
 namespace cb {
   namespace HTTP {
+    class ConnPool;
+
     class ConnOut : public Conn {
+      SmartPointer<ConnPool>::Weak pool;
+      std::string poolKey;
+      bool reused = false;
+
     public:
       ConnOut(Event::Base &base);
 
+      void setPool(const SmartPointer<ConnPool> &pool, const std::string &key);
+      const std::string &getPoolKey() const {return poolKey;}
+      bool isReused() const {return reused;}
+      void setReused(bool reused) {this->reused = reused;}
+
+      // From FD
+      void close() override;
+
       // From Connection
       void onConnect(bool success) override;
 
@@ -56,6 +70,7 @@ namespace cb {
       void readBody(const SmartPointer<Request> &req);
       void process(const SmartPointer<Request> &req);
       void dispatch();
+      bool release(const SmartPointer<Request> &req);
     };
   }
 }
@@ -0,0 +1,239 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2021-2026, Cauldron Development  Oy
+                Copyright (c) 2003-2021, Cauldron Development LLC
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include "ConnPool.h"
+#include "ConnOut.h"
+#include "Client.h"
+#include "Request.h"
+
+#include <cbang/Catch.h>
+#include <cbang/String.h>
+#include <cbang/net/URI.h>
+#include <cbang/net/Socket.h>
+#include <cbang/event/Base.h>
+#include <cbang/event/Event.h>
+#include <cbang/time/Timer.h>
+#include <cbang/log/Logger.h>
+
+using namespace std;
+using namespace cb;
+using namespace cb::HTTP;
+
+
+ConnPool::ConnPool(Client &client) :
+  client(client),
+  expireEvent(client.getBase().newEvent([this] {expire();}, 0)) {}
+
+
+ConnPool::~ConnPool() {clear();}
+
+
+void ConnPool::setMaxIdle(unsigned x) {
+  maxIdle = x;
+  if (!x) clear();
+}
+
+
+string ConnPool::getKey(const URI &uri, const SockAddr &bind) {
+  string key = uri.schemeRequiresSSL() ? "https://" : "http://";
+
+  if (uri.isUnix()) return key + "unix:" + uri.getUnixPath();
+
+  key += uri.getHost() + ":" + String(uri.getPort());
+  if (!bind.isNull()) key += "@" + bind.toString(false);
+
+  return key;
+}
+
+
+SmartPointer<ConnOut> ConnPool::get(const string &key) {
+  auto it = idle.find(key);
+
+  while (it != idle.end() && !it->second.empty()) {
+    auto &conns = it->second;
+    auto conn = conns.back().conn;
+    conns.pop_back();
+    numIdle--;
+
+    // An idle connection should have nothing to read.  If it does the peer
+    // either closed it or sent something unexpected.
+    if (conn->isConnected() && !conn->getSocket()->canRead()) {
+      if (conns.empty()) idle.erase(it);
+      active.insert(conn);
+      conn->setReused(true);
+      event("hit");
+      return conn;
+    }
+
+    LOG_DEBUG(4, "Discarding stale connection to " << key);
+    event("stale");
+    conn->close();
+  }
+
+  if (it != idle.end()) idle.erase(it);
+  event("miss");
+
+  return 0;
+}
+
+
+SmartPointer<ConnOut> ConnPool::create(const string &key) {
+  auto conn = SmartPtr(new ConnOut(client.getBase()));
+  conn->setPool(this, key);
+  active.insert(conn);
+  return conn;
+}
+
+
+void ConnPool::clear() {
+  auto idle = this->idle;
+  this->idle.clear();
+  numIdle = 0;
+  expireEvent->del();
+
+  for (auto &p: idle)
+    for (auto &entry: p.second)
+      entry.conn->close();
+}
+
+
+bool ConnPool::release(ConnOut &_conn) {
+  SmartPointer<ConnOut> conn = &_conn;
+  active.erase(conn);
+
+  if (!isEnabled()) return false;
+
+  auto &conns = idle[conn->getPoolKey()];
+  if (maxIdlePerHost <= conns.size()) evict(conns, conns.begin());
+
+  // Evict the oldest idle connection across all hosts
+  if (maxIdle <= numIdle) {
+    idle_t *oldest = 0;
+
+    for (auto &p: idle)
+      if (!p.second.empty() &&
+          (!oldest || p.second.front().expires < oldest->front().expires))
+        oldest = &p.second;
+
+    if (oldest) evict(*oldest, oldest->begin());
+  }
+
+  conns.push_back(Idle{conn, Timer::now() + idleTimeout});
+  numIdle++;
+
+  if (!expireEvent->isPending()) expireEvent->add(idleTimeout);
+
+  return true;
+}
+
+
+void ConnPool::remove(ConnOut &_conn) {
+  SmartPointer<ConnOut> conn = &_conn;
+  active.erase(conn);
+
+  auto it = idle.find(conn->getPoolKey());
+  if (it == idle.end()) return;
+
+  auto &conns = it->second;
+  for (auto it2 = conns.begin(); it2 != conns.end(); it2++)
+    if (it2->conn == conn) {
+      conns.erase(it2);
+      numIdle--;
+      if (conns.empty()) idle.erase(it);
+      break;
+    }
+}
+
+
+bool ConnPool::retry(const SmartPointer<Request> &req, bool sent) {
+  // Only retry a request the server may have seen if it is idempotent and
+  // its body has not been consumed
+  if (sent) {
+    switch (req->getMethod()) {
+    case HTTP_GET: case HTTP_HEAD: case HTTP_OPTIONS: case HTTP_TRACE:
+    case HTTP_PUT: case HTTP_DELETE: break;
+    default: return false;
+    }
+
+    string length = req->outFind("Content-Length");
+    if (!length.empty() && length != "0") return false;
+  }
+
+  try {
+    LOG_DEBUG(3, "Retrying " << req->getMethod() << ' ' << req->getURI()
+              << " on a new connection");
+    event("retry");
+
+    req->setConnection(0);
+    client.send(req, false);
+
+    return true;
+  } CATCH_ERROR;
+
+  return false;
+}
+
+
+void ConnPool::event(const string &key) {
+  if (stats.isSet()) stats->event(key);
+}
+
+
+void ConnPool::evict(idle_t &conns, idle_t::iterator it) {
+  auto conn = it->conn;
+  conns.erase(it);
+  numIdle--;
+  event("evict");
+  conn->close();
+}
+
+
+void ConnPool::expire() {
+  double now = Timer::now();
+  double next = 0;
+
+  for (auto it = idle.begin(); it != idle.end();) {
+    auto &conns = it->second;
+
+    while (!conns.empty() && conns.front().expires <= now)
+      evict(conns, conns.begin());
+
+    if (conns.empty()) idle.erase(it++);
+    else {
+      double expires = conns.front().expires;
+      if (!next || expires < next) next = expires;
+      it++;
+    }
+  }
+
+  if (next) expireEvent->add(next - now);
+}
@@ -0,0 +1,114 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2021-2026, Cauldron Development  Oy
+                Copyright (c) 2003-2021, Cauldron Development LLC
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#pragma once
+
+#include "Enum.h"
+
+#include <cbang/SmartPointer.h>
+#include <cbang/util/RateCollection.h>
+
+#include <string>
+#include <list>
+#include <map>
+#include <set>
+
+
+namespace cb {
+  class URI;
+  class SockAddr;
+  namespace Event {class Base; class Event;}
+
+  namespace HTTP {
+    class Client;
+    class ConnOut;
+    class Request;
+
+    /// Keeps idle keep-alive client connections for reuse
+    class ConnPool : public RefCounted, public Enum {
+      Client &client;
+      SmartPointer<Event::Event> expireEvent;
+
+      unsigned maxIdle        = 64;
+      unsigned maxIdlePerHost = 8;
+      double   idleTimeout    = 30;
+      SmartPointer<RateCollection> stats;
+
+      struct Idle {
+        SmartPointer<ConnOut> conn;
+        double expires;
+      };
+
+      typedef std::list<Idle> idle_t;
+      std::map<std::string, idle_t> idle;
+      unsigned numIdle = 0;
+
+      std::set<SmartPointer<ConnOut>> active;
+
+    public:
+      ConnPool(Client &client);
+      ~ConnPool();
+
+      unsigned getMaxIdle() const {return maxIdle;}
+      void setMaxIdle(unsigned x);
+      unsigned getMaxIdlePerHost() const {return maxIdlePerHost;}
+      void setMaxIdlePerHost(unsigned x) {maxIdlePerHost = x;}
+      double getIdleTimeout() const {return idleTimeout;}
+      void setIdleTimeout(double x) {idleTimeout = x;}
+
+      const SmartPointer<RateCollection> &getStats() const {return stats;}
+      void setStats(const SmartPointer<RateCollection> &stats)
+      {this->stats = stats;}
+
+      bool isEnabled() const {return maxIdle && maxIdlePerHost;}
+      unsigned getNumIdle() const {return numIdle;}
+      unsigned getNumActive() const {return active.size();}
+
+      static std::string getKey(const URI &uri, const SockAddr &bind);
+
+      /// Returns a healthy idle connection or null
+      SmartPointer<ConnOut> get(const std::string &key);
+      SmartPointer<ConnOut> create(const std::string &key);
+      void clear();
+
+      // Called by ConnOut
+      bool release(ConnOut &conn);
+      void remove(ConnOut &conn);
+      bool retry(const SmartPointer<Request> &req, bool sent);
+
+    protected:
+      void event(const std::string &key);
+      void evict(idle_t &conns, idle_t::iterator it);
+      void expire();
+    };
+  }
+}
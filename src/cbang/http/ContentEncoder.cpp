@@ -0,0 +1,195 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2021-2026, Cauldron Development  Oy
+                Copyright (c) 2003-2021, Cauldron Development LLC
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+
+#include "ContentEncoder.h"
+
+#include <cbang/Exception.h>
+#include <cbang/event/Buffer.h>
+
+#include <event2/util.h> // For iovec
+
+#include <zlib.h>
+#include <lz4frame.h>
+
+#include <cstring>
+
+using namespace std;
+using namespace cb;
+using namespace cb::HTTP;
+
+
+namespace {
+  class ZLibEncoder : public ContentEncoder {
+    z_stream strm;
+
+  public:
+    ZLibEncoder(bool gzip) {
+      memset(&strm, 0, sizeof(strm));
+
+      // Window bits of 31 selects a gzip header
+      if (deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                       gzip ? 31 : 15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        THROW("Failed to initialize zlib");
+    }
+
+    ~ZLibEncoder() {deflateEnd(&strm);}
+
+
+    void deflate(const char *data, unsigned length, Event::Buffer &out,
+                 int flush) {
+      strm.next_in  = (Bytef *)data;
+      strm.avail_in = length;
+
+      do {
+        char buffer[16384];
+        strm.next_out  = (Bytef *)buffer;
+        strm.avail_out = sizeof(buffer);
+
+        if (::deflate(&strm, flush) == Z_STREAM_ERROR)
+          THROW("zlib compression failed");
+
+        out.add(buffer, sizeof(buffer) - strm.avail_out);
+      } while (!strm.avail_out);
+    }
+
+
+    // From ContentEncoder
+    using ContentEncoder::encode;
+
+    void encode(const char *data, unsigned length, Event::Buffer &out,
+                bool flush) override {
+      deflate(data, length, out, flush ? Z_SYNC_FLUSH : Z_NO_FLUSH);
+    }
+
+    void finish(Event::Buffer &out) override {deflate(0, 0, out, Z_FINISH);}
+  };
+
+
+  class LZ4Encoder : public ContentEncoder {
+    LZ4F_cctx *ctx = 0;
+    bool started = false;
+    string buffer;
+
+  public:
+    LZ4Encoder() {
+      auto err = LZ4F_createCompressionContext(&ctx, LZ4F_VERSION);
+      if (LZ4F_isError(err))
+        THROW("LZ4 error: " << LZ4F_getErrorName(err));
+    }
+
+    ~LZ4Encoder() {LZ4F_freeCompressionContext(ctx);}
+
+
+    size_t check(size_t ret) {
+      if (LZ4F_isError(ret)) THROW("LZ4 error: " << LZ4F_getErrorName(ret));
+      return ret;
+    }
+
+
+    char *reserve(size_t bytes) {
+      if (buffer.size() < bytes) buffer.resize(bytes);
+      return &buffer[0];
+    }
+
+
+    void begin(Event::Buffer &out) {
+      if (started) return;
+      started = true;
+
+      char *dst = reserve(LZ4F_HEADER_SIZE_MAX);
+      out.add(dst, check(LZ4F_compressBegin(ctx, dst, buffer.size(), 0)));
+    }
+
+
+    // From ContentEncoder
+    using ContentEncoder::encode;
+
+    void encode(const char *data, unsigned length, Event::Buffer &out,
+                bool flush) override {
+      begin(out);
+
+      char *dst = reserve(LZ4F_compressBound(length, 0));
+      out.add(dst, check(LZ4F_compressUpdate(
+                ctx, dst, buffer.size(), data, length, 0)));
+
+      if (flush)
+        out.add(dst, check(LZ4F_flush(ctx, dst, buffer.size(), 0)));
+    }
+
+
+    void finish(Event::Buffer &out) override {
+      begin(out);
+
+      char *dst = reserve(LZ4F_compressBound(0, 0));
+      out.add(dst, check(LZ4F_compressEnd(ctx, dst, buffer.size(), 0)));
+    }
+  };
+}
+
+
+void ContentEncoder::encode(Event::Buffer &in, Event::Buffer &out,
+                            bool flush) {
+  while (in.getLength()) {
+    iovec space;
+    in.peek(in.getLength(), space);
+
+    bool last = space.iov_len == in.getLength();
+    encode((const char *)space.iov_base, space.iov_len, out, flush && last);
+    in.drain(space.iov_len);
+  }
+}
+
+
+void ContentEncoder::encode(const string &in, Event::Buffer &out) {
+  encode(in.data(), in.length(), out, false);
+}
+
+
+bool ContentEncoder::isSupported(Compression compression) {
+  switch (compression) {
+  case Compression::COMPRESSION_GZIP: case Compression::COMPRESSION_ZLIB:
+  case Compression::COMPRESSION_LZ4:
+    return true;
+  default: return false;
+  }
+}
+
+
+SmartPointer<ContentEncoder> ContentEncoder::create(Compression compression) {
+  switch (compression) {
+  case Compression::COMPRESSION_GZIP: return new ZLibEncoder(true);
+  case Compression::COMPRESSION_ZLIB: return new ZLibEncoder(false);
+  case Compression::COMPRESSION_LZ4:  return new LZ4Encoder;
+  default: THROW("Unsupported content encoding " << compression);
+  }
+}
@@ -0,0 +1,65 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2021-2026, Cauldron Development  Oy
+                Copyright (c) 2003-2021, Cauldron Development LLC
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+
+#pragma once
+
+#include <cbang/SmartPointer.h>
+#include <cbang/comp/Compression.h>
+
+
+namespace cb {
+  namespace Event {class Buffer;}
+
+  namespace HTTP {
+    /// Incrementally compresses an HTTP message body
+    class ContentEncoder {
+    public:
+      virtual ~ContentEncoder() {}
+
+      /***
+       * Drain and compress @param in, appending output to @param out.
+       * If @param flush is true all pending output is written so the data
+       * so far can be decoded by the receiver.
+       */
+      void encode(Event::Buffer &in, Event::Buffer &out, bool flush = false);
+      void encode(const std::string &in, Event::Buffer &out);
+
+      virtual void encode(const char *data, unsigned length,
+                          Event::Buffer &out, bool flush) = 0;
+      virtual void finish(Event::Buffer &out) = 0;
+
+      static bool isSupported(Compression compression);
+      static SmartPointer<ContentEncoder> create(Compression compression);
+    };
+  }
+}
@@ -32,19 +32,87 @@
 
 #include "FileHandler.h"
 #include "Request.h"
+#include "Conn.h"
+#include "ContentEncoder.h"
 
+#include <cbang/String.h>
 #include <cbang/event/Buffer.h>
+#include <cbang/event/FileSegment.h>
 #include <cbang/os/SystemUtilities.h>
 #include <cbang/log/Logger.h>
+#include <cbang/thread/SmartLock.h>
+
+#ifdef HAVE_OPENSSL
+#include <cbang/openssl/SSL.h>
+#endif
+
+#include <sys/types.h>
+#include <sys/stat.h>
 
 using namespace std;
 using namespace cb;
 using namespace cb::HTTP;
 
 
+namespace {
+  const char *httpDateFormat = "%a, %d %b %Y %H:%M:%S GMT";
+
+
+  bool matchETag(const string &header, const string &etag) {
+    vector<string> tags;
+    String::tokenize(header, tags, ", \t");
+
+    for (auto &tag: tags)
+      if (tag == "*" || tag == etag || tag == "W/" + etag) return true;
+
+    return false;
+  }
+
+
+  enum range_t {RANGE_NONE, RANGE_PARTIAL, RANGE_UNSATISFIABLE};
+
+
+  range_t parseRange(const string &header, uint64_t size, uint64_t &offset,
+                     uint64_t &length) {
+    // Only a single range is supported, others get the whole file
+    if (!String::startsWith(header, "bytes=")) return RANGE_NONE;
+    string spec = header.substr(6);
+    size_t dash = spec.find('-');
+    if (dash == string::npos || spec.find(',') != string::npos)
+      return RANGE_NONE;
+
+    string first = String::trim(spec.substr(0, dash));
+    string last  = String::trim(spec.substr(dash + 1));
+
+    try {
+      if (first.empty()) { // Suffix range
+        uint64_t n = String::parseU64(last, true);
+        if (!n || !size) return RANGE_UNSATISFIABLE;
+        length = n < size ? n : size;
+        offset = size - length;
+        return RANGE_PARTIAL;
+      }
+
+      uint64_t start = String::parseU64(first, true);
+      if (size <= start) return RANGE_UNSATISFIABLE;
+      uint64_t end   = last.empty() ? size - 1 : String::parseU64(last, true);
+      if (end < start) return RANGE_NONE;
+      if (size <= end) end = size - 1;
+
+      offset = start;
+      length = end - start + 1;
+      return RANGE_PARTIAL;
+
+    } catch (const Exception &e) {return RANGE_NONE;}
+  }
+}
+
+
 FileHandler::FileHandler(const JSON::ValuePtr &config) :
   FileHandler(config->getString("path"), config->getU32("prefix", 0),
-    config->getString("index", "")) {}
+    config->getString("index", "")) {
+  maxAge = config->getU32("max-age", 0);
+}
 
 
 FileHandler::FileHandler(const string &root, unsigned pathPrefix,
@@ -54,44 +122,229 @@ FileHandler::FileHandler(const string &root, unsigned pathPrefix,
 
 
 bool FileHandler::operator()(Request &req) {
-  string path;
+  string path = getPath(req);
+
+  LOG_INFO(5, "FileHandler() " << path);
+
+  auto entry = lookup(path);
+  if (entry.isNull()) return false;
+
+  if (!req.hasContentType())
+    req.getOutputHeaders().guessContentType(SystemUtilities::extension(path));
+
+  // Select a representation.  Prefer a precompressed sibling file, then a
+  // compressed copy of a small cached file.
+  string etag           = entry->etag;
+  uint64_t size         = entry->size;
+  const string *data    = &entry->data;
+  auto segment          = entry->segment;
+  Compression encoding  = req.negotiateCompression(entry->size);
+
+  SmartPointer<Entry> sibling;
+
+  if (encoding) {
+    sibling = lookup(path + compressionExtension(encoding));
+
+    if (sibling.isSet() && entry->mtime <= sibling->mtime) {
+      etag    = sibling->etag;
+      size    = sibling->size;
+      data    = &sibling->data;
+      segment = sibling->segment;
+
+    } else if (segment.isNull()) {
+      SmartLock lock(&cacheLock);
+      auto it = entry->encoded.find(encoding);
+
+      if (it == entry->encoded.end()) {
+        Event::Buffer buf;
+        auto encoder = ContentEncoder::create(encoding);
+        encoder->encode(entry->data, buf);
+        encoder->finish(buf);
+
+        it = entry->encoded.insert(
+          make_pair((unsigned)encoding, buf.toString())).first;
+        if (entry->cached) cacheBytes += it->second.length();
+      }
+
+      etag = entry->etag.substr(0, entry->etag.length() - 1) + "-" +
+        String::toLower(encoding.toString()) + "\"";
+      size = it->second.length();
+      data = &it->second;
+
+    } else encoding = COMPRESSION_NONE; // Not compressed per request
+  }
+
+  if (encoding) req.outSetContentEncoding(encoding);
+  req.setAutoCompression(false);
+
+  req.outSet("ETag", etag);
+  req.outSet("Last-Modified", entry->lastModified);
+  req.outSet("Accept-Ranges", "bytes");
+  if (maxAge) req.outSet("Cache-Control", "max-age=" + String(maxAge));
+
+  bool head = req.getMethod() == HTTP_HEAD;
+  bool get = head || req.getMethod() == HTTP_GET;
 
-  if (directory) {
-    string orig = req.getURI().getPath();
-    if (orig.length() <= pathPrefix) return false;
-    orig = orig.substr(pathPrefix);
+  // Conditional GET
+  if (get) {
+    bool notModified = false;
 
-    // Remove unsafe parts
-    vector<string> parts;
-    String::tokenize(orig, parts, "/");
-    vector<string> result;
+    if (req.inHas("If-None-Match"))
+      notModified = matchETag(req.inGet("If-None-Match"), etag);
 
-    for (auto &part: parts) {
-      if (part == ".") continue;
-      if (part == "..") {
-        if (result.empty()) THROWX("Invalid path", HTTP_UNAUTHORIZED);
-        result.pop_back();
+    else if (req.inHas("If-Modified-Since"))
+      try {
+        notModified = entry->mtime <=
+          Time::parse(req.inGet("If-Modified-Since"), httpDateFormat);
+      } catch (const Exception &e) {} // Ignore invalid dates
 
-      } else result.push_back(part);
+    if (notModified) {
+      req.reply(HTTP_NOT_MODIFIED);
+      return true;
     }
+  }
 
-    // Relative to root
-    path = SystemUtilities::joinPath(root, String::join(result, "/"));
+  // Byte range
+  uint64_t offset = 0;
+  uint64_t length = size;
+  range_t range   = RANGE_NONE;
 
-    // Handle index
-    if (!index.empty() && SystemUtilities::isDirectory(path))
-      path += "/" + index;
+  if (get && req.inHas("Range")) {
+    // Ignore the range if the file changed
+    string ifRange = req.inFind("If-Range");
 
-  } else path = root; // Single file
+    if (ifRange.empty() || ifRange == etag || ifRange == entry->lastModified)
+      range = parseRange(req.inGet("Range"), size, offset, length);
+  }
 
-  LOG_INFO(5, "FileHandler() " << path);
+  if (range == RANGE_UNSATISFIABLE) {
+    req.outSet("Content-Range", "bytes */" + String(size));
+    req.reply(HTTP_REQUESTED_RANGE_NOT_SATISFIABLE);
+    return true;
+  }
 
-  if (!SystemUtilities::isFile(path)) return false;
+  if (range == RANGE_PARTIAL)
+    req.outSet("Content-Range", String::printf("bytes %llu-%llu/%llu",
+      (unsigned long long)offset, (unsigned long long)(offset + length - 1),
+      (unsigned long long)size));
 
   // Send file
   Event::Buffer buf;
-  buf.addFile(path);
-  req.reply(buf);
+
+  if (head) req.outSet("Content-Length", String(length));
+
+  else if (segment.isSet()) {
+    // Write the file straight from the page cache unless encrypting in
+    // user space
+    bool sendfile = true;
+#ifdef HAVE_OPENSSL
+    auto &ssl = req.getConnection()->getSSL();
+    sendfile = ssl.isNull() || ssl->isKTLSSend();
+#endif
+    if (sendfile) buf.enableSendfile();
+    buf.addFile(*segment, offset, length);
+
+  } else buf.add(data->data() + offset, length);
+
+  req.reply(range == RANGE_PARTIAL ? HTTP_PARTIAL_CONTENT : HTTP_OK, buf);
 
   return true;
 }
+
+
+string FileHandler::getPath(Request &req) const {
+  if (!directory) return root; // Single file
+
+  string orig = req.getURI().getPath();
+  if (orig.length() <= pathPrefix) return string();
+  orig = orig.substr(pathPrefix);
+
+  // Remove unsafe parts
+  vector<string> parts;
+  String::tokenize(orig, parts, "/");
+  vector<string> result;
+
+  for (auto &part: parts) {
+    if (part == ".") continue;
+    if (part == "..") {
+      if (result.empty()) THROWX("Invalid path", HTTP_UNAUTHORIZED);
+      result.pop_back();
+
+    } else result.push_back(part);
+  }
+
+  // Relative to root
+  string path = SystemUtilities::joinPath(root, String::join(result, "/"));
+
+  // Handle index
+  if (!index.empty() && SystemUtilities::isDirectory(path))
+    path += "/" + index;
+
+  return path;
+}
+
+
+SmartPointer<FileHandler::Entry> FileHandler::lookup(const string &path) {
+  if (path.empty()) return 0;
+
+  struct stat info;
+  bool isFile = !stat(path.c_str(), &info) &&
+    (info.st_mode & S_IFMT) == S_IFREG;
+
+  SmartLock lock(&cacheLock); // Shared by server threads
+  auto it = cache.find(path);
+
+  // Revalidate cached entry
+  if (it != cache.end()) {
+    auto &entry = *it->second;
+
+    if (isFile && entry->size == (uint64_t)info.st_size &&
+        entry->mtime == (uint64_t)info.st_mtime) {
+      lru.splice(lru.begin(), lru, it->second);
+      return entry;
+    }
+
+    evict(it->second);
+  }
+
+  if (!isFile) return 0;
+
+  auto entry = SmartPtr(new Entry);
+  entry->path  = path;
+  entry->size  = info.st_size;
+  entry->mtime = info.st_mtime;
+  entry->etag  = String::printf("\"%llx-%llx\"",
+                                (unsigned long long)entry->size,
+                                (unsigned long long)entry->mtime);
+  entry->lastModified = Time(entry->mtime).toString(httpDateFormat);
+
+  if (entry->size <= maxSmallFile) {
+    entry->data = SystemUtilities::read(path);
+    entry->size = entry->data.length(); // In case it changed
+    cacheBytes += entry->size;
+
+  } else {
+    entry->segment = new Event::FileSegment(path);
+    entry->size = entry->segment->getLength();
+  }
+
+  lru.push_front(entry);
+  cache[path] = lru.begin();
+
+  // Limit cache size
+  while (1 < lru.size() &&
+         (maxEntries < lru.size() || maxCacheBytes < cacheBytes))
+    evict(prev(lru.end()));
+
+  return entry;
+}
+
+
+void FileHandler::evict(lru_t::iterator it) {
+  auto &entry = **it;
+  cacheBytes -= entry.data.length();
+  for (auto &e: entry.encoded) cacheBytes -= e.second.length();
+  entry.cached = false;
+  cache.erase(entry.path);
+  lru.erase(it);
+}
@@ -36,27 +36,77 @@
 
 #include <cbang/json/Value.h>
 #include <cbang/time/Time.h>
+#include <cbang/thread/Mutex.h>
 
 #include <string>
+#include <list>
+#include <map>
+#include <unordered_map>
 
 
 namespace cb {
+  namespace Event {class FileSegment;}
+
   namespace HTTP {
     class Request;
 
+    /***
+     * Serves static files.
+     *
+     * File metadata is cached and revalidated against the file's size and
+     * modification time on each hit.  Small files are also cached in memory
+     * and large files are kept open and sent with sendfile where possible.
+     * Supports conditional GET and single byte ranges.  Compressed responses
+     * are served from precompressed sibling files, e.g. ``app.js.gz``, or
+     * from compressed copies of small files made once and cached.
+     */
     class FileHandler : public RequestHandler {
       std::string root;
       unsigned    pathPrefix;
       std::string index;
       bool        directory;
 
+      unsigned maxAge        = 0;         // Cache-Control max-age if not zero
+      uint64_t maxSmallFile  = 64 * 1024; // Larger files are not held in memory
+      uint64_t maxCacheBytes = 32 * 1024 * 1024;
+      unsigned maxEntries    = 1024;
+
+      struct Entry {
+        std::string path;
+        uint64_t size;
+        uint64_t mtime;
+        std::string etag;
+        std::string lastModified;
+        std::string data;                          // Small files
+        SmartPointer<Event::FileSegment> segment;  // Large files
+        std::map<unsigned, std::string> encoded;   // Compressed small files
+        bool cached = true;
+      };
+
+      // Entries are shared so a request may keep using one after another
+      // server thread evicts it.  Only ``encoded`` changes once an entry is
+      // made and it is guarded by ``cacheLock`` along with the cache.
+      typedef std::list<SmartPointer<Entry>> lru_t;
+      lru_t lru; // Most recently used first
+      std::unordered_map<std::string, lru_t::iterator> cache;
+      uint64_t cacheBytes = 0;
+      Mutex cacheLock;
+
     public:
       FileHandler(const JSON::ValuePtr &config);
       FileHandler(const std::string &root, unsigned pathPrefix = 0,
         const std::string &index = std::string());
 
+      unsigned getMaxAge() const {return maxAge;}
+      void setMaxAge(unsigned maxAge) {this->maxAge = maxAge;}
+
       // From RequestHandler
       bool operator()(Request &req) override;
+
+    protected:
+      std::string getPath(Request &req) const;
+      SmartPointer<Entry> lookup(const std::string &path);
+      void evict(lru_t::iterator it);
     };
   }
 }
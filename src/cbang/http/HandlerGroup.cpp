@@ -37,6 +37,8 @@
 #include "IndexHandler.h"
 #include "FileHandler.h"
 
+#include <cbang/thread/SmartLock.h>
+
 #include <memory>
 
 using namespace cb::HTTP;
@@ -44,13 +46,22 @@ using namespace cb;
 using namespace std;
 
 
-void HandlerGroup::addHandler(
-  const SmartPointer<RequestHandler> &handler) {handlers.push_back(handler);}
+void HandlerGroup::addHandler(const SmartPointer<RequestHandler> &handler) {
+  checkHandler(*handler);
+  routes.push_back(Router::Route(handler));
+  router.release();
+  compiled = false;
+}
 
 
 void HandlerGroup::addHandler(unsigned methods, const string &pattern,
                               const SmartPointer<RequestHandler> &handler) {
-  addHandler(createMatcher(methods, prefix + pattern, handler));
+  checkHandler(*handler);
+  string search = prefix + pattern;
+  auto matcher = createMatcher(methods, search, handler);
+  routes.push_back(Router::Route(methods, search, matcher, handler));
+  router.release();
+  compiled = false;
 }
 
 
@@ -64,6 +75,18 @@ void HandlerGroup::addHandler(const string &pattern, const string &path) {
 }
 
 
+const SmartPointer<Router> &HandlerGroup::getRouter() {
+  // Server threads may race to compile the first request's router
+  if (!compiled) {
+    SmartLock lock(&compileLock);
+    if (router.isNull()) router = new Router(routes);
+    compiled = true;
+  }
+
+  return router;
+}
+
+
 SmartPointer<HandlerGroup> HandlerGroup::addGroup() {
   SmartPointer<HandlerGroup> group = new HandlerGroup;
   addHandler(group);
@@ -81,16 +104,9 @@ SmartPointer<HandlerGroup> HandlerGroup::addGroup(
 
 
 void HandlerGroup::operator()(Request &req, const RequestCont &next) {
-  // Fold the handlers right-to-left into one continuation: each handler's
-  // `next` runs the remaining handlers and finally the group's own `next`.
-  RequestCont chain = next;
-  for (auto it = handlers.rbegin(); it != handlers.rend(); ++it) {
-    auto handler = *it;
-    RequestCont rest = chain;
-    chain = [handler, rest] (Request &req) {(*handler)(req, rest);};
-  }
-
-  chain(req);
+  // The router only calls the handlers whose method and pattern match, in
+  // order, each one's `next` continuing with the rest and finally our `next`.
+  (*getRouter())(req, next);
 }
 
 
@@ -105,16 +121,25 @@ bool HandlerGroup::operator()(Request &req) {
   //
   // The flags are shared so they remain valid if the terminal runs after this
   // returns (i.e. a handler deferred and the chain later fell through).
-  auto sync    = std::make_shared<bool>(true);
-  auto handled = std::make_shared<bool>(true);
+  struct Flags {bool sync = true; bool handled = true;};
+  auto flags =
+    std::allocate_shared<Flags>(ArenaAllocator<Flags>(req.getArena()));
 
-  (*this)(req, [sync, handled] (Request &req) {
-    if (*sync) *handled = false;
+  (*this)(req, [flags] (Request &req) {
+    if (flags->sync) flags->handled = false;
     else req.sendError(HTTP_NOT_FOUND);
   });
 
-  *sync = false;
-  return *handled;
+  flags->sync = false;
+  return flags->handled;
+}
+
+
+bool HandlerGroup::isThreadSafe() const {
+  for (auto &route: routes)
+    if (!route.child->isThreadSafe()) return false;
+
+  return true;
 }
 
 
@@ -33,8 +33,12 @@
 #pragma once
 
 #include "RequestHandlerFactory.h"
+#include "Router.h"
+
+#include <cbang/thread/Mutex.h>
 
 #include <vector>
+#include <atomic>
 
 
 namespace cb {
@@ -42,8 +46,10 @@ namespace cb {
 
   namespace HTTP {
     class HandlerGroup : public RequestHandler {
-      typedef std::vector<SmartPointer<RequestHandler> > handlers_t;
-      handlers_t handlers;
+      std::vector<Router::Route> routes;
+      SmartPointer<Router> router;
+      std::atomic<bool> compiled{false};
+      Mutex compileLock;
 
       std::string prefix;
       bool autoIndex = true;
@@ -53,7 +59,7 @@ namespace cb {
       HandlerGroup(const std::string &prefix) : prefix(prefix) {}
       virtual ~HandlerGroup() {}
 
-      bool isEmpty() const {return handlers.empty();}
+      bool isEmpty() const {return routes.empty();}
 
       const std::string &getPrefix() const {return prefix;}
       void setPrefix(const std::string &prefix) {this->prefix = prefix;}
@@ -71,6 +77,9 @@ namespace cb {
       void addHandler(const std::string &pattern, const std::string &path);
       void addHandler(const std::string &path) {addHandler("", path);}
 
+      /// Compiled on first use after the handlers change
+      const SmartPointer<Router> &getRouter();
+
       SmartPointer<HandlerGroup> addGroup();
       SmartPointer<HandlerGroup>
       addGroup(unsigned methods, const std::string &pattern,
@@ -104,7 +113,13 @@ namespace cb {
       // From RequestHandler
       void operator()(Request &req, const RequestCont &next) override;
       bool operator()(Request &req) override;
+      bool isThreadSafe() const override;
 
+    protected:
+      /// Called before a handler is added
+      virtual void checkHandler(const RequestHandler &handler) {}
+
+    public:
       // Factory callbacks
       virtual SmartPointer<RequestHandler>
       createMatcher(unsigned methods, const std::string &search,
@@ -0,0 +1,143 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2021-2026, Cauldron Development  Oy
+                Copyright (c) 2003-2021, Cauldron Development LLC
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+
+#include "HeaderWriter.h"
+
+#include <cbang/event/Buffer.h>
+#include <cbang/time/Time.h>
+
+#include <event2/buffer.h>
+
+using namespace cb::HTTP;
+using namespace cb;
+using namespace std;
+
+
+namespace {
+  vector<string> buildStatusLines(unsigned minor) {
+    vector<string> lines(600);
+
+    for (unsigned i = 0; i < Status::getCount(); i++) {
+      Status status = Status::getValue(i);
+      if (!status || 600 <= status) continue;
+
+      lines[status] = SSTR("HTTP/1." << minor << ' ' << (unsigned)status
+                           << ' ' << status.getDescription() << "\r\n");
+    }
+
+    return lines;
+  }
+}
+
+
+HeaderWriter::HeaderWriter(Event::Buffer &buf, unsigned size) :
+  buf(buf), space(1) {reserve(size);}
+
+
+HeaderWriter::~HeaderWriter() {commit();}
+
+
+void HeaderWriter::add(const char *data, unsigned length) {
+  reserve(length);
+  copy(data, length);
+}
+
+
+void HeaderWriter::addHeader(const char *key, unsigned keyLength,
+                             const char *value, unsigned valueLength) {
+  reserve(keyLength + valueLength + 4);
+  copy(key, keyLength);
+  copy(": ", 2);
+  copy(value, valueLength);
+  copy("\r\n", 2);
+}
+
+
+void HeaderWriter::commit() {
+  if (!ptr) return;
+
+  space[0].iov_len = ptr - (char *)space[0].iov_base;
+  buf.commit(space);
+  ptr = 0;
+  avail = 0;
+}
+
+
+const string &HeaderWriter::getStatusLine(const Version &version,
+                                          Status code) {
+  static const string none;
+  static const vector<string> lines[2] = {
+    buildStatusLines(0), buildStatusLines(1)};
+
+  if (version.getMajor() != 1 || 1 < version.getMinor() ||
+      version.getRevision() || 600 <= code) return none;
+
+  return lines[version.getMinor()][code];
+}
+
+
+const string &HeaderWriter::getDate() {
+  // Per thread so server threads never share the cache
+  static thread_local uint64_t last = 0;
+  static thread_local string date;
+
+  uint64_t now = Time::now();
+  if (now != last) {
+    date = Time(now).toString("%a, %d %b %Y %H:%M:%S GMT");
+    last = now;
+  }
+
+  return date;
+}
+
+
+void HeaderWriter::reserve(unsigned size) {
+  if (size <= avail) return;
+
+  commit();
+
+  // Header blocks are small, reserve enough for the rest in one extent
+  space.resize(1);
+  buf.reserve(size < 1024 ? 1024 : size, space);
+  if (space.size() != 1) THROW("Failed to reserve header space");
+
+  ptr = (char *)space[0].iov_base;
+  avail = space[0].iov_len;
+}
+
+
+void HeaderWriter::copy(const char *data, unsigned length) {
+  memcpy(ptr, data, length);
+  ptr += length;
+  avail -= length;
+}
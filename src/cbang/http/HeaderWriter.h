@@ -0,0 +1,88 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2021-2026, Cauldron Development  Oy
+                Copyright (c) 2003-2021, Cauldron Development LLC
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+
+#pragma once
+
+#include "Status.h"
+
+#include <cbang/util/Version.h>
+
+#include <string>
+#include <vector>
+#include <cstring>
+
+#ifdef _WIN32
+struct evbuffer_iovec;
+typedef struct evbuffer_iovec iovec;
+
+#else
+struct iovec;
+#endif
+
+
+namespace cb {
+  namespace Event {class Buffer;}
+
+  namespace HTTP {
+    /// Serializes a header block directly into reserved buffer space
+    class HeaderWriter {
+      Event::Buffer &buf;
+      std::vector<iovec> space;
+      char *ptr = 0;
+      unsigned avail = 0;
+
+    public:
+      HeaderWriter(Event::Buffer &buf, unsigned size = 1024);
+      ~HeaderWriter();
+
+      void add(const char *data, unsigned length);
+      void add(const char *s) {add(s, strlen(s));}
+      void add(const std::string &s) {add(s.data(), s.length());}
+      void addHeader(const char *key, unsigned keyLength, const char *value,
+                     unsigned valueLength);
+      void addHeader(const std::string &key, const std::string &value)
+        {addHeader(key.data(), key.length(), value.data(), value.length());}
+      void commit();
+
+      /// @return The full status line or an empty string if not prebuilt
+      static const std::string &getStatusLine(
+        const Version &version, Status code);
+      /// @return The current HTTP date, formatted at most once per second
+      static const std::string &getDate();
+
+    protected:
+      void reserve(unsigned size);
+      void copy(const char *data, unsigned length);
+    };
+  }
+}
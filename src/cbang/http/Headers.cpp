@@ -30,6 +30,7 @@
 
 \******************************************************************************/
 
+
 #include "Headers.h"
 #include "ContentTypes.h"
 
@@ -38,56 +39,205 @@
 #include <cbang/Errors.h>
 #include <cbang/event/Buffer.h>
 
+#include <cstring>
+#include <algorithm>
+
 using namespace cb::HTTP;
+using namespace cb;
 using namespace std;
 
 
-bool Headers::has(const string &key) const {
-  return HeadersImpl::find(key) != end();
+namespace {
+  // Bounds the linear search for names which are not interned
+  const unsigned maxHeaders = 1024;
+
+  const char *names[] = {
+    "",
+#define CBANG_HTTP_HEADER(ID, NAME) NAME,
+#include "HeaderNames.def"
+  };
+
+
+  inline char lower(char c) {return ('A' <= c && c <= 'Z') ? c + 32 : c;}
+
+
+  bool iequals(const char *a, const char *b, unsigned length) {
+    for (unsigned i = 0; i < length; i++)
+      if (lower(a[i]) != lower(b[i])) return false;
+    return true;
+  }
+
+
+  uint32_t ihash(const char *s, unsigned length) {
+    uint32_t h = 2166136261U; // FNV-1a
+    for (unsigned i = 0; i < length; i++) h = (h ^ lower(s[i])) * 16777619U;
+    return h;
+  }
+
+
+  inline bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+  }
+
+
+  bool containsToken(const char *s, unsigned length, const char *token) {
+    unsigned tokenLength = strlen(token);
+    unsigned i = 0;
+
+    while (i < length) {
+      while (i < length && (s[i] == ' ' || s[i] == ',')) i++;
+
+      unsigned start = i;
+      while (i < length && s[i] != ' ' && s[i] != ',') i++;
+
+      if (i - start == tokenLength && iequals(s + start, token, tokenLength))
+        return true;
+    }
+
+    return false;
+  }
+
+
+  typedef vector<vector<Headers::header_id_t>> intern_table_t;
+
+  intern_table_t buildInternTable() {
+    intern_table_t table;
+
+    for (unsigned id = 1; id < Headers::HEADER_COUNT; id++) {
+      unsigned length = strlen(names[id]);
+      if (table.size() <= length) table.resize(length + 1);
+      table[length].push_back((Headers::header_id_t)id);
+    }
+
+    return table;
+  }
+}
+
+
+Headers::Headers(const SmartPointer<Arena> &arena) :
+  text(ArenaAllocator<char>(arena)), entries(ArenaAllocator<Entry>(arena)) {
+  reindex();
+}
+
+
+void Headers::clear() {
+  text.clear();
+  entries.clear();
+  reindex();
+}
+
+
+Headers::Iterator Headers::insert(const string &key, const string &value,
+                                  bool prepend) {
+  header_id_t id = intern(key);
+  int i = lookup(id, key.data(), key.length());
+
+  if (0 <= i) {
+    auto &e = entries[i];
+
+    // Values own their space in the text so shorter ones, or the last value
+    // in the text, are replaced in place
+    if (e.value + e.valueLength == text.size()) {
+      text.resize(e.value);
+      text.append(value);
+
+    } else if (e.valueLength < value.length()) {
+      e.value = text.size();
+      text.append(value);
+
+    } else text.replace(e.value, value.length(), value);
+
+    e.valueLength = value.length();
+    return Iterator(this, i);
+  }
+
+  uint32_t keyOffset = text.size();
+  text.append(key);
+  uint32_t valueOffset = text.size();
+  text.append(value);
+
+  add(id, keyOffset, key.length(), valueOffset, value.length());
+  if (!prepend) return Iterator(this, entries.size() - 1);
+
+  entries.insert(entries.begin(), entries.back());
+  entries.pop_back();
+  reindex();
+
+  return begin();
 }
 
 
+bool Headers::has(const string &key) const {return 0 <= lookup(key);}
+
+
 string Headers::find(const string &key) const {
-  auto it = HeadersImpl::find(key);
-  return it == end() ? "" : it.value();
+  int i = lookup(key);
+  return i < 0 ? string() : Iterator(this, i).value();
 }
 
 
-const string &Headers::get(const string &key) const {
-  auto it = HeadersImpl::find(key);
-  if (it == end()) CBANG_KEY_ERROR("Header '" << key << "' not found");
-  return it.value();
+string Headers::find(header_id_t id) const {
+  return has(id) ? Iterator(this, index[id]).value() : string();
 }
 
 
-const string &Headers::get(
-  const string &key, const string &defaultValue) const {
-  auto it = HeadersImpl::find(key);
-  return it == end() ? defaultValue : it.value();
+string Headers::get(const string &key) const {
+  int i = lookup(key);
+  if (i < 0) CBANG_KEY_ERROR("Header '" << key << "' not found");
+  return Iterator(this, i).value();
 }
 
 
-void Headers::remove(const string &key) {erase(key);}
+string Headers::get(const string &key, const string &defaultValue) const {
+  int i = lookup(key);
+  return i < 0 ? defaultValue : Iterator(this, i).value();
+}
+
 
+void Headers::remove(const string &key) {
+  int i = lookup(key);
+  if (i < 0) return;
 
-bool Headers::keyContains(const string &key, const string &value) const{
-  string hdr = String::toLower(find(key));
-  vector<string> parts;
+  entries.erase(entries.begin() + i);
+  reindex();
+}
 
-  String::tokenize(hdr, parts, " ,");
 
-  for (auto &part: parts)
-    if (part == String::toLower(value)) return true;
+bool Headers::keyContains(const string &key, const string &value) const {
+  int i = lookup(key);
+  if (i < 0) return false;
+
+  Iterator it(this, i);
+  return containsToken(it.valueData(), it.valueLength(), value.c_str());
+}
+
+
+bool Headers::keyContains(header_id_t id, const char *value) const {
+  if (!has(id)) return false;
+
+  Iterator it(this, index[id]);
+  return containsToken(it.valueData(), it.valueLength(), value);
+}
+
 
-  return false;
+bool Headers::hasContentType() const {
+  return has(HEADER_CONTENT_TYPE) &&
+    entries[index[HEADER_CONTENT_TYPE]].valueLength;
 }
 
 
-string Headers::getContentType() const {return find("Content-Type");}
+string Headers::getContentType() const {return find(HEADER_CONTENT_TYPE);}
 
 
 bool Headers::isJSONContentType() const {
-  return String::startsWith(getContentType(), "application/json");
+  if (!has(HEADER_CONTENT_TYPE)) return false;
+
+  const char *json = "application/json";
+  unsigned length = strlen(json);
+  Iterator it(this, index[HEADER_CONTENT_TYPE]);
+
+  return length <= it.valueLength() &&
+    strncmp(it.valueData(), json, length) == 0;
 }
 
 
@@ -102,58 +252,195 @@ void Headers::guessContentType(const string &ext) {
 
 
 /// @return true if we should send a "Connection: close" when request done.
-bool Headers::needsClose() const {return keyContains("Connection", "close");}
+bool Headers::needsClose() const {
+  return keyContains(HEADER_CONNECTION, "close");
+}
+
+
 bool Headers::connectionKeepAlive() const {
-  return keyContains("Connection", "keep-alive");
+  return keyContains(HEADER_CONNECTION, "keep-alive");
 }
 
 
 bool Headers::parse(Event::Buffer &buf, unsigned maxSize) {
-  unsigned bytes = 0;
-  string last;
+  // No headers
+  if (buf.indexOf("\r\n") == 0) {
+    buf.drain(2);
+    return true;
+  }
 
-  while (buf.getLength()) {
-    string line;
-    if (!buf.readLine(line, maxSize ? maxSize - bytes : 0)) return false;
+  int end = buf.indexOf("\r\n\r\n");
+  if (end < 0) {
+    if (maxSize && maxSize < buf.getLength()) THROW("Header too long");
+    return false;
+  }
 
-    // Last header
-    if (line.empty()) return true;
+  // Copy the whole block once, names and values are views into it
+  uint32_t length = end + 2;
+  if (maxSize && maxSize < length) THROW("Header too long");
 
-    bytes += line.length() + 2;
-    if (maxSize && maxSize < bytes) THROW("Header too long");
+  uint32_t start = text.size();
+  text.append(buf.pullup(length + 2), length);
+  buf.drain(length + 2);
 
-    // Continuation line
-    if (line[0] == ' ' || line[0] == '\t') {
-      auto it = HeadersImpl::find(last);
-      if (it == HeadersImpl::end()) THROW("Invalid header line: " << line);
-      it.value() += String::trim(line);
-      continue;
-    }
+  if (entries.empty()) entries.reserve(16);
 
-    // Parse
-    size_t semi = line.find_first_of(':');
-    if (semi == string::npos) THROW("Invalid header line: " << line);
+  // Repeated headers are merged after parsing so each value is copied once,
+  // however many lines it is spread over
+  vector<Merge> merges;
+  int last = -1;
+  for (uint32_t i = start; i < start + length;) {
+    uint32_t eol = i;
+    while (text[eol] != '\r' || text[eol + 1] != '\n') eol++;
 
-    string key = line.substr(0, semi);
-    string value = String::trim(line.substr(semi + 1));
+    parseLine(i, eol, last, merges);
+    i = eol + 2;
+  }
 
-    // See RFC 2616 Section 4.2 "Message Headers"
-    auto it = HeadersImpl::find(key);
-    if (it != end()) {
-      auto &h = it.value();
-      if (!String::trim(h).empty()) h += ", ";
-      h += value;
+  merge(merges);
+
+  return true;
+}
+
+
+void Headers::write(ostream &stream) const {
+  for (auto &it: *this) {
+    stream.write(it.keyData(), it.keyLength());
+    stream << ": ";
+    stream.write(it.valueData(), it.valueLength());
+    stream << '\n';
+  }
+}
+
+
+Headers::header_id_t Headers::intern(const char *name, unsigned length) {
+  static const intern_table_t table = buildInternTable();
 
-    } else insert(key, value);
+  if (length < table.size())
+    for (auto id: table[length])
+      if (iequals(names[id], name, length)) return id;
 
-    last = key;
+  return HEADER_UNKNOWN;
+}
+
+
+const char *Headers::getName(header_id_t id) {
+  if (HEADER_COUNT <= id) THROW("Invalid header id " << id);
+  return names[id];
+}
+
+
+int Headers::lookup(header_id_t id, const char *key, unsigned length) const {
+  if (id) return index[id];
+
+  uint32_t hash = ihash(key, length);
+
+  for (unsigned i = 0; i < entries.size(); i++) {
+    auto &e = entries[i];
+    if (!e.id && e.hash == hash && e.keyLength == length &&
+        iequals(data(e.key), key, length)) return i;
   }
 
-  return false;
+  return -1;
 }
 
 
-void Headers::write(ostream &stream) const {
-  for (auto it: *this)
-    stream << it.key() << ": " << it.value() << '\n';
+int Headers::lookup(const string &key) const {
+  return lookup(intern(key), key.data(), key.length());
+}
+
+
+void Headers::add(header_id_t id, uint32_t key, uint32_t keyLength,
+                  uint32_t value, uint32_t valueLength) {
+  uint32_t hash = id ? 0 : ihash(data(key), keyLength);
+  entries.push_back({id, hash, key, keyLength, value, valueLength});
+  if (id) index[id] = entries.size() - 1;
+}
+
+
+void Headers::merge(vector<Merge> &merges) {
+  if (merges.empty()) return;
+
+  // Group the lines by header, keeping their order
+  stable_sort(merges.begin(), merges.end(),
+              [] (const Merge &a, const Merge &b) {return a.entry < b.entry;});
+
+  // Reserve first so the sources in the text buffer do not move while copying
+  size_t size = text.size();
+  for (unsigned i = 0; i < merges.size(); i++) {
+    if (!i || merges[i - 1].entry != merges[i].entry)
+      size += entries[merges[i].entry].valueLength;
+    size += 2 + merges[i].valueLength;
+  }
+  text.reserve(size);
+
+  for (unsigned i = 0; i < merges.size();) {
+    auto &e = entries[merges[i].entry];
+
+    bool empty = true;
+    for (unsigned j = 0; j < e.valueLength && empty; j++)
+      empty = isSpace(data(e.value)[j]);
+
+    uint32_t value = text.size();
+    text.append(data(e.value), e.valueLength);
+
+    // See RFC 2616 Section 4.2 "Message Headers"
+    for (int entry = merges[i].entry;
+         i < merges.size() && merges[i].entry == entry; i++) {
+      auto &m = merges[i];
+      if (!empty && m.valueLength) text.append(m.continuation ? " " : ", ");
+      text.append(data(m.value), m.valueLength);
+      empty = empty && !m.valueLength;
+    }
+
+    e.value = value;
+    e.valueLength = text.size() - value;
+  }
+}
+
+
+void Headers::reindex() {
+  for (unsigned i = 0; i < HEADER_COUNT; i++) index[i] = -1;
+
+  for (unsigned i = 0; i < entries.size(); i++)
+    if (entries[i].id) index[entries[i].id] = i;
+}
+
+
+void Headers::parseLine(uint32_t start, uint32_t end, int &last,
+                        vector<Merge> &merges) {
+  const char *line = data(start);
+  uint32_t length = end - start;
+  bool continuation = line[0] == ' ' || line[0] == '\t';
+
+  uint32_t keyLength = 0;
+  if (!continuation) {
+    auto colon = (const char *)memchr(line, ':', length);
+    if (!colon) THROW("Invalid header line: " << string(line, length));
+    keyLength = colon - line;
+  }
+
+  // Trim the value
+  uint32_t value = start + keyLength + (continuation ? 0 : 1);
+  uint32_t valueEnd = end;
+  while (value < valueEnd && isSpace(text[value])) value++;
+  while (value < valueEnd && isSpace(text[valueEnd - 1])) valueEnd--;
+  uint32_t valueLength = valueEnd - value;
+
+  if (continuation) {
+    if (last < 0) THROW("Invalid header line: " << string(line, length));
+    return merges.push_back({last, value, valueLength, true});
+  }
+
+  // Set-Cookie values may contain commas so they cannot be merged, see
+  // RFC 6265 Section 3
+  header_id_t id = intern(line, keyLength);
+  last = id == HEADER_SET_COOKIE ? -1 : lookup(id, line, keyLength);
+
+  if (0 <= last) merges.push_back({last, value, valueLength, false});
+  else {
+    if (maxHeaders <= entries.size()) THROW("Too many headers");
+    add(id, start, keyLength, value, valueLength);
+    last = entries.size() - 1;
+  }
 }
@@ -30,37 +30,116 @@
 
 \******************************************************************************/
 
+
 #pragma once
 
 #include <cbang/String.h>
-#include <cbang/util/StringICmp.h>
-#include <cbang/util/OrderedDict.h>
+#include <cbang/util/Arena.h>
 
 #include <ostream>
+#include <vector>
+#include <cstdint>
 
 
 namespace cb {
   namespace Event {class Buffer;}
 
   namespace HTTP {
-    using HeadersImpl = OrderedDict<std::string, std::string, StringILess>;
-    class Headers : protected HeadersImpl {
+    /**
+     * Header names and values are stored as views into one text buffer.
+     * Parsing copies the header block into the buffer once and common names
+     * are interned so looking them up does not compare strings.  Given an
+     * Arena, the buffer and entry table are allocated from it.
+     */
+    class Headers {
+    public:
+      enum header_id_t {
+        HEADER_UNKNOWN,
+#define CBANG_HTTP_HEADER(ID, NAME) HEADER_##ID,
+#include "HeaderNames.def"
+        HEADER_COUNT
+      };
+
+    protected:
+      struct Entry {
+        header_id_t id;
+        uint32_t hash;
+        uint32_t key;
+        uint32_t keyLength;
+        uint32_t value;
+        uint32_t valueLength;
+      };
+
+      std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>
+      text;
+      std::vector<Entry, ArenaAllocator<Entry>> entries;
+
+      // A repeated or continued header line waiting to be merged
+      struct Merge {
+        int entry;
+        uint32_t value;
+        uint32_t valueLength;
+        bool continuation;
+      };
+      int index[HEADER_COUNT];
+
     public:
-      using HeadersImpl::begin;
-      using HeadersImpl::end;
-      using HeadersImpl::insert;
+      class Iterator {
+        const Headers *headers;
+        unsigned i;
+
+      public:
+        Iterator(const Headers *headers, unsigned i) :
+          headers(headers), i(i) {}
+
+        const Entry &entry() const {return headers->entries[i];}
+
+        header_id_t id() const {return entry().id;}
+        const char *keyData() const {return headers->data(entry().key);}
+        unsigned keyLength() const {return entry().keyLength;}
+        const char *valueData() const {return headers->data(entry().value);}
+        unsigned valueLength() const {return entry().valueLength;}
+        std::string key() const {return std::string(keyData(), keyLength());}
+        std::string value() const
+          {return std::string(valueData(), valueLength());}
+
+        const Iterator &operator*() const {return *this;}
+        Iterator &operator++() {i++; return *this;}
+        bool operator==(const Iterator &o) const {return i == o.i;}
+        bool operator!=(const Iterator &o) const {return i != o.i;}
+      };
+
+      typedef Iterator iterator;
+      typedef Iterator const_iterator;
+
+      Headers(const SmartPointer<Arena> &arena = 0);
+
+      SmartPointer<Arena> getArena() const
+        {return entries.get_allocator().arena;}
+
+      bool empty() const {return entries.empty();}
+      unsigned size() const {return entries.size();}
+      void clear();
+
+      Iterator begin() const {return Iterator(this, 0);}
+      Iterator end() const {return Iterator(this, entries.size());}
+      Iterator insert(const std::string &key, const std::string &value,
+                      bool prepend = false);
 
       bool has(const std::string &key) const;
+      bool has(header_id_t id) const {return 0 <= index[id];}
       std::string find(const std::string &key) const;
-      const std::string &get(const std::string &key) const;
-      const std::string &get(
+      std::string find(header_id_t id) const;
+      std::string get(const std::string &key) const;
+      std::string get(
         const std::string &key, const std::string &defaultValue) const;
       void set(const std::string &key, const std::string &value)
         {insert(key, value);}
       void remove(const std::string &key);
       bool keyContains(const std::string &key, const std::string &value) const;
+      bool keyContains(header_id_t id, const char *value) const;
 
-      bool hasContentType() const {return !getContentType().empty();}
+      bool hasContentType() const;
       std::string getContentType() const;
       bool isJSONContentType() const;
       void setContentType(const std::string &contentType);
@@ -70,6 +149,22 @@ namespace cb {
 
       bool parse(Event::Buffer &buf, unsigned maxSize = 0);
       void write(std::ostream &stream) const;
+
+      static header_id_t intern(const char *name, unsigned length);
+      static header_id_t intern(const std::string &name)
+        {return intern(name.data(), name.length());}
+      static const char *getName(header_id_t id);
+
+    protected:
+      const char *data(uint32_t offset) const {return text.data() + offset;}
+      int lookup(header_id_t id, const char *key, unsigned length) const;
+      int lookup(const std::string &key) const;
+      void add(header_id_t id, uint32_t key, uint32_t keyLength,
+               uint32_t value, uint32_t valueLength);
+      void merge(std::vector<Merge> &merges);
+      void reindex();
+      void parseLine(uint32_t start, uint32_t end, int &last,
+                     std::vector<Merge> &merges);
     };
 
 
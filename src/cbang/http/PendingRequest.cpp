@@ -53,4 +53,4 @@ PendingRequest::PendingRequest(
 }
 
 
-void PendingRequest::send() {client.send(request);}
+void PendingRequest::send() {connection = client.send(request);}
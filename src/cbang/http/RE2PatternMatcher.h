@@ -51,6 +51,7 @@ namespace cb {
       RE2PatternMatcher(const std::string &pattern,
                         const SmartPointer<RequestHandler> &child);
 
+      const Regex &getRegex() const {return re;}
       const SmartPointer<RequestHandler> &getChild() const {return child;}
 
       bool match(const URI &uri, JSON::ValuePtr args) const;
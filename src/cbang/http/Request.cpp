@@ -34,6 +34,9 @@
 #include "Conn.h"
 #include "Cookie.h"
 #include "Server.h"
+#include "ConnIn.h"
+#include "ContentEncoder.h"
+#include "HeaderWriter.h"
 
 #include <cbang/Exception.h>
 #include <cbang/Catch.h>
@@ -44,6 +47,7 @@
 #include <cbang/openssl/SSL.h>
 #include <cbang/log/Logger.h>
 #include <cbang/json/JSON.h>
+#include <cbang/json/BufferReader.h>
 #include <cbang/time/Time.h>
 #include <cbang/util/Regex.h>
 #include <cbang/comp/CompressionFilter.h>
@@ -72,7 +76,7 @@ namespace {
 
 
 Request::Request(const RequestParams &params) :
-  inputHeaders(params.hdrs), connection(params.connection),
+  arena(params.arena), inputHeaders(params.hdrs), connection(params.connection),
   method(params.method), uri(params.uri), version(params.version),
   args(new JSON::Dict) {}
 
@@ -85,14 +89,20 @@ uint64_t Request::getID() const {
 }
 
 
+const SmartPointer<Arena> &Request::getArena() {
+  if (arena.isNull()) arena = Arena::create();
+  return arena;
+}
+
+
 Headers &Request::getInputHeaders() {
-  if (inputHeaders.isNull()) inputHeaders = new Headers;
+  if (inputHeaders.isNull()) inputHeaders = new Headers(getArena());
   return *inputHeaders;
 }
 
 
 Headers &Request::getOutputHeaders() {
-  if (outputHeaders.isNull()) outputHeaders = new Headers;
+  if (outputHeaders.isNull()) outputHeaders = new Headers(getArena());
   return *outputHeaders;
 }
 
@@ -408,6 +418,23 @@ Compression Request::getRequestedCompression() const {
 }
 
 
+Compression Request::negotiateCompression(uint64_t length) {
+  auto conn = dynamic_cast<ConnIn *>(connection.get());
+  if (!conn || !hasContentType()) return COMPRESSION_NONE;
+
+  auto &server = conn->getServer();
+  if (!server.getCompressMinSize() || length < server.getCompressMinSize() ||
+      !server.isCompressible(getContentType())) return COMPRESSION_NONE;
+
+  // The response now depends on Accept-Encoding
+  outSet("Vary", "Accept-Encoding");
+
+  Compression compression = getRequestedCompression();
+  return ContentEncoder::isSupported(compression) ?
+    compression : Compression(COMPRESSION_NONE);
+}
+
+
 bool Request::hasCookie(const string &name) const {
   if (!inHas("Cookie")) return false;
 
@@ -460,9 +487,18 @@ string Request::getOutput() const {return outputBuffer.toString();}
 
 
 SmartPointer<JSON::Value> Request::getInputJSON() const {
+  if (!inputBuffer.getLength()) return 0;
+
+  JSON::Builder builder;
+  getInputJSON(builder);
+  return builder.getRoot();
+}
+
+
+void Request::getInputJSON(JSON::Sink &sink) const {
   Event::Buffer buf = inputBuffer;
-  if (!buf.getLength()) return 0;
-  Event::BufferStream<> stream(buf);
+  unsigned length = buf.getLength();
+  if (!length) return;
 
   // A request body which will not parse is the client's mistake, so report it
   // as one.  Without a status the parse error escapes as a plain exception and
@@ -473,7 +509,7 @@ SmartPointer<JSON::Value> Request::getInputJSON() const {
   // malformed body is worth acting on depends on who sends it: a peer server
   // posting a report is a different matter from an unknown client.
   try {
-    return JSON::Reader(stream).parse();
+    JSON::BufferReader(buf.pullup(), length).parse(sink);
   } catch (const Exception &e) {
     THROWCX("Malformed JSON request body for " << getMethod() << ' '
             << getURI().getPath(), e, HTTP_BAD_REQUEST);
@@ -575,17 +611,14 @@ void Request::sendError(const exception &e) {
 void Request::send(function<void (JSON::Sink &sink)> cb) {
   outputBuffer.clear();
 
-  Event::Buffer buffer;
-  Event::BufferStream<> stream(buffer);
-  JSON::Writer writer(stream, 0, true);
+  string output;
+  JSON::StringWriter writer(output, 0, true);
 
   cb(writer);
-
   writer.close();
-  stream.flush();
 
   setContentType("application/json");
-  send(buffer);
+  outputBuffer.addRef(std::move(output));
 }
 
 
@@ -650,25 +683,52 @@ void Request::startChunked(Status code) {
 
   outSet("Transfer-Encoding", "chunked");
   chunked = true;
+
+  // Stream compression, flushed at the end of each chunk
+  Compression compression = COMPRESSION_NONE;
+  if (autoCompress && !outHas("Content-Encoding"))
+    compression = negotiateCompression(~(uint64_t)0);
+
+  if (compression) {
+    encoder = ContentEncoder::create(compression);
+    outSetContentEncoding(compression);
+  }
+
   reply(code);
 }
 
 
 void Request::sendChunk(function<void (JSON::Sink &sink)> cb) {
-  Event::Buffer buffer;
-  Event::BufferStream<> stream(buffer);
-  JSON::Writer writer(stream, 0, true);
+  string output;
+  JSON::StringWriter writer(output, 0, true);
 
   cb(writer);
-
   writer.close();
-  stream.flush();
 
+  Event::Buffer buffer;
+  buffer.addRef(std::move(output));
   sendChunk(buffer);
 }
 
 
 void Request::sendChunk(const Event::Buffer &buf) {
+  if (encoder.isNull()) return writeChunk(buf);
+
+  Event::Buffer in(buf);
+  Event::Buffer out;
+
+  if (in.getLength()) encoder->encode(in, out, true);
+  else {
+    encoder->finish(out);
+    encoder.release();
+  }
+
+  if (out.getLength()) writeChunk(out);
+  if (encoder.isNull()) writeChunk(in); // Final empty chunk
+}
+
+
+void Request::writeChunk(const Event::Buffer &buf) {
   if (!chunked) THROW("Not chunked");
 
   LOG_DEBUG(4, "Sending " << buf.getLength() << " byte chunk");
@@ -741,6 +801,10 @@ bool Request::needsClose() const {
 
 
 Version Request::parseHTTPVersion(const string &s) {
+  // The common cases, without tokenizing
+  if (s == "HTTP/1.1") return Version(1, 1);
+  if (s == "HTTP/1.0") return Version(1, 0);
+
   if (!String::startsWith(s, "HTTP/"))
     THROW("Expected 'HTTP/' got '" << s << "'");
   return Version(s.substr(5));
@@ -780,12 +844,37 @@ void Request::write(write_cb_t cb) {
 }
 
 
-void Request::writeResponse(Event::Buffer &buf) {
-  buf.add(getResponseLine() + "\r\n");
+void Request::compressResponse() {
+  if (!autoCompress || !mustHaveBody() || outHas("Content-Encoding") ||
+      outHas("Content-Range") || outHas("Content-Length") ||
+      outHas("Transfer-Encoding")) return;
+
+  if (!hasContentType()) guessContentType();
+
+  Compression compression = negotiateCompression(outputBuffer.getLength());
+  if (!compression) return;
+
+  Event::Buffer out;
+  auto encoder = ContentEncoder::create(compression);
+  encoder->encode(outputBuffer, out);
+  encoder->finish(out);
+  outputBuffer.add(out);
+
+  outSetContentEncoding(compression);
+}
+
+
+void Request::writeResponse(HeaderWriter &writer) {
+  auto &line = HeaderWriter::getStatusLine(version, responseCode);
+  if (line.empty() || !responseCodeLine.empty())
+    writer.add(getResponseLine() + "\r\n");
+  else writer.add(line);
+
+  compressResponse();
 
   if (version.getMajor() == 1) {
     if (1 <= version.getMinor() && !outHas("Date"))
-      outSet("Date", Time().toString("%a, %d %b %Y %H:%M:%S GMT"));
+      writer.addHeader("Date", HeaderWriter::getDate());
 
     // If the protocol is 1.0 and connection was keep-alive add keep-alive
     bool keepAlive =
@@ -808,15 +897,21 @@ void Request::writeResponse(Event::Buffer &buf) {
   if (inputHeaders.isSet() && inputHeaders->needsClose())
     outSet("Connection", "close");
 
+  // Server wide headers
+  auto conn = dynamic_cast<ConnIn *>(connection.get());
+  if (conn)
+    for (auto &header: conn->getServer().getStaticHeaders())
+      if (!outHas(header.name)) writer.add(header.line);
+
   LOG_INFO(300 <= responseCode ? 1 : 4, "> " << getResponseLine());
   LOG_DEBUG(5, getOutputHeaders() << '\n');
   LOG_DEBUG(6, outputBuffer.hexdump() << '\n');
 }
 
 
-void Request::writeRequest(Event::Buffer &buf) {
+void Request::writeRequest(HeaderWriter &writer) {
   // Generate request line
-  buf.add(getRequestLine() + "\r\n");
+  writer.add(getRequestLine() + "\r\n");
 
   if (method == HTTP_CONNECT) {
     if (!outHas("Host"))
@@ -839,14 +934,16 @@ void Request::writeRequest(Event::Buffer &buf) {
 
 
 void Request::writeHeaders(Event::Buffer &buf) {
-  if (connection->isIncoming()) writeResponse(buf);
-  else writeRequest(buf);
+  HeaderWriter writer(buf);
+
+  if (connection->isIncoming()) writeResponse(writer);
+  else writeRequest(writer);
 
   if (outputHeaders.isSet())
-    for (auto it: *outputHeaders)
-      if (!it.value().empty())
-        buf.add(String::printf(
-          "%s: %s\r\n", it.key().c_str(), it.value().c_str()));
+    for (auto &it: *outputHeaders)
+      if (it.valueLength())
+        writer.addHeader(it.keyData(), it.keyLength(), it.valueData(),
+                         it.valueLength());
 
-  buf.add("\r\n");
+  writer.add("\r\n", 2);
 }
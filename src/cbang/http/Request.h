@@ -56,7 +56,12 @@ namespace cb {
   class AddressRangeSet;
 
   namespace HTTP {
+    class ContentEncoder;
+    class HeaderWriter;
+
     class Request : virtual public RefCounted, public Enum {
+      SmartPointer<Arena> arena;
+
       using HeadersPtr = SmartPointer<Headers>;
       HeadersPtr inputHeaders;
       HeadersPtr outputHeaders;
@@ -78,6 +83,9 @@ namespace cb {
 
       bool chunked  = false;
       bool replying = false;
+      bool autoCompress = true;
+
+      SmartPointer<ContentEncoder> encoder; // For chunked replies
 
       uint64_t bytesRead    = 0;
       uint64_t bytesWritten = 0;
@@ -100,6 +108,11 @@ namespace cb {
 
       uint64_t getID() const;
 
+      /// Memory which lives exactly as long as the request.  Containers and
+      /// shared objects created per request may allocate from it with an
+      /// ArenaAllocator.
+      const SmartPointer<Arena> &getArena();
+
       void setInputHeaders (const HeadersPtr &hdrs) {inputHeaders  = hdrs;}
       void setOutputHeaders(const HeadersPtr &hdrs) {outputHeaders = hdrs;}
       const Headers &getInputHeaders() const {return *inputHeaders;}
@@ -197,6 +210,14 @@ namespace cb {
 
       void outSetContentEncoding(Compression compression);
       Compression getRequestedCompression() const;
+      /***
+       * Select a Content-Encoding for a response body of @param length
+       * bytes with the current Content-Type.  Sets ``Vary`` if the
+       * result depends on Accept-Encoding.
+       */
+      Compression negotiateCompression(uint64_t length);
+      bool getAutoCompression() const {return autoCompress;}
+      void setAutoCompression(bool x) {autoCompress = x;}
 
       bool hasCookie(const std::string &name) const;
       std::string findCookie(const std::string &name) const;
@@ -212,6 +233,7 @@ namespace cb {
       std::string getOutput() const;
 
       SmartPointer<JSON::Value> getInputJSON() const;
+      void getInputJSON(JSON::Sink &sink) const;
       void setJSONMessage(const SmartPointer<JSON::Value> &msg)
         {this->msg = msg;}
       const SmartPointer<JSON::Value> &getJSONMessage();
@@ -273,8 +295,10 @@ namespace cb {
       void write(write_cb_t cb = 0); // Called by ConnOut
 
     protected:
-      void writeResponse(Event::Buffer &buf);
-      void writeRequest(Event::Buffer &buf);
+      void compressResponse();
+      void writeResponse(HeaderWriter &writer);
+      void writeChunk(const Event::Buffer &buf);
+      void writeRequest(HeaderWriter &writer);
       void writeHeaders(Event::Buffer &buf);
     };
 
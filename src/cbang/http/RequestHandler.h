@@ -56,6 +56,10 @@ namespace cb {
 
       // Synchronous handler.  Return true if the request was handled.
       virtual bool operator()(Request &req) {return false;};
+
+      // False if the handler uses state owned by the main event loop and so
+      // cannot be called from server threads.
+      virtual bool isThreadSafe() const {return true;}
     };
 
 
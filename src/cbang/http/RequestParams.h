@@ -48,6 +48,7 @@ namespace cb {
       URI uri;
       Version version = Version(1, 1);
       SmartPointer<Headers> hdrs = 0;
+      SmartPointer<Arena> arena = 0;
     };
   }
 }
@@ -32,9 +32,13 @@
 
 #include "ResourceHandler.h"
 #include "Request.h"
+#include "ContentEncoder.h"
 
 #include <cbang/String.h>
+#include <cbang/event/Buffer.h>
+#include <cbang/os/SystemUtilities.h>
 #include <cbang/util/ResourceManager.h>
+#include <cbang/thread/SmartLock.h>
 
 using namespace std;
 using namespace cb;
@@ -53,7 +57,38 @@ bool ResourceHandler::operator()(Request &req) {
 
   if (!res || res->isDirectory()) return false;
 
-  req.reply(HTTP_OK, res->getData(), res->getLength());
+  if (!req.hasContentType())
+    req.getOutputHeaders().guessContentType(
+      SystemUtilities::extension(res->getName()));
+
+  Compression encoding = req.negotiateCompression(res->getLength());
+  req.setAutoCompression(false);
+
+  if (!encoding) {
+    req.reply(HTTP_OK, res->getData(), res->getLength());
+    return true;
+  }
+
+  auto key = key_t(res, encoding);
+  const string *data;
+
+  {
+    SmartLock lock(&encodedLock); // Shared by server threads
+    auto it = encoded.find(key);
+
+    if (it == encoded.end()) {
+      Event::Buffer buf;
+      auto encoder = ContentEncoder::create(encoding);
+      encoder->encode(res->getData(), res->getLength(), buf, false);
+      encoder->finish(buf);
+      it = encoded.insert(make_pair(key, buf.toString())).first;
+    }
+
+    data = &it->second;
+  }
+
+  req.outSetContentEncoding(encoding);
+  req.reply(HTTP_OK, data->data(), data->length());
 
   return true;
 }
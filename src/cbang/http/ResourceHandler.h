@@ -35,6 +35,10 @@
 #include "RequestHandler.h"
 
 #include <cbang/util/Resource.h>
+#include <cbang/thread/Mutex.h>
+
+#include <map>
+#include <string>
 
 
 namespace cb {
@@ -44,6 +48,12 @@ namespace cb {
     class ResourceHandler : public RequestHandler {
       const Resource &root;
 
+      // Compressed resource data, made once on first use.  Entries are never
+      // removed so they may be read after unlocking.
+      typedef std::pair<const Resource *, unsigned> key_t;
+      std::map<key_t, std::string> encoded;
+      Mutex encodedLock;
+
     public:
       ResourceHandler(const Resource &root) : root(root) {}
       ResourceHandler(const std::string &path);
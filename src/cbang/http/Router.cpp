@@ -0,0 +1,321 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2021-2026, Cauldron Development  Oy
+                Copyright (c) 2003-2021, Cauldron Development LLC
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include "Router.h"
+#include "RE2PatternMatcher.h"
+#include "MethodMatcher.h"
+
+#include <cbang/Exception.h>
+#include <cbang/log/Logger.h>
+#include <cbang/util/Regex.h>
+
+#include <re2/re2.h>
+#include <re2/set.h>
+
+#include <map>
+#include <memory>
+#include <algorithm>
+#include <cstring>
+#include <cctype>
+
+using namespace std;
+using namespace cb;
+using namespace cb::HTTP;
+
+
+struct Router::Node {
+  map<string, SmartPointer<Node>> children;
+  unsigned methods = 0;
+  vector<unsigned> routes;
+  SmartPointer<RE2::Set> set;
+
+
+  void match(const vector<Entry> &entries, Method method, const string &path,
+             vector<int> &tmp, vector<unsigned> &results) const {
+    if (!(methods & method) || set.isNull()) return;
+
+    tmp.clear();
+    if (!set->Match(path, &tmp)) return;
+
+    for (int i: tmp)
+      if (entries[routes[i]].methods & method) results.push_back(routes[i]);
+  }
+};
+
+
+struct Router::Dispatch {
+  SmartPointer<Router> router;
+  RequestCont next;
+
+  Method method;
+  string path;
+  vector<unsigned> routes;
+  unsigned pos = 0;
+  int last = -1;
+
+  Dispatch(const SmartPointer<Router> &router, const RequestCont &next) :
+    router(router), next(next) {}
+
+
+  static void step(const shared_ptr<Dispatch> &d, Request &req) {
+    // A handler may rewrite the request before passing it on, in which case
+    // the remaining routes must be matched again.
+    const string &path = req.getURI().getPath();
+
+    if (d->last < 0 || req.getMethod() != d->method || path != d->path) {
+      d->method = req.getMethod();
+      d->path   = path;
+      d->router->match(d->method, d->path, d->routes);
+
+      auto it = d->routes.begin();
+      if (0 <= d->last)
+        it = upper_bound(it, d->routes.end(), (unsigned)d->last);
+      d->pos = it - d->routes.begin();
+    }
+
+    if (d->routes.size() <= d->pos) return d->next(req);
+
+    unsigned index = d->routes[d->pos++];
+    d->last = index;
+    d->router->call(index, req, [d] (Request &req) {step(d, req);});
+  }
+};
+
+
+Router::Router(const vector<Route> &routes) : root(new Node) {
+  for (unsigned i = 0; i < routes.size(); i++) add(i, routes[i]);
+
+  // Compile the pattern sets
+  vector<Node *> stack = {root.get()};
+
+  while (!stack.empty()) {
+    Node *node = stack.back();
+    stack.pop_back();
+
+    for (auto &p: node->children) stack.push_back(p.second.get());
+    if (node->set.isNull()) continue;
+
+    if (!node->set->Compile()) {
+      LOG_WARNING("Failed to compile route set, falling back to linear");
+      always.insert(always.end(), node->routes.begin(), node->routes.end());
+      node->set.release();
+
+      for (auto i: node->routes) {
+        entries[i].handler = routes[i].handler;
+        entries[i].matcher.release();
+      }
+    }
+  }
+
+  sort(always.begin(), always.end());
+}
+
+
+Router::~Router() {}
+
+
+void Router::match(Method method, const string &path,
+                   vector<unsigned> &results) const {
+  results.clear();
+
+  for (auto i: always)
+    if (entries[i].methods & method) results.push_back(i);
+
+  auto it = exact.find(path);
+  if (it != exact.end())
+    for (auto i: it->second)
+      if (entries[i].methods & method) results.push_back(i);
+
+  // Walk the trie one path segment at a time
+  vector<int> tmp;
+  string segment;
+  const Node *node = root.get();
+  size_t pos = 0;
+
+  while (true) {
+    node->match(entries, method, path, tmp, results);
+
+    size_t end = path.find('/', pos);
+    if (end == string::npos) break;
+
+    segment.assign(path, pos, end - pos);
+    auto it = node->children.find(segment);
+    if (it == node->children.end()) break;
+
+    node = it->second.get();
+    pos = end + 1;
+  }
+
+  sort(results.begin(), results.end());
+}
+
+
+string Router::literalPrefix(const string &pattern, bool &exact) {
+  exact = false;
+
+  // Alternation at the top level means any prefix may be skipped
+  int depth = 0;
+  bool inClass = false;
+  for (unsigned i = 0; i < pattern.size(); i++)
+    switch (pattern[i]) {
+    case '\\': i++; break;
+    case '[': inClass = true; break;
+    case ']': inClass = false; break;
+    case '(': if (!inClass) depth++; break;
+    case ')': if (!inClass) depth--; break;
+    case '|': if (!inClass && !depth) return ""; break;
+    }
+
+  string prefix;
+  unsigned i = 0;
+  if (!pattern.empty() && pattern[0] == '^') i++;
+
+  while (i < pattern.size()) {
+    char c = pattern[i];
+    unsigned len = 1;
+
+    if (c == '\\') {
+      // Escaped punctuation is literal, anything else is a character class
+      if (i + 1 == pattern.size() || !ispunct(pattern[i + 1])) break;
+      c = pattern[i + 1];
+      len = 2;
+
+    } else if (c == '$' && i + 1 == pattern.size()) {
+      i++;
+      break;
+
+    } else if (strchr(".[](){}*+?^$|", c)) break;
+
+    // A quantifier makes the preceding character optional
+    if (i + len < pattern.size() && strchr("*+?{", pattern[i + len])) break;
+
+    prefix += c;
+    i += len;
+  }
+
+  exact = i == pattern.size();
+
+  return prefix;
+}
+
+
+void Router::operator()(Request &req, const RequestCont &next) {
+  ArenaAllocator<Dispatch> alloc(req.getArena());
+  Dispatch::step(allocate_shared<Dispatch>(alloc, SmartPtr(this), next), req);
+}
+
+
+void Router::add(unsigned index, const Route &route) {
+  Entry entry;
+  entry.methods = route.methods;
+
+  bool standard = isStandard(route);
+  entry.handler = standard ? route.child : route.handler;
+  entries.push_back(entry);
+
+  if (!standard) {
+    // Unknown matcher, it must see every request
+    entries.back().methods = Method::HTTP_ANY;
+    always.push_back(index);
+    return;
+  }
+
+  if (route.pattern.empty()) return always.push_back(index);
+
+  // Only patterns with named groups need to be matched again for URL args
+  auto handler = route.handler;
+  if (route.methods != (unsigned)Method::HTTP_ANY)
+    handler = handler.cast<MethodMatcher>()->getChild();
+
+  auto matcher = handler.cast<RE2PatternMatcher>();
+  if (!matcher->getRegex().getGroupIndexMap().empty())
+    entries.back().matcher = matcher;
+
+  bool isExact;
+  string prefix = literalPrefix(route.pattern, isExact);
+  if (isExact) return exact[prefix].push_back(index);
+
+  // File pattern under its complete literal segments
+  Node *node = root.get();
+  size_t pos = 0;
+  size_t end;
+
+  while ((end = prefix.find('/', pos)) != string::npos) {
+    auto &child = node->children[prefix.substr(pos, end - pos)];
+    if (child.isNull()) child = new Node;
+    node = child.get();
+    pos = end + 1;
+  }
+
+  if (node->set.isNull()) {
+    RE2::Options opts;
+    opts.set_log_errors(false);
+    node->set = new RE2::Set(opts, RE2::ANCHOR_BOTH);
+  }
+
+  string error;
+  if (node->set->Add(route.pattern, &error) != (int)node->routes.size())
+    THROW("Failed to add route pattern '" << route.pattern << "': " << error);
+
+  node->routes.push_back(index);
+  node->methods |= route.methods;
+}
+
+
+void Router::call(unsigned index, Request &req, const RequestCont &next) {
+  auto &entry = entries[index];
+
+  if (entry.matcher.isSet() &&
+      !entry.matcher->match(req.getURI(), req.getArgs())) return next(req);
+
+  (*entry.handler)(req, next);
+}
+
+
+bool Router::isStandard(const Route &route) {
+  // Check that the handler is what the default createMatcher() makes
+  RequestHandlerPtr handler = route.handler;
+
+  if (route.methods != (unsigned)Method::HTTP_ANY) {
+    auto m = dynamic_cast<MethodMatcher *>(handler.get());
+    if (!m) return false;
+    handler = m->getChild();
+  }
+
+  if (!route.pattern.empty()) {
+    auto m = dynamic_cast<RE2PatternMatcher *>(handler.get());
+    if (!m || m->getRegex().toString() != route.pattern) return false;
+    handler = m->getChild();
+  }
+
+  return handler == route.child;
+}
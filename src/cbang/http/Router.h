@@ -0,0 +1,110 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2021-2026, Cauldron Development  Oy
+                Copyright (c) 2003-2021, Cauldron Development LLC
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#pragma once
+
+#include "RequestHandler.h"
+
+#include <cbang/SmartPointer.h>
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+
+namespace cb {
+  namespace HTTP {
+    class RE2PatternMatcher;
+
+    /// A route table compiled from the handlers of a HandlerGroup.
+    ///
+    /// Fully literal patterns are looked up in a hash table.  The remaining
+    /// patterns are filed in a trie under the literal path segments they
+    /// start with and each trie node matches all of its patterns in a single
+    /// pass with an RE2::Set.  Method masks are checked before any pattern.
+    /// Only the routes which match are called, in the order they were added,
+    /// so the outcome is the same as trying every handler in turn.
+    class Router : public RequestHandler, public RefCounted {
+    public:
+      struct Route {
+        unsigned methods;
+        std::string pattern;
+        RequestHandlerPtr handler; // As returned by createMatcher()
+        RequestHandlerPtr child;   // As passed to addHandler()
+
+        Route(const RequestHandlerPtr &handler) :
+          Route(Method::HTTP_ANY, "", handler, handler) {}
+        Route(unsigned methods, const std::string &pattern,
+              const RequestHandlerPtr &handler,
+              const RequestHandlerPtr &child) :
+          methods(methods), pattern(pattern), handler(handler), child(child) {}
+      };
+
+    protected:
+      struct Entry {
+        unsigned methods;
+        RequestHandlerPtr handler;
+        SmartPointer<RE2PatternMatcher> matcher; // Sets URL args if not null
+      };
+
+      struct Node;
+      struct Dispatch;
+
+      std::vector<Entry> entries;
+      std::vector<unsigned> always;
+      std::unordered_map<std::string, std::vector<unsigned>> exact;
+      SmartPointer<Node> root;
+
+    public:
+      Router(const std::vector<Route> &routes);
+      ~Router();
+
+      unsigned getNumRoutes() const {return entries.size();}
+
+      /// Find the indices of all routes matching @param method and @param
+      /// path, in the order they were added.
+      void match(Method method, const std::string &path,
+                 std::vector<unsigned> &results) const;
+
+      static std::string literalPrefix(const std::string &pattern,
+                                       bool &exact);
+
+      // From RequestHandler
+      void operator()(Request &req, const RequestCont &next) override;
+
+    protected:
+      void add(unsigned index, const Route &route);
+      void call(unsigned index, Request &req, const RequestCont &next);
+      static bool isStandard(const Route &route);
+    };
+  }
+}
@@ -37,6 +37,7 @@
 
 #include <cbang/config.h>
 #include <cbang/Catch.h>
+#include <cbang/String.h>
 #include <cbang/log/Logger.h>
 #include <cbang/config/Options.h>
 #include <cbang/os/SystemUtilities.h>
@@ -50,7 +51,9 @@ using namespace cb::HTTP;
 
 
 Server::Server(Event::Base &base, const SmartPointer<SSLContext> &sslCtx) :
-  Event::Server(base), sslCtx(sslCtx) {}
+  Event::Server(base), sslCtx(sslCtx),
+  compressTypes({"text/*", "application/json", "application/javascript",
+      "application/xml", "image/svg+xml"}) {}
 
 
 void Server::addListenPort(const SockAddr &addr) {
@@ -81,6 +84,20 @@ void Server::addOptions(Options &options) {
                     "Maximum size of an HTTP request body.");
   options.addTarget("http-max-headers-size", maxHeaderSize,
                     "Maximum size of the HTTP request headers.");
+  options.addTarget("http-max-pipelined", maxPipelined,
+                    "Maximum number of pipelined requests outstanding on a "
+                    "connection, counting the one currently being answered.  "
+                    "Zero or one disables read ahead.");
+  options.addTarget("http-compress-min-size", compressMinSize,
+                    "Compress responses of at least this many bytes when the "
+                    "client accepts it.  Zero disables automatic "
+                    "compression.");
+
+  opt = options.add("http-compress-types", "A space separated list of "
+                    "content types to compress automatically.  A trailing "
+                    "'/*' matches any subtype.");
+  opt->setType(Option::TYPE_STRINGS);
+  opt->setDefault(String::join(compressTypes, " "));
 
   opt = options.add("http-trusted-proxies", "A space separated list of "
                     "trusted reverse-proxy addresses or CIDR ranges.  When a "
@@ -123,6 +140,8 @@ void Server::init(Options &options) {
   auto addresses = options["http-addresses"].toStrings();
   for (auto &addr: addresses) addListenPort(SockAddr::parse(addr));
 
+  compressTypes = options["http-compress-types"].toStrings();
+
   // Trusted reverse proxies
   trustedProxies.clear();
   for (auto &p: options["http-trusted-proxies"].toStrings())
@@ -156,16 +175,56 @@ void Server::init(Options &options) {
 }
 
 
-SmartPointer<Event::Connection> Server::createConnection() {
-  auto conn = SmartPtr(new ConnIn(*this));
+bool Server::isCompressible(const string &contentType) const {
+  string type = String::toLower(
+    String::trim(contentType.substr(0, contentType.find(';'))));
+
+  for (auto &pattern: compressTypes)
+    if (pattern == type || (String::endsWith(pattern, "/*") &&
+                            String::startsWith(type, pattern.substr(
+                                                 0, pattern.length() - 1))))
+      return true;
+
+  return false;
+}
+
+
+void Server::addStaticHeader(const string &name, const string &value) {
+  removeStaticHeader(name);
+  staticHeaders.push_back({name, name + ": " + value + "\r\n"});
+}
+
+
+void Server::removeStaticHeader(const string &name) {
+  for (auto it = staticHeaders.begin(); it != staticHeaders.end(); it++)
+    if (String::toLower(it->name) == String::toLower(name)) {
+      staticHeaders.erase(it);
+      break;
+    }
+}
+
+
+SmartPointer<Event::Connection>
+Server::createConnection(Event::Base &base) {
+  auto conn = SmartPtr(new ConnIn(*this, base));
   conn->setMaxHeaderSize(maxHeaderSize);
   conn->setMaxBodySize(maxBodySize);
+  conn->setMaxPipelined(maxPipelined);
   return conn;
 }
 
 
+void Server::startThreads() {
+  if (!isThreadSafe())
+    THROW("A request handler must run on the main event loop, cannot use "
+          "server threads");
+
+  Event::Server::startThreads();
+}
+
+
 SmartPointer<Request> Server::createRequest(const RequestParams &params) {
-  return new Request(params);
+  return makeShared<Request>(params);
 }
 
 
@@ -180,6 +239,13 @@ void Server::dispatch(Request &req) {
 }
 
 
+void Server::checkHandler(const RequestHandler &handler) {
+  if (!getWorkers().empty() && !handler.isThreadSafe())
+    THROW("Request handler must run on the main event loop, cannot add it "
+          "while using server threads");
+}
+
+
 bool Server::operator()(Request &req) {
   if (logPrefix) {
     string prefix = String::printf("REQ%" PRIu64 ":", req.getID());
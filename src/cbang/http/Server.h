@@ -47,6 +47,13 @@ namespace cb {
     class Conn;
 
     class Server : public Event::Server, public HandlerGroup {
+    public:
+      struct StaticHeader {
+        std::string name;
+        std::string line;
+      };
+
+    private:
       SmartPointer<SSLContext> sslCtx;
 
       bool logPrefix = false;
@@ -55,8 +62,13 @@ namespace cb {
 
       unsigned maxBodySize   = std::numeric_limits<int>::max();
       unsigned maxHeaderSize = std::numeric_limits<int>::max();
+      unsigned maxPipelined  = 8;
+
+      unsigned compressMinSize = 1024;
+      std::vector<std::string> compressTypes;
 
       AddressRangeSet trustedProxies;
+      std::vector<StaticHeader> staticHeaders;
 
     public:
       Server(Event::Base &base, const SmartPointer<SSLContext> &sslCtx = 0);
@@ -80,13 +92,33 @@ namespace cb {
       unsigned getMaxHeaderSize() const {return maxHeaderSize;}
       void setMaxHeaderSize(unsigned size) {maxHeaderSize = size;}
 
+      unsigned getMaxPipelined() const {return maxPipelined;}
+      void setMaxPipelined(unsigned x) {maxPipelined = x;}
+
+      unsigned getCompressMinSize() const {return compressMinSize;}
+      void setCompressMinSize(unsigned x) {compressMinSize = x;}
+
+      const std::vector<std::string> &getCompressTypes() const
+        {return compressTypes;}
+      void setCompressTypes(const std::vector<std::string> &types)
+        {compressTypes = types;}
+      bool isCompressible(const std::string &contentType) const;
+
+      /// Headers serialized once and sent with every response which does not
+      /// set them itself
+      const std::vector<StaticHeader> &getStaticHeaders() const
+        {return staticHeaders;}
+      void addStaticHeader(const std::string &name, const std::string &value);
+      void removeStaticHeader(const std::string &name);
+
       void addListenPort(const SockAddr &addr);
       void addSecureListenPort(const SockAddr &addr);
 
       // From Event::Server
       void addOptions(Options &options) override;
       void init(Options &options) override;
-      SmartPointer<Event::Connection> createConnection() override;
+      SmartPointer<Event::Connection>
+      createConnection(Event::Base &base) override;
 
       virtual SmartPointer<Request> createRequest(const RequestParams &params);
       virtual void endRequest(Request &req);
@@ -95,6 +127,13 @@ namespace cb {
 
       // From RequestHandler
       bool operator()(Request &req) override;
+
+    protected:
+      // From Event::Server
+      void startThreads() override;
+
+      // From HandlerGroup
+      void checkHandler(const RequestHandler &handler) override;
     };
   }
 }
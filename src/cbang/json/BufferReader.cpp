@@ -0,0 +1,634 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2021-2026, Cauldron Development  Oy
+                Copyright (c) 2003-2021, Cauldron Development LLC
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include "BufferReader.h"
+#include "Builder.h"
+
+#include <cbang/String.h>
+#include <cbang/util/Resource.h>
+#include <cbang/os/SystemUtilities.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cerrno>
+#include <cstdlib>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CBANG_JSON_SSE2
+
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define CBANG_JSON_NEON
+#endif
+
+using namespace std;
+using namespace cb;
+using namespace cb::JSON;
+
+
+namespace {
+  inline bool isDigit(char c) {return '0' <= c && c <= '9';}
+
+
+  inline bool isStringSpecial(unsigned char c) {
+    return c == '"' || c == '\\' || c < 0x20 || 0x80 <= c;
+  }
+
+
+  // Find the first byte in a string body which needs more than a copy: a
+  // quote, an escape, a control character or the start of a UTF-8 sequence.
+  // The vector loops only find the block, the scalar loop finds the byte.
+  const char *scanString(const char *p, const char *end) {
+#if defined(CBANG_JSON_SSE2)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i slash = _mm_set1_epi8('\\');
+    const __m128i space = _mm_set1_epi8(0x20);
+
+    for (; p + 16 <= end; p += 16) {
+      __m128i v = _mm_loadu_si128((const __m128i *)p);
+
+      // A signed compare catches control characters and bytes >= 0x80
+      __m128i x = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, slash)),
+        _mm_cmplt_epi8(v, space));
+
+      if (_mm_movemask_epi8(x)) break;
+    }
+
+#elif defined(CBANG_JSON_NEON)
+    for (; p + 16 <= end; p += 16) {
+      uint8x16_t v = vld1q_u8((const uint8_t *)p);
+
+      uint8x16_t x = vorrq_u8(
+        vorrq_u8(vceqq_u8(v, vdupq_n_u8('"')), vceqq_u8(v, vdupq_n_u8('\\'))),
+        vorrq_u8(vcltq_u8(v, vdupq_n_u8(0x20)), vcgeq_u8(v, vdupq_n_u8(0x80))));
+
+      if (vmaxvq_u8(x)) break;
+    }
+#endif
+
+    while (p < end && !isStringSpecial(*p)) p++;
+    return p;
+  }
+
+
+  inline bool isStructural(char c) {
+    return c == '"' || c == '#' || (c | 0x20) == '{' || (c | 0x20) == '}';
+  }
+
+
+  // Find the next byte which matters when skipping a list or dict: a quote,
+  // a comment or a bracket.  Setting bit 5 maps '[' and ']' to '{' and '}'.
+  const char *scanStructural(const char *p, const char *end) {
+#if defined(CBANG_JSON_SSE2)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i hash  = _mm_set1_epi8('#');
+    const __m128i open  = _mm_set1_epi8('{');
+    const __m128i close = _mm_set1_epi8('}');
+    const __m128i bit5  = _mm_set1_epi8(0x20);
+
+    for (; p + 16 <= end; p += 16) {
+      __m128i v = _mm_loadu_si128((const __m128i *)p);
+      __m128i b = _mm_or_si128(v, bit5);
+
+      __m128i x = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, hash)),
+        _mm_or_si128(_mm_cmpeq_epi8(b, open), _mm_cmpeq_epi8(b, close)));
+
+      if (_mm_movemask_epi8(x)) break;
+    }
+
+#elif defined(CBANG_JSON_NEON)
+    for (; p + 16 <= end; p += 16) {
+      uint8x16_t v = vld1q_u8((const uint8_t *)p);
+      uint8x16_t b = vorrq_u8(v, vdupq_n_u8(0x20));
+
+      uint8x16_t x = vorrq_u8(
+        vorrq_u8(vceqq_u8(v, vdupq_n_u8('"')), vceqq_u8(v, vdupq_n_u8('#'))),
+        vorrq_u8(vceqq_u8(b, vdupq_n_u8('{')), vceqq_u8(b, vdupq_n_u8('}'))));
+
+      if (vmaxvq_u8(x)) break;
+    }
+#endif
+
+    while (p < end && !isStructural(*p)) p++;
+    return p;
+  }
+
+
+  bool parseDouble(const char *first, const char *last, double &v) {
+#ifdef __cpp_lib_to_chars
+    auto r = from_chars(first, last, v);
+    return r.ec == errc() && r.ptr == last;
+
+#else
+    string s(first, last);
+    char *end;
+    errno = 0;
+    v = strtod(s.c_str(), &end);
+    return !errno && end == s.c_str() + s.length();
+#endif
+  }
+}
+
+
+BufferReader::BufferReader(const Resource &resource, bool strict) :
+  BufferReader(resource.getData(), resource.getLength(), strict,
+               resource.getName()) {}
+
+
+void BufferReader::parse(Sink &sink, unsigned depth) {
+  if (1000 < ++depth) error("Maximum JSON parse depth reached");
+
+  switch (next()) {
+  case 'N': case 'n':
+    parseNull();
+    return sink.writeNull();
+
+  case 'T': case 'F': case 't': case 'f':
+    return sink.writeBoolean(parseBoolean());
+
+  case '-': case '.':
+  case '0': case '1': case '2': case '3': case '4':
+  case '5': case '6': case '7': case '8': case '9':
+    return parseNumber(sink);
+
+  case '"': return sink.write(parseString());
+
+  case '[':
+    sink.beginList();
+    parseList(sink, depth);
+    return sink.endList();
+
+  case '{':
+    sink.beginDict();
+    parseDict(sink, depth);
+    return sink.endDict();
+
+  default: match("NnTtFf-.0123456789\"[{");
+  }
+}
+
+
+ValuePtr BufferReader::parse() {
+  Builder builder;
+  parse(builder);
+  return builder.getRoot();
+}
+
+
+ValuePtr BufferReader::parse(const char *data, size_t length, bool strict) {
+  return BufferReader(data, length, strict).parse();
+}
+
+
+ValuePtr BufferReader::parse(const string &data, bool strict) {
+  return BufferReader(data, strict).parse();
+}
+
+
+void BufferReader::parse(const string &data, Sink &sink, bool strict) {
+  BufferReader(data, strict).parse(sink);
+}
+
+
+ValuePtr BufferReader::parseFile(const string &path, bool strict) {
+  string data = SystemUtilities::read(path);
+  return BufferReader(data.data(), data.size(), strict, path).parse();
+}
+
+
+unsigned BufferReader::getLine() const {return count(start, ptr, '\n');}
+
+
+unsigned BufferReader::getColumn() const {
+  unsigned column = 0;
+
+  for (const char *p = ptr; start < p && p[-1] != '\n'; p--)
+    if (p[-1] != '\r') column++;
+
+  return column;
+}
+
+
+char BufferReader::get() {
+  if (ptr == end) error("Unexpected end of expression");
+  return *ptr++;
+}
+
+
+char BufferReader::next() {
+  while (ptr < end)
+    switch (*ptr) {
+    case '\n': case '\r': case '\t': case ' ': ptr++; break;
+
+    case '#':
+      while (ptr < end && *ptr != '\n') ptr++;
+      break;
+
+    default: return *ptr;
+    }
+
+  error("Unexpected end of expression");
+  throw "Unreachable";
+}
+
+
+bool BufferReader::tryMatch(char c) {
+  if (c == next()) {
+    ptr++;
+    return true;
+  }
+
+  return false;
+}
+
+
+char BufferReader::match(const char *chars) {
+  char x = next();
+
+  for (int i = 0; chars[i]; i++)
+    if (x == chars[i]) {
+      ptr++;
+      return x;
+    }
+
+  error(SSTR("Expected one of '" << cb::String::escapeC(chars)
+             << "' but found '" << cb::String::escapeC(string(1, x)) << '\''));
+  throw "Unreachable";
+}
+
+
+const string BufferReader::parseKeyword() {
+  const char *first = ptr;
+  while (ptr < end && isalpha(*ptr)) ptr++;
+  return string(first, ptr);
+}
+
+
+void BufferReader::parseNull() {
+  if (strict) {
+    string value = parseKeyword();
+    if (value != "null") error(SSTR("'null' but found '" << value << '\''));
+
+  } else {
+    string value = cb::String::toLower(parseKeyword());
+
+    if (value != "none" && value != "null")
+      error(SSTR("Expected keyword 'None' or 'null' but found '" << value
+                 << '\''));
+  }
+}
+
+
+bool BufferReader::parseBoolean() {
+  string value = parseKeyword();
+  if (!strict) value = cb::String::toLower(value);
+
+  if (value == "true") return true;
+  else if (value == "false") return false;
+
+  error(SSTR("Expected keyword 'true' or 'false' but found '" << value << "'"));
+  throw "Unreachable";
+}
+
+
+void BufferReader::parseNumber(Sink &sink) {
+  const char *first = ptr;
+  bool negative = false;
+  bool decimal = false;
+
+  if (peek() == '-') {
+    ptr++;
+    negative = true;
+  }
+
+  if (peek() == '0') ptr++;
+  else {
+    if (strict && !isDigit(peek())) error("Missing digit at start of number");
+    while (isDigit(peek())) ptr++;
+  }
+
+  if (peek() == '.') {
+    decimal = true;
+    ptr++;
+    if (strict && !isDigit(peek())) error("Missing digit after decimal point");
+    while (isDigit(peek())) ptr++;
+  }
+
+  if (peek() == 'e' || peek() == 'E') {
+    decimal = true;
+    ptr++;
+    if (peek() == '+' || peek() == '-') ptr++;
+    if (strict && !isDigit(peek())) error("Missing digit in exponent");
+    while (isDigit(peek())) ptr++;
+  }
+
+  // Integers which overflow are read as doubles
+  if (!decimal && negative) {
+    int64_t v;
+    auto r = from_chars(first, ptr, v);
+    if (r.ec == errc() && r.ptr == ptr) return sink.write(v);
+
+  } else if (!decimal) {
+    uint64_t v;
+    auto r = from_chars(first, ptr, v);
+    if (r.ec == errc() && r.ptr == ptr) return sink.write(v);
+  }
+
+  double v;
+  if (!parseDouble(first, ptr, v))
+    error(SSTR("Invalid JSON number '" << string(first, ptr) << "'"));
+  sink.write(v);
+}
+
+
+string BufferReader::parseString() {
+  match("\"");
+
+  string s;
+
+  while (true) {
+    const char *run = ptr;
+    ptr = scanString(ptr, end);
+    s.append(run, ptr - run);
+
+    if (ptr == end) error("Unclosed string in JSON");
+
+    unsigned char c = *ptr++;
+
+    if (c == '"') return s;
+    else if (c == '\\') parseEscape(s);
+    else if (c == '\n') error("Unescaped new line in JSON string");
+    else if (c <= 0x1f) error("Control characters not allowed in JSON strings");
+    else parseUTF8(s, c);
+  }
+}
+
+
+void BufferReader::parseEscape(string &s) {
+  unsigned char c = get();
+
+  switch (c) {
+  case '"': case '\\': case '/': s += c; break;
+  case 'b': s += '\b'; break;
+  case 'f': s += '\f'; break;
+  case 'n': s += '\n'; break;
+  case 'r': s += '\r'; break;
+  case 't': s += '\t'; break;
+
+  case 'x': {
+    if (strict) error("Hex escape sequence not allowed in JSON");
+
+    uint16_t code = 0;
+    for (unsigned i = 0; i < 2; i++) {
+      code <<= 4;
+      c = get();
+      if ('0' <= c && c <= '9') code += c - '0';
+      else if ('a' <= c && c <= 'f') code += c - 'a' + 10;
+      else if ('A' <= c && c <= 'F') code += c - 'A' + 10;
+      else error(SSTR("Invalid hex character '" << String::escapeC(c)
+                      << "' in JSON string"));
+    }
+
+    s += code;
+    break;
+  }
+
+  case 'u': {
+    auto readHex4 = [&] () {
+      uint32_t code = 0;
+
+      for (unsigned i = 0; i < 4; i++) {
+        code <<= 4;
+        char h = get();
+
+        if      ('0' <= h && h <= '9') code += h - '0';
+        else if ('a' <= h && h <= 'f') code += h - 'a' + 10;
+        else if ('A' <= h && h <= 'F') code += h - 'A' + 10;
+        else error("Invalid unicode escape sequence in JSON");
+      }
+
+      return code;
+    };
+
+    uint32_t code = readHex4();
+
+    // Combine UTF-16 surrogate pairs, see Reader::parseString()
+    if (0xd800 <= code && code <= 0xdbff) {
+      if (get() != '\\' || get() != 'u')
+        error("Expected low surrogate in JSON unicode escape");
+
+      uint32_t low = readHex4();
+      if (low < 0xdc00 || 0xdfff < low)
+        error("Invalid low surrogate in JSON unicode escape");
+
+      code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+
+    } else if (0xdc00 <= code && code <= 0xdfff)
+      error("Unexpected low surrogate in JSON unicode escape");
+
+    if (code < 0x80) s += (char)code;
+    else if (code < 0x800) {
+      s += (char)(0xc0 | (code >> 6));
+      s += (char)(0x80 | (code & 0x3f));
+
+    } else if (code < 0x10000) {
+      s += (char)(0xe0 | (code >> 12));
+      s += (char)(0x80 | ((code >> 6) & 0x3f));
+      s += (char)(0x80 | (code & 0x3f));
+
+    } else {
+      s += (char)(0xf0 | (code >> 18));
+      s += (char)(0x80 | ((code >> 12) & 0x3f));
+      s += (char)(0x80 | ((code >> 6) & 0x3f));
+      s += (char)(0x80 | (code & 0x3f));
+    }
+
+    break;
+  }
+
+  default:
+    if ('0' <= c && c <= '7') {
+      if (strict) error("Hex escape sequence not allowed in JSON");
+
+      uint16_t code = 0;
+      for (unsigned i = 0; i < 3; i++) {
+        code <<= 3;
+        if (i) c = get();
+        if ('0' <= c && c <= '7') code += c - '0';
+        else error(SSTR("Invalid octal character '" << String::escapeC(c)
+                        << "' in JSON string"));
+      }
+
+      if (0377 < code) error("Invalid octal code in JSON string");
+      s += code;
+
+    } else error(SSTR("Invalid string escape character '"
+                      << String::escapeC(c) << "' in JSON"));
+  }
+}
+
+
+void BufferReader::parseUTF8(string &s, unsigned char c) {
+  // Malformed sequences are replaced unless strict, see Reader::parseString()
+  string bad;
+
+  // Compute code width and the bits the lead byte contributes
+  unsigned width = 0;
+  uint32_t code = 0;
+  if      ((c & 0xe0) == 0xc0) {width = 1; code = c & 0x1f;}
+  else if ((c & 0xf0) == 0xe0) {width = 2; code = c & 0x0f;}
+  else if ((c & 0xf8) == 0xf0) {width = 3; code = c & 0x07;}
+  else bad = SSTR("Invalid UTF-8 byte '"
+                  << String::printf("0x%02x", (unsigned)c)
+                  << "' in JSON string");
+
+  // A byte which does not continue the sequence is left for the caller
+  const char *first = ptr - 1;
+  for (unsigned i = 0; bad.empty() && i < width; i++) {
+    if ((peek() & 0xc0) != 0x80)
+      bad = "Incomplete UTF-8 sequence in JSON string";
+    else code = (code << 6) | (*ptr++ & 0x3f);
+  }
+
+  // Overlong encodings, UTF-16 surrogates and code points beyond U+10FFFF
+  // are all invalid UTF-8 (RFC 3629)
+  static const uint32_t minCode[] = {0x80, 0x800, 0x10000};
+  if (bad.empty() && code < minCode[width - 1])
+    bad = "Overlong UTF-8 encoding in JSON string";
+  if (bad.empty() && 0xd800 <= code && code <= 0xdfff)
+    bad = "UTF-8 encoded surrogate in JSON string";
+  if (bad.empty() && 0x10ffff < code)
+    bad = "UTF-8 code point beyond U+10FFFF in JSON string";
+
+  if (bad.empty()) s.append(first, ptr);
+  else if (strict) error(bad);
+  else s += "\xef\xbf\xbd"; // U+FFFD REPLACEMENT CHARACTER
+}
+
+
+void BufferReader::parseList(Sink &sink, unsigned depth) {
+  match("[");
+
+  bool comma = false;
+
+  while (true) {
+    if (tryMatch(']')) {
+      // Empty list or trailing comma
+      if (strict && comma) error("Trailing comma not allowed in JSON list");
+      return;
+    }
+
+    sink.beginAppend();
+    if (sink.wantsValue()) parse(sink, depth);
+    else skip();
+
+    if (match(",]") == ']') return; // Continuation or end
+    comma = true;
+  }
+}
+
+
+void BufferReader::parseDict(Sink &sink, unsigned depth) {
+  match("{");
+
+  bool comma = false;
+
+  while (true) {
+    if (tryMatch('}')) {
+      // Empty dict or trailing comma
+      if (strict && comma) error("Trailing comma not allowed in JSON dict");
+      return;
+    }
+
+    string key = parseString();
+    match(":");
+    sink.beginInsert(key);
+    if (sink.wantsValue()) parse(sink, depth);
+    else skip();
+
+    if (match(",}") == '}') return; // Continuation or end
+    comma = true;
+  }
+}
+
+
+void BufferReader::skip() {
+  // Only checks that strings end and that brackets balance
+  char c = next();
+
+  if (c == '"') {
+    ptr++;
+    return skipString();
+  }
+
+  if (c != '[' && c != '{') {
+    const char *first = ptr;
+    while (ptr < end && (isalnum((unsigned char)*ptr) || *ptr == '-' ||
+                         *ptr == '+' || *ptr == '.')) ptr++;
+    if (ptr == first) match("NnTtFf-.0123456789\"[{");
+    return;
+  }
+
+  unsigned depth = 0;
+
+  while (true) {
+    ptr = scanStructural(ptr, end);
+    if (ptr == end) error("Unexpected end of expression");
+
+    switch (*ptr++) {
+    case '"': skipString(); break;
+    case '#': while (ptr < end && *ptr != '\n') ptr++; break;
+    case '[': case '{': depth++; break;
+    default: if (!--depth) return; // Closing bracket
+    }
+  }
+}
+
+
+void BufferReader::skipString() {
+  while (true) {
+    ptr = scanString(ptr, end);
+    if (ptr == end) error("Unclosed string in JSON");
+
+    char c = *ptr++;
+    if (c == '"') return;
+    if (c == '\\' && ptr < end) ptr++;
+  }
+}
+
+
+void BufferReader::error(const string &msg) const {
+  throw ParseError(msg, FileLocation(name, getLine(), getColumn()));
+}
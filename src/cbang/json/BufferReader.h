@@ -0,0 +1,106 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2021-2026, Cauldron Development  Oy
+                Copyright (c) 2003-2021, Cauldron Development LLC
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#pragma once
+
+#include "Value.h"
+
+#include <string>
+
+
+namespace cb {
+  class Resource;
+
+  namespace JSON {
+    class Sink;
+
+    /// Parses JSON held in one contiguous block into any Sink.  It accepts
+    /// the same input as Reader but works on the buffer directly, so it
+    /// avoids per character stream calls.  Line and column are only computed
+    /// when an error is reported.  Values which the Sink does not want are
+    /// skipped without being decoded.  The data must stay valid while it is
+    /// parsed.
+    class BufferReader {
+      std::string name;
+      const char *start;
+      const char *ptr;
+      const char *end;
+      bool strict;
+
+    public:
+      BufferReader(const char *data, size_t length, bool strict = false,
+                   const std::string &name = "<memory>") :
+        name(name), start(data), ptr(data), end(data + length),
+        strict(strict) {}
+      BufferReader(const std::string &data, bool strict = false) :
+        BufferReader(data.data(), data.size(), strict) {}
+      BufferReader(const Resource &resource, bool strict = false);
+
+      bool getStrict() const {return strict;}
+      void setStrict(bool strict) {this->strict = strict;}
+
+      void parse(Sink &sink, unsigned depth = 0);
+      ValuePtr parse();
+      static ValuePtr parse(const char *data, size_t length,
+                            bool strict = false);
+      static ValuePtr parse(const std::string &data, bool strict = false);
+      static void parse(const std::string &data, Sink &sink,
+                        bool strict = false);
+      static ValuePtr parseFile(const std::string &path, bool strict = false);
+
+      unsigned getOffset() const {return ptr - start;}
+      unsigned getLine() const;
+      unsigned getColumn() const;
+
+    protected:
+      char peek() const {return ptr < end ? *ptr : 0;}
+      char get();
+      char next();
+      bool tryMatch(char c);
+      char match(const char *chars);
+
+      const std::string parseKeyword();
+      void parseNull();
+      bool parseBoolean();
+      void parseNumber(Sink &sink);
+      std::string parseString();
+      void parseEscape(std::string &s);
+      void parseUTF8(std::string &s, unsigned char c);
+      void parseList(Sink &sink, unsigned depth);
+      void parseDict(Sink &sink, unsigned depth);
+      void skip();
+      void skipString();
+
+      void error(const std::string &msg) const;
+    };
+  }
+}
@@ -32,34 +32,25 @@
 
 #pragma once
 
-#include "Writer.h"
+#include "StringWriter.h"
 
-#include <cbang/io/VectorStream.h>
-
-#include <vector>
+#include <string>
 
 namespace cb {
   namespace JSON {
-    class BufferWriter : public Writer {
-      std::vector<char> buffer;
-      VectorStream<char> stream;
+    class BufferWriter : public StringWriter {
+      std::string buffer;
 
     public:
       BufferWriter(unsigned indentStart = 0, bool compact = false,
                    unsigned indentSpace = 2, int precision = 6) :
-        Writer(stream, indentStart, compact, indentSpace, precision),
-        stream(buffer) {}
+        StringWriter(buffer, indentStart, compact, indentSpace, precision) {}
 
-#ifdef _WIN32
-      const char *data() const {return &buffer[0];}
-#else
       const char *data() const {return buffer.data();}
-#endif
-
       size_t const size() const {return buffer.size();}
-      std::string toString() const {return std::string(data(), size());}
+      std::string toString() const {return buffer;}
 
-      void flush() {stream.flush();}
+      void flush() {}
 
       template <typename T, typename M>
       std::string toString(T obj, M member) {
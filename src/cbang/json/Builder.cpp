@@ -108,8 +108,11 @@ void Builder::beginInsert(const string &key) {
 
 void Builder::endDict() {
   assertNotPending();
-  if (inDict()) stack.pop_back();
-  else TYPE_ERROR("Not a Dict");
+  if (!inDict()) TYPE_ERROR("Not a Dict");
+
+  // The Dict is complete, release unused space
+  if (stack.back().isInstance<Dict>()) stack.back().cast<Dict>()->shrink();
+  stack.pop_back();
 }
 
 
@@ -0,0 +1,225 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2021-2026, Cauldron Development  Oy
+                Copyright (c) 2003-2021, Cauldron Development LLC
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include "CBORReader.h"
+#include "Builder.h"
+
+#include <cbang/String.h>
+#include <cbang/net/Swab.h>
+
+#include <cmath>
+#include <cstring>
+
+using namespace std;
+using namespace cb;
+using namespace cb::JSON;
+
+
+void CBORReader::parse(Sink &sink, unsigned depth) {
+  if (1000 < ++depth) error("Maximum CBOR parse depth reached");
+
+  uint8_t initial = next();
+  uint8_t major   = initial >> 5;
+  uint8_t info    = initial & 0x1f;
+
+  switch (major) {
+  case 0: return sink.write(readArg(info));
+
+  case 1: {
+    uint64_t arg = readArg(info);
+    if (arg >> 63) return sink.write(-1 - (double)arg);
+    return sink.write((int64_t)~arg);
+  }
+
+  case 2: case 3: return sink.write(readString(major, info));
+
+  case 4:
+    sink.beginList();
+
+    if (info == 31)
+      while (!tryBreak()) {
+        sink.beginAppend();
+        parse(sink, depth);
+      }
+
+    else
+      for (uint64_t n = readArg(info); n; n--) {
+        sink.beginAppend();
+        parse(sink, depth);
+      }
+
+    return sink.endList();
+
+  case 5: {
+    sink.beginDict();
+
+    uint64_t n = info == 31 ? 0 : readArg(info);
+    while (info == 31 ? !tryBreak() : n--) {
+      uint8_t key = next();
+      if (key >> 5 != 3) error("CBOR map key is not a string");
+      sink.beginInsert(readString(3, key & 0x1f));
+      parse(sink, depth);
+    }
+
+    return sink.endDict();
+  }
+
+  case 6: // Tags are ignored
+    readArg(info);
+    return parse(sink, depth);
+
+  default:
+    switch (info) {
+    case 20: return sink.writeBoolean(false);
+    case 21: return sink.writeBoolean(true);
+    case 22: case 23: return sink.writeNull();
+    case 25: case 26: case 27: return sink.write(readFloat(info));
+    default: error("Unsupported CBOR simple value " + String((int)info));
+    }
+  }
+}
+
+
+ValuePtr CBORReader::parse() {
+  Builder builder;
+  parse(builder);
+  return builder.getRoot();
+}
+
+
+ValuePtr CBORReader::parse(const string &data) {
+  return CBORReader(data).parse();
+}
+
+
+void CBORReader::parse(const string &data, Sink &sink) {
+  CBORReader(data).parse(sink);
+}
+
+
+uint8_t CBORReader::next() {return *consume(1);}
+
+
+bool CBORReader::tryBreak() {
+  if (ptr < end && *ptr == 0xff) {
+    ptr++;
+    return true;
+  }
+
+  return false;
+}
+
+
+const uint8_t *CBORReader::consume(uint64_t length) {
+  if ((uint64_t)(end - ptr) < length) error("Truncated CBOR data");
+  const uint8_t *p = ptr;
+  ptr += length;
+  return p;
+}
+
+
+uint64_t CBORReader::readArg(uint8_t info) {
+  if (info < 24) return info;
+
+  switch (info) {
+  case 24: return next();
+  case 25: {
+    uint16_t x;
+    memcpy(&x, consume(2), 2);
+    return hton16(x);
+  }
+  case 26: {
+    uint32_t x;
+    memcpy(&x, consume(4), 4);
+    return hton32(x);
+  }
+  case 27: {
+    uint64_t x;
+    memcpy(&x, consume(8), 8);
+    return hton64(x);
+  }
+  }
+
+  error("Invalid CBOR argument " + String((int)info));
+  return 0;
+}
+
+
+string CBORReader::readString(uint8_t major, uint8_t info) {
+  if (info != 31) {
+    uint64_t length = readArg(info);
+    return string((const char *)consume(length), length);
+  }
+
+  // Indefinite length strings are a sequence of definite length chunks
+  string s;
+  while (!tryBreak()) {
+    uint8_t chunk = next();
+    if (chunk >> 5 != major || (chunk & 0x1f) == 31)
+      error("Invalid CBOR string chunk");
+    s += readString(major, chunk & 0x1f);
+  }
+
+  return s;
+}
+
+
+double CBORReader::readFloat(uint8_t info) {
+  uint64_t bits = readArg(info);
+
+  if (info == 25) {
+    // IEEE 754 half precision
+    int exp  = (bits >> 10) & 0x1f;
+    int mant = bits & 0x3ff;
+    double value;
+
+    if (!exp) value = ldexp(mant, -24);
+    else if (exp != 31) value = ldexp(mant + 1024, exp - 25);
+    else value = mant ? NAN : INFINITY;
+
+    return (bits & 0x8000) ? -value : value;
+  }
+
+  if (info == 26) {
+    uint32_t x = bits;
+    float f;
+    memcpy(&f, &x, 4);
+    return f;
+  }
+
+  double d;
+  memcpy(&d, &bits, 8);
+  return d;
+}
+
+
+void CBORReader::error(const string &msg) const {PARSE_ERROR(msg);}
@@ -0,0 +1,74 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2021-2026, Cauldron Development  Oy
+                Copyright (c) 2003-2021, Cauldron Development LLC
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#pragma once
+
+#include "Value.h"
+
+#include <string>
+
+
+namespace cb {
+  namespace JSON {
+    class Sink;
+
+    /// Decodes CBOR (RFC 8949) into any Sink.  Tags are skipped, byte strings
+    /// are written as strings and map keys must be strings.  The data must
+    /// stay valid while it is parsed.
+    class CBORReader {
+      const uint8_t *ptr;
+      const uint8_t *end;
+
+    public:
+      CBORReader(const char *data, size_t length) :
+        ptr((const uint8_t *)data), end(ptr + length) {}
+      CBORReader(const std::string &data) :
+        CBORReader(data.data(), data.size()) {}
+
+      bool isDone() const {return ptr == end;}
+
+      void parse(Sink &sink, unsigned depth = 0);
+      ValuePtr parse();
+      static ValuePtr parse(const std::string &data);
+      static void parse(const std::string &data, Sink &sink);
+
+    protected:
+      uint8_t next();
+      bool tryBreak();
+      const uint8_t *consume(uint64_t length);
+      uint64_t readArg(uint8_t info);
+      std::string readString(uint8_t major, uint8_t info);
+      double readFloat(uint8_t info);
+      void error(const std::string &msg) const;
+    };
+  }
+}
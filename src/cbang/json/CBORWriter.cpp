@@ -0,0 +1,155 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2021-2026, Cauldron Development  Oy
+                Copyright (c) 2003-2021, Cauldron Development LLC
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include "CBORWriter.h"
+
+#include <cbang/net/Swab.h>
+
+#include <cstring>
+
+using namespace std;
+using namespace cb::JSON;
+
+
+void CBORWriter::writeNull() {
+  NullSink::writeNull();
+  output.push_back((char)0xf6);
+}
+
+
+void CBORWriter::writeBoolean(bool value) {
+  NullSink::writeBoolean(value);
+  output.push_back((char)(value ? 0xf5 : 0xf4));
+}
+
+
+void CBORWriter::write(double value) {
+  NullSink::write(value);
+
+  float f = value;
+  if ((double)f == value || value != value) {
+    uint32_t bits;
+    memcpy(&bits, &f, 4);
+    bits = hton32(bits);
+    output.push_back((char)0xfa);
+    output.append((char *)&bits, 4);
+
+  } else {
+    uint64_t bits;
+    memcpy(&bits, &value, 8);
+    bits = hton64(bits);
+    output.push_back((char)0xfb);
+    output.append((char *)&bits, 8);
+  }
+}
+
+
+void CBORWriter::write(uint64_t value) {
+  assertCanWrite();
+  writeHead(0, value);
+}
+
+
+void CBORWriter::write(int64_t value) {
+  assertCanWrite();
+  if (value < 0) writeHead(1, ~(uint64_t)value);
+  else writeHead(0, value);
+}
+
+
+void CBORWriter::write(const string &value) {
+  NullSink::write(value);
+  writeText(value);
+}
+
+
+void CBORWriter::beginList(bool simple) {
+  NullSink::beginList(simple);
+  output.push_back((char)0x9f);
+}
+
+
+void CBORWriter::endList() {
+  NullSink::endList();
+  output.push_back((char)0xff);
+}
+
+
+void CBORWriter::beginDict(bool simple) {
+  NullSink::beginDict(simple);
+  output.push_back((char)0xbf);
+}
+
+
+void CBORWriter::beginInsert(const string &key) {
+  NullSink::beginInsert(key);
+  writeText(key);
+}
+
+
+void CBORWriter::endDict() {
+  NullSink::endDict();
+  output.push_back((char)0xff);
+}
+
+
+void CBORWriter::writeHead(uint8_t major, uint64_t arg) {
+  major <<= 5;
+
+  if (arg < 24) output.push_back((char)(major | arg));
+
+  else if (arg <= 0xff) {
+    output.push_back((char)(major | 24));
+    output.push_back((char)arg);
+
+  } else if (arg <= 0xffff) {
+    uint16_t x = hton16((uint16_t)arg);
+    output.push_back((char)(major | 25));
+    output.append((char *)&x, 2);
+
+  } else if (arg <= 0xffffffff) {
+    uint32_t x = hton32((uint32_t)arg);
+    output.push_back((char)(major | 26));
+    output.append((char *)&x, 4);
+
+  } else {
+    uint64_t x = hton64(arg);
+    output.push_back((char)(major | 27));
+    output.append((char *)&x, 8);
+  }
+}
+
+
+void CBORWriter::writeText(const string &s) {
+  writeHead(3, s.size());
+  output.append(s);
+}
@@ -0,0 +1,81 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2021-2026, Cauldron Development  Oy
+                Copyright (c) 2003-2021, Cauldron Development LLC
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#pragma once
+
+#include "NullSink.h"
+
+#include <string>
+
+
+namespace cb {
+  namespace JSON {
+    /// Encodes JSON as CBOR (RFC 8949) appended to a string.  Lists and dicts
+    /// are written with indefinite lengths so values stream without knowing
+    /// their sizes in advance.  Doubles which are exact as single precision
+    /// are stored in four bytes.
+    class CBORWriter : public NullSink {
+      std::string &output;
+
+    public:
+      CBORWriter(std::string &output, bool allowDuplicates = false) :
+        NullSink(allowDuplicates), output(output) {}
+
+      // From Sink
+      void writeNull() override;
+      void writeBoolean(bool value) override;
+      void write(double value) override;
+      void write(uint64_t value) override;
+      void write(int64_t value) override;
+      void write(const std::string &value) override;
+      using Sink::write;
+      void beginList(bool simple = false) override;
+      void endList() override;
+      void beginDict(bool simple = false) override;
+      void beginInsert(const std::string &key) override;
+      void endDict() override;
+
+      template <typename T>
+      static std::string encode(const T &o) {
+        std::string output;
+        CBORWriter writer(output);
+        o.write(writer);
+        writer.close();
+        return output;
+      }
+
+    protected:
+      void writeHead(uint8_t major, uint64_t arg);
+      void writeText(const std::string &s);
+    };
+  }
+}
@@ -35,57 +35,151 @@
 
 #include <cbang/Exception.h>
 #include <cbang/String.h>
+#include <cbang/util/Random.h>
 
-#include <cctype>
+#include <cstring>
 
 using namespace std;
+using namespace cb;
 using namespace cb::JSON;
 
 
+namespace {
+  inline uint64_t rotl(uint64_t x, int b) {return (x << b) | (x >> (64 - b));}
+
+
+  // SipHash-1-3 with a random per process key, so that keys which collide
+  // cannot be chosen to degrade the index
+  uint64_t keyHash(const string &key) {
+    static const uint64_t k0 = Random::instance().rand<uint64_t>();
+    static const uint64_t k1 = Random::instance().rand<uint64_t>();
+
+    uint64_t v0 = k0 ^ 0x736f6d6570736575ULL;
+    uint64_t v1 = k1 ^ 0x646f72616e646f6dULL;
+    uint64_t v2 = k0 ^ 0x6c7967656e657261ULL;
+    uint64_t v3 = k1 ^ 0x7465646279746573ULL;
+
+    auto round = [&] {
+      v0 += v1; v1 = rotl(v1, 13); v1 ^= v0; v0 = rotl(v0, 32);
+      v2 += v3; v3 = rotl(v3, 16); v3 ^= v2;
+      v0 += v3; v3 = rotl(v3, 21); v3 ^= v0;
+      v2 += v1; v1 = rotl(v1, 17); v1 ^= v2; v2 = rotl(v2, 32);
+    };
+
+    const char *data = key.data();
+    size_t length = key.size();
+    size_t end = length & ~(size_t)7;
+
+    for (size_t i = 0; i < end; i += 8) {
+      uint64_t m;
+      memcpy(&m, data + i, 8);
+      v3 ^= m;
+      round();
+      v0 ^= m;
+    }
+
+    uint64_t m = (uint64_t)length << 56;
+    for (size_t i = end; i < length; i++)
+      m |= (uint64_t)(uint8_t)data[i] << (8 * (i - end));
+
+    v3 ^= m;
+    round();
+    v0 ^= m;
+
+    v2 ^= 0xff;
+    round();
+    round();
+    round();
+
+    return v0 ^ v1 ^ v2 ^ v3;
+  }
+}
+
+
 ValuePtr Dict::copy(bool deep) const {
   ValuePtr c = createDict();
 
-  for (auto e: entries())
-    c->insert(e.key(), deep ? e.value()->copy(true) : e.value());
+  for (auto &e: items)
+    c->insert(e.key, deep ? e.value->copy(true) : e.value);
 
   return c;
 }
 
 
-Iterator Dict::begin() const {return makeIt(DictImpl::begin());}
-Iterator Dict::end()   const {return makeIt(DictImpl::end());}
+Iterator Dict::begin() const {return makeIt(0);}
+Iterator Dict::end()   const {return makeIt(size());}
 
 
 Iterator Dict::find(const string &key) const {
-  return makeIt(DictImpl::find(key));
+  int i = lookup(key);
+  return makeIt(i < 0 ? size() : i);
 }
 
 
 const ValuePtr &Dict::get(const string &key) const {
-  auto it = DictImpl::find(key);
-  if (it == DictImpl::end()) CBANG_KEY_ERROR("Key '" << key << "' not found");
-  return it.value();
+  int i = lookup(key);
+  if (i < 0) CBANG_KEY_ERROR("Key '" << key << "' not found");
+  return items[i].value;
 }
 
 
 Iterator Dict::insert(const string &key, const ValuePtr &value) {
   if (value->isList() || value->isDict()) simple = false;
-  return makeIt(DictImpl::insert(key, value));
+
+  int i = lookup(key);
+  if (0 <= i) {
+    items[i].value = value;
+    return makeIt(i);
+  }
+
+  items.emplace_back(key, value);
+
+  if (INDEX_THRESHOLD < size()) {
+    // Keep the table at most half full
+    if (index.size() < 2 * size()) reindex();
+    else indexEntry(size() - 1);
+  }
+
+  return makeIt(size() - 1);
+}
+
+
+void Dict::clear() {
+  items.clear();
+  index.clear();
+}
+
+
+void Dict::erase(const string &key) {
+  int i = lookup(key);
+  if (0 <= i) erase(makeIt(i));
 }
 
 
 Iterator Dict::erase(const Iterator &it) {
-  return makeIt(DictImpl::erase(it.key()));
+  int i = lookup(it.key());
+  if (i < 0) CBANG_THROW("Cannot erase invalid iterator");
+
+  if (!index.empty()) unindexEntry(i);
+  items.erase(items.begin() + i);
+
+  if (size() <= INDEX_THRESHOLD) index.clear();
+  else
+    // Later entries have moved down one
+    for (auto &slot: index)
+      if ((unsigned)i + 1 < slot) slot--;
+
+  return makeIt(i);
 }
 
 
 void Dict::write(Sink &sink) const {
   sink.beginDict(isSimple());
 
-  for (auto it: (DictImpl &)*this) {
-    if (!it.value()->canWrite(sink)) continue;
-    sink.beginInsert(it.key());
-    it.value()->write(sink);
+  for (auto &e: items) {
+    if (!e.value->canWrite(sink)) continue;
+    sink.beginInsert(e.key);
+    e.value->write(sink);
   }
 
   sink.endDict();
@@ -111,6 +205,71 @@ void Dict::visitChildren(visitor_t visitor, bool depthFirst) {
 }
 
 
-Iterator Dict::makeIt(const DictImpl::const_iterator &it) const {
-  return Iterator(new DictIterator(it, DictImpl::end()));
+int Dict::lookup(const string &key) const {
+  if (index.empty()) {
+    for (unsigned i = 0; i < items.size(); i++)
+      if (items[i].key == key) return i;
+
+    return -1;
+  }
+
+  // Slots hold entry index + 1, zero marks an empty slot
+  unsigned mask = index.size() - 1;
+
+  for (unsigned slot = keyHash(key) & mask; index[slot];
+       slot = (slot + 1) & mask)
+    if (items[index[slot] - 1].key == key) return index[slot] - 1;
+
+  return -1;
+}
+
+
+void Dict::reindex() {
+  unsigned slots = 2 * INDEX_THRESHOLD;
+  while (slots < 4 * size()) slots *= 2;
+
+  index.assign(slots, 0);
+  for (unsigned i = 0; i < size(); i++) indexEntry(i);
+}
+
+
+void Dict::indexEntry(unsigned i) {
+  unsigned mask = index.size() - 1;
+  unsigned slot = keyHash(items[i].key) & mask;
+
+  while (index[slot]) slot = (slot + 1) & mask;
+  index[slot] = i + 1;
+}
+
+
+void Dict::unindexEntry(unsigned i) {
+  unsigned mask = index.size() - 1;
+  unsigned slot = keyHash(items[i].key) & mask;
+
+  while (index[slot] != i + 1) slot = (slot + 1) & mask;
+  index[slot] = 0;
+
+  // Shift back later entries of the probe sequence which could no longer be
+  // reached past the empty slot
+  for (unsigned next = (slot + 1) & mask; index[next];
+       next = (next + 1) & mask) {
+    unsigned home = keyHash(items[index[next] - 1].key) & mask;
+
+    if (((next - slot) & mask) <= ((next - home) & mask)) {
+      index[slot] = index[next];
+      index[next] = 0;
+      slot = next;
+    }
+  }
+}
+
+
+const Dict::Entry &Dict::at(unsigned i) const {
+  if (size() <= i) CBANG_THROW("Cannot dereference end of Dict");
+  return items[i];
+}
+
+
+Iterator Dict::makeIt(unsigned i) const {
+  return Iterator(new DictIterator(*this, i));
 }
@@ -34,24 +34,39 @@
 
 #include "Value.h"
 
-#include <cbang/util/OrderedDict.h>
+#include <vector>
 
 
 namespace cb {
   namespace JSON {
-    using DictImpl = OrderedDict<std::string, ValuePtr>;
-
-    class Dict : public Value, protected DictImpl {
+    /// Entries are kept in insertion order in one flat vector.  Small dicts
+    /// are searched linearly, larger ones through an open addressing hash
+    /// table of entry indices.
+    class Dict : public Value {
       friend class DictIterator;
+
+      struct Entry {
+        std::string key;
+        ValuePtr value;
+
+        Entry(const std::string &key, const ValuePtr &value) :
+          key(key), value(value) {}
+      };
+
+      std::vector<Entry> items;
+      std::vector<uint32_t> index;
       bool simple;
 
     public:
+      /// Dicts larger than this are indexed
+      static const unsigned INDEX_THRESHOLD = 16;
+
       Dict() : simple(true) {}
 
       using Iterator = JSON::Iterator;
 
-      // From DictImpl
-      using DictImpl::empty;
+      void reserve(unsigned size) {items.reserve(size);}
+      void shrink() {items.shrink_to_fit();}
 
       // From Value
       using Value::begin;
@@ -73,15 +88,15 @@ namespace cb {
       Iterator end()   const override;
 
       bool toBoolean() const override {return size();}
-      unsigned size() const override {return DictImpl::size();}
+      unsigned size() const override {return items.size();}
       Iterator find(const std::string &key) const override;
       const ValuePtr &get(const std::string &key) const override;
 
       Iterator insert(const std::string &key, const ValuePtr &value) override;
       using Value::insert;
 
-      void clear() override {DictImpl::clear();}
-      void erase(const std::string &key) override {DictImpl::erase(key);}
+      void clear() override;
+      void erase(const std::string &key) override;
       Iterator erase(const Iterator &it) override;
 
       void write(Sink &sink) const override;
@@ -91,7 +106,12 @@ namespace cb {
       void visitChildren(visitor_t visitor, bool depthFirst = true) override;
 
     private:
-      Iterator makeIt(const DictImpl::const_iterator &it) const;
+      int lookup(const std::string &key) const;
+      void reindex();
+      void indexEntry(unsigned i);
+      void unindexEntry(unsigned i);
+      const Entry &at(unsigned i) const;
+      Iterator makeIt(unsigned i) const;
     };
   }
 }
@@ -39,12 +39,13 @@ using namespace cb::JSON;
 
 
 SmartPointer<IteratorImpl> DictIterator::clone() const {
-  return new DictIterator(it, end);
+  return new DictIterator(dict, i);
 }
 
 
 bool DictIterator::equal(const SmartPointer<IteratorImpl> &o) const {
-  return it == o.cast<DictIterator>()->it;
+  auto it = o.cast<DictIterator>();
+  return &dict == &it->dict && i == it->i;
 }
 
 
@@ -39,23 +39,24 @@
 namespace cb {
   namespace JSON {
     class DictIterator : public IteratorImpl {
-      using iterator = DictImpl::const_iterator;
-      iterator it;
-      iterator end;
+      const Dict &dict;
+      unsigned i;
 
     public:
-      DictIterator(const iterator &it, iterator end) : it(it), end(end) {}
+      DictIterator(const Dict &dict, unsigned i) : dict(dict), i(i) {}
 
       SmartPointer<IteratorImpl> clone() const override;
       bool equal(const SmartPointer<IteratorImpl> &o) const override;
-      void next() override {it++;}
-      void prev() override {it--;}
+      void next() override {i++;}
+      void prev() override {i--;}
 
-      operator bool() const override {return it != end;}
+      operator bool() const override {return i < dict.size();}
 
-      const std::string &key() const override {return it.key();}
+      const std::string &key() const override {return dict.at(i).key;}
       unsigned index() const override;
-      const SmartPointer<Value> &value() const override {return it.value();}
+      const SmartPointer<Value> &value() const override {
+        return dict.at(i).value;
+      }
     };
   }
 }
@@ -45,6 +45,7 @@
 #include "Builder.h"
 #include "NullSink.h"
 #include "BufferWriter.h"
+#include "StringWriter.h"
 #include "Integer.h"
 #include "Factory.h"
 #include "Serializable.h"
@@ -0,0 +1,180 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2021-2026, Cauldron Development  Oy
+                Copyright (c) 2003-2021, Cauldron Development LLC
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include "MessagePackReader.h"
+#include "Builder.h"
+
+#include <cbang/String.h>
+
+#include <cstring>
+
+using namespace std;
+using namespace cb;
+using namespace cb::JSON;
+
+
+void MessagePackReader::parse(Sink &sink, unsigned depth) {
+  if (1000 < ++depth) error("Maximum MessagePack parse depth reached");
+
+  uint8_t type = next();
+
+  if (type < 0x80) return sink.write((uint64_t)type); // Positive fixint
+  if (0xe0 <= type) return sink.write((int64_t)(int8_t)type); // Negative
+  if (type < 0x90) return parseDict(sink, type & 0x0f, depth);
+  if (type < 0xa0) return parseList(sink, type & 0x0f, depth);
+  if (type < 0xc0) return sink.write(readString(type & 0x1f));
+
+  switch (type) {
+  case 0xc0: return sink.writeNull();
+  case 0xc2: return sink.writeBoolean(false);
+  case 0xc3: return sink.writeBoolean(true);
+
+  case 0xc4: case 0xd9: return sink.write(readString(readBE(1)));
+  case 0xc5: case 0xda: return sink.write(readString(readBE(2)));
+  case 0xc6: case 0xdb: return sink.write(readString(readBE(4)));
+
+  case 0xca: {
+    uint32_t bits = readBE(4);
+    float f;
+    memcpy(&f, &bits, 4);
+    return sink.write((double)f);
+  }
+
+  case 0xcb: {
+    uint64_t bits = readBE(8);
+    double d;
+    memcpy(&d, &bits, 8);
+    return sink.write(d);
+  }
+
+  case 0xcc: return sink.write(readBE(1));
+  case 0xcd: return sink.write(readBE(2));
+  case 0xce: return sink.write(readBE(4));
+  case 0xcf: return sink.write(readBE(8));
+
+  case 0xd0: return sink.write((int64_t)(int8_t)readBE(1));
+  case 0xd1: return sink.write((int64_t)(int16_t)readBE(2));
+  case 0xd2: return sink.write((int64_t)(int32_t)readBE(4));
+  case 0xd3: return sink.write((int64_t)readBE(8));
+
+  case 0xdc: return parseList(sink, readBE(2), depth);
+  case 0xdd: return parseList(sink, readBE(4), depth);
+  case 0xde: return parseDict(sink, readBE(2), depth);
+  case 0xdf: return parseDict(sink, readBE(4), depth);
+  }
+
+  error(SSTR("Unsupported MessagePack type 0x" << hex << (int)type));
+}
+
+
+ValuePtr MessagePackReader::parse() {
+  Builder builder;
+  parse(builder);
+  return builder.getRoot();
+}
+
+
+ValuePtr MessagePackReader::parse(const string &data) {
+  return MessagePackReader(data).parse();
+}
+
+
+void MessagePackReader::parse(const string &data, Sink &sink) {
+  MessagePackReader(data).parse(sink);
+}
+
+
+uint8_t MessagePackReader::next() {return *consume(1);}
+
+
+const uint8_t *MessagePackReader::consume(uint64_t length) {
+  if ((uint64_t)(end - ptr) < length) error("Truncated MessagePack data");
+  const uint8_t *p = ptr;
+  ptr += length;
+  return p;
+}
+
+
+uint64_t MessagePackReader::readBE(unsigned bytes) {
+  const uint8_t *p = consume(bytes);
+  uint64_t x = 0;
+  for (unsigned i = 0; i < bytes; i++) x = x << 8 | p[i];
+  return x;
+}
+
+
+string MessagePackReader::readString(uint64_t length) {
+  return string((const char *)consume(length), length);
+}
+
+
+string MessagePackReader::readKey() {
+  uint8_t type = next();
+
+  if ((type & 0xe0) == 0xa0) return readString(type & 0x1f);
+
+  switch (type) {
+  case 0xc4: case 0xd9: return readString(readBE(1));
+  case 0xc5: case 0xda: return readString(readBE(2));
+  case 0xc6: case 0xdb: return readString(readBE(4));
+  }
+
+  error("MessagePack map key is not a string");
+  return string();
+}
+
+
+void MessagePackReader::parseList(Sink &sink, uint64_t n, unsigned depth) {
+  sink.beginList();
+
+  for (; n; n--) {
+    sink.beginAppend();
+    parse(sink, depth);
+  }
+
+  sink.endList();
+}
+
+
+void MessagePackReader::parseDict(Sink &sink, uint64_t n, unsigned depth) {
+  sink.beginDict();
+
+  for (; n; n--) {
+    sink.beginInsert(readKey());
+    parse(sink, depth);
+  }
+
+  sink.endDict();
+}
+
+
+void MessagePackReader::error(const string &msg) const {PARSE_ERROR(msg);}
@@ -0,0 +1,75 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2021-2026, Cauldron Development  Oy
+                Copyright (c) 2003-2021, Cauldron Development LLC
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#pragma once
+
+#include "Value.h"
+
+#include <string>
+
+
+namespace cb {
+  namespace JSON {
+    class Sink;
+
+    /// Decodes MessagePack into any Sink.  Binary data is written as strings
+    /// and map keys must be strings.  Extension types are not supported.  The
+    /// data must stay valid while it is parsed.
+    class MessagePackReader {
+      const uint8_t *ptr;
+      const uint8_t *end;
+
+    public:
+      MessagePackReader(const char *data, size_t length) :
+        ptr((const uint8_t *)data), end(ptr + length) {}
+      MessagePackReader(const std::string &data) :
+        MessagePackReader(data.data(), data.size()) {}
+
+      bool isDone() const {return ptr == end;}
+
+      void parse(Sink &sink, unsigned depth = 0);
+      ValuePtr parse();
+      static ValuePtr parse(const std::string &data);
+      static void parse(const std::string &data, Sink &sink);
+
+    protected:
+      uint8_t next();
+      const uint8_t *consume(uint64_t length);
+      uint64_t readBE(unsigned bytes);
+      std::string readString(uint64_t length);
+      std::string readKey();
+      void parseList(Sink &sink, uint64_t n, unsigned depth);
+      void parseDict(Sink &sink, uint64_t n, unsigned depth);
+      void error(const std::string &msg) const;
+    };
+  }
+}
@@ -0,0 +1,199 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2021-2026, Cauldron Development  Oy
+                Copyright (c) 2003-2021, Cauldron Development LLC
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include "MessagePackWriter.h"
+
+#include <cbang/Exception.h>
+#include <cbang/net/Swab.h>
+
+#include <cstring>
+
+using namespace std;
+using namespace cb::JSON;
+
+
+void MessagePackWriter::reset() {
+  NullSink::reset();
+  containers.clear();
+}
+
+
+void MessagePackWriter::writeNull() {
+  NullSink::writeNull();
+  writeByte(0xc0);
+}
+
+
+void MessagePackWriter::writeBoolean(bool value) {
+  NullSink::writeBoolean(value);
+  writeByte(value ? 0xc3 : 0xc2);
+}
+
+
+void MessagePackWriter::write(double value) {
+  NullSink::write(value);
+
+  float f = value;
+  if ((double)f == value || value != value) {
+    uint32_t bits;
+    memcpy(&bits, &f, 4);
+    writeBE(0xca, bits, 4);
+
+  } else {
+    uint64_t bits;
+    memcpy(&bits, &value, 8);
+    writeBE(0xcb, bits, 8);
+  }
+}
+
+
+void MessagePackWriter::write(uint64_t value) {
+  assertCanWrite();
+
+  if      (value < 0x80)        writeByte(value);
+  else if (value <= 0xff)       writeBE(0xcc, value, 1);
+  else if (value <= 0xffff)     writeBE(0xcd, value, 2);
+  else if (value <= 0xffffffff) writeBE(0xce, value, 4);
+  else                          writeBE(0xcf, value, 8);
+}
+
+
+void MessagePackWriter::write(int64_t value) {
+  if (0 <= value) return write((uint64_t)value);
+
+  assertCanWrite();
+
+  if      (-32 <= value)       writeByte(value);
+  else if (INT8_MIN <= value)  writeBE(0xd0, value, 1);
+  else if (INT16_MIN <= value) writeBE(0xd1, value, 2);
+  else if (INT32_MIN <= value) writeBE(0xd2, value, 4);
+  else                         writeBE(0xd3, value, 8);
+}
+
+
+void MessagePackWriter::write(const string &value) {
+  NullSink::write(value);
+  writeText(value);
+}
+
+
+void MessagePackWriter::beginList(bool simple) {
+  NullSink::beginList(simple);
+  beginContainer(0xdd);
+}
+
+
+void MessagePackWriter::beginAppend() {
+  NullSink::beginAppend();
+  containers.back().count++;
+}
+
+
+void MessagePackWriter::endList() {
+  NullSink::endList();
+  endContainer(0x90, 0xdc);
+}
+
+
+void MessagePackWriter::beginDict(bool simple) {
+  NullSink::beginDict(simple);
+  beginContainer(0xdf);
+}
+
+
+void MessagePackWriter::beginInsert(const string &key) {
+  NullSink::beginInsert(key);
+  containers.back().count++;
+  writeText(key);
+}
+
+
+void MessagePackWriter::endDict() {
+  NullSink::endDict();
+  endContainer(0x80, 0xde);
+}
+
+
+void MessagePackWriter::writeBE(uint8_t type, uint64_t value, unsigned bytes) {
+  uint64_t x = hton64(value);
+  writeByte(type);
+  output.append((char *)&x + 8 - bytes, bytes);
+}
+
+
+void MessagePackWriter::writeText(const string &s) {
+  uint64_t size = s.size();
+
+  if      (size < 32)          writeByte(0xa0 | size);
+  else if (size <= 0xff)       writeBE(0xd9, size, 1);
+  else if (size <= 0xffff)     writeBE(0xda, size, 2);
+  else if (size <= 0xffffffff) writeBE(0xdb, size, 4);
+  else THROW("String too long for MessagePack");
+
+  output.append(s);
+}
+
+
+void MessagePackWriter::beginContainer(uint8_t type32) {
+  containers.push_back({output.size(), 0});
+  writeBE(type32, 0, 4);
+}
+
+
+void MessagePackWriter::endContainer(uint8_t fix, uint8_t type16) {
+  Container c = containers.back();
+  containers.pop_back();
+
+  // Rewrite the placeholder head in its smallest form
+  char head[5];
+  unsigned size;
+
+  if (c.count < 16) {
+    head[0] = fix | c.count;
+    size = 1;
+
+  } else if (c.count <= 0xffff) {
+    uint16_t x = hton16((uint16_t)c.count);
+    head[0] = type16;
+    memcpy(head + 1, &x, 2);
+    size = 3;
+
+  } else {
+    uint32_t x = hton32(c.count);
+    head[0] = output[c.offset];
+    memcpy(head + 1, &x, 4);
+    size = 5;
+  }
+
+  if (size < 5) output.erase(c.offset + size, 5 - size);
+  output.replace(c.offset, size, head, size);
+}
@@ -0,0 +1,94 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2021-2026, Cauldron Development  Oy
+                Copyright (c) 2003-2021, Cauldron Development LLC
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#pragma once
+
+#include "NullSink.h"
+
+#include <string>
+#include <vector>
+
+
+namespace cb {
+  namespace JSON {
+    /// Encodes JSON as MessagePack appended to a string.  MessagePack has no
+    /// indefinite lengths so each list or dict is started with a 32-bit count
+    /// which is filled in and shrunk to the smallest form when it ends.
+    /// Doubles which are exact as single precision are stored in four bytes.
+    class MessagePackWriter : public NullSink {
+      std::string &output;
+
+      struct Container {
+        size_t offset;
+        uint32_t count;
+      };
+
+      std::vector<Container> containers;
+
+    public:
+      MessagePackWriter(std::string &output, bool allowDuplicates = false) :
+        NullSink(allowDuplicates), output(output) {}
+
+      // From Sink
+      void reset() override;
+      void writeNull() override;
+      void writeBoolean(bool value) override;
+      void write(double value) override;
+      void write(uint64_t value) override;
+      void write(int64_t value) override;
+      void write(const std::string &value) override;
+      using Sink::write;
+      void beginList(bool simple = false) override;
+      void beginAppend() override;
+      void endList() override;
+      void beginDict(bool simple = false) override;
+      void beginInsert(const std::string &key) override;
+      void endDict() override;
+
+      template <typename T>
+      static std::string encode(const T &o) {
+        std::string output;
+        MessagePackWriter writer(output);
+        o.write(writer);
+        writer.close();
+        return output;
+      }
+
+    protected:
+      void writeByte(uint8_t b) {output.push_back((char)b);}
+      void writeBE(uint8_t type, uint64_t value, unsigned bytes);
+      void writeText(const std::string &s);
+      void beginContainer(uint8_t type32);
+      void endContainer(uint8_t fix, uint8_t type16);
+    };
+  }
+}
@@ -98,9 +98,9 @@ bool NullSink::has(const std::string &key) const {
 
 void NullSink::beginInsert(const std::string &key) {
   assertWriteNotPending();
-  if (has(key) && !allowDuplicates)
+  if (!inDict()) TYPE_ERROR("Not a Dict");
+  if (!keyStack.back().insert(key).second && !allowDuplicates)
     KEY_ERROR("Key '" << key << "' already written to output");
-  keyStack.back().insert(key);
   canWrite = true;
 }
 
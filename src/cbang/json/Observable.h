@@ -140,13 +140,18 @@ namespace cb {
 
       Iterator erase(const Iterator &it) override {
         _clearParentRef(*it);
+
+        // The iterator may not be valid after the erase
+        unsigned index = T::isList() ? it.index() : 0;
+        std::string key = T::isList() ? std::string() : it.key();
+
         auto it2 = T::erase(it);
 
         if (T::isList()) {
           while (it2) _decParentRef(*it2++);
-          _notify(it.index());
+          _notify(index);
 
-        } else _notify(it.key());
+        } else _notify(key);
 
         return it2;
       }
@@ -52,6 +52,7 @@ namespace cb {
 
       bool empty() const {return parts.empty();}
       unsigned size() const {return parts.size();}
+      const std::string &operator[](unsigned i) const {return parts.at(i);}
       std::string toString(unsigned start = 0, int end = -1) const;
 
       std::string pop();
@@ -257,6 +257,8 @@ void Reader::parseNumber(Sink &sink) {
       return sink.write((uint64_t)v);
   }
 
+  // Integers which overflow are read as doubles
+  errno = 0;
   double v = strtod(start, &end);
   if (errno || (size_t)(end - start) != value.length())
     error(SSTR("Invalid JSON number '" << value << "'"));
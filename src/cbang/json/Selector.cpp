@@ -0,0 +1,285 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2021-2026, Cauldron Development  Oy
+                Copyright (c) 2003-2021, Cauldron Development LLC
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include "Selector.h"
+#include "BufferReader.h"
+#include "Dict.h"
+
+#include <cbang/String.h>
+#include <cbang/Errors.h>
+
+using namespace std;
+using namespace cb;
+using namespace cb::JSON;
+
+
+Selector::Selector(const vector<string> &paths) {
+  for (auto &s: paths) {
+    this->paths.push_back(Path(s));
+    const Path &path = this->paths.back();
+
+    vector<Part> parts;
+    for (unsigned i = 0; i < path.size(); i++) {
+      int64_t index = -1;
+      try {
+        index = String::parseU32(path[i], true);
+      } catch (const Exception &e) {}
+
+      parts.push_back({path[i], index});
+    }
+
+    this->parts.push_back(parts);
+  }
+
+  reset();
+}
+
+
+ValuePtr Selector::getResults() const {
+  ValuePtr dict = new Dict;
+
+  for (unsigned i = 0; i < paths.size(); i++)
+    if (results[i].isSet()) dict->insert(paths[i].toString(), results[i]);
+
+  return dict;
+}
+
+
+ValuePtr Selector::select(const char *data, size_t length,
+                          const vector<string> &paths) {
+  Selector selector(paths);
+  BufferReader(data, length).parse(selector);
+  return selector.getResults();
+}
+
+
+ValuePtr Selector::select(const string &data, const vector<string> &paths) {
+  return select(data.data(), data.size(), paths);
+}
+
+
+void Selector::close() {
+  if (!stack.empty())
+    THROW("Selector closed with open " << (stack.back() ? "List" : "Dict"));
+}
+
+
+void Selector::reset() {
+  results.assign(paths.size(), 0);
+  found = 0;
+
+  stack.clear();
+  frames.clear();
+  skipDepth = 0;
+  builder.release();
+
+  // Every path starts at the root
+  pending.clear();
+  for (unsigned i = 0; i < paths.size(); i++) pending.push_back(i);
+}
+
+
+bool Selector::wantsValue() const {
+  return builder.isSet() || (!skipDepth && !pending.empty());
+}
+
+
+void Selector::writeNull() {
+  if (beginValue(false)) {
+    builder->writeNull();
+    endValue();
+  }
+}
+
+
+void Selector::writeBoolean(bool value) {
+  if (beginValue(false)) {
+    builder->writeBoolean(value);
+    endValue();
+  }
+}
+
+
+void Selector::write(double value) {
+  if (beginValue(false)) {
+    builder->write(value);
+    endValue();
+  }
+}
+
+
+void Selector::write(uint64_t value) {
+  if (beginValue(false)) {
+    builder->write(value);
+    endValue();
+  }
+}
+
+
+void Selector::write(int64_t value) {
+  if (beginValue(false)) {
+    builder->write(value);
+    endValue();
+  }
+}
+
+
+void Selector::write(const string &value) {
+  if (beginValue(false)) {
+    builder->write(value);
+    endValue();
+  }
+}
+
+
+bool Selector::inList() const {return !stack.empty() && stack.back();}
+
+
+void Selector::beginList(bool simple) {
+  if (beginValue(true)) builder->beginList(simple);
+  stack.push_back(true);
+}
+
+
+void Selector::beginAppend() {
+  if (!inList()) TYPE_ERROR("Not a List");
+  if (builder.isSet()) return builder->beginAppend();
+  if (!skipDepth) next(string(), frames.back().index++);
+}
+
+
+void Selector::endList() {
+  if (!inList()) TYPE_ERROR("Not a List");
+  stack.pop_back();
+
+  if (builder.isSet()) {
+    builder->endList();
+    endValue();
+
+  } else if (skipDepth) skipDepth--;
+  else frames.pop_back();
+}
+
+
+bool Selector::inDict() const {return !stack.empty() && !stack.back();}
+
+
+void Selector::beginDict(bool simple) {
+  if (beginValue(true)) builder->beginDict(simple);
+  stack.push_back(false);
+}
+
+
+bool Selector::has(const string &key) const {
+  return builder.isSet() && builder->has(key);
+}
+
+
+void Selector::beginInsert(const string &key) {
+  if (!inDict()) TYPE_ERROR("Not a Dict");
+  if (builder.isSet()) return builder->beginInsert(key);
+  if (!skipDepth) next(key, -1);
+}
+
+
+void Selector::endDict() {
+  if (!inDict()) TYPE_ERROR("Not a Dict");
+  stack.pop_back();
+
+  if (builder.isSet()) {
+    builder->endDict();
+    endValue();
+
+  } else if (skipDepth) skipDepth--;
+  else frames.pop_back();
+}
+
+
+void Selector::next(const string &key, int64_t index) {
+  // Keep the paths which continue with this key or list index
+  pending.clear();
+
+  unsigned depth = frames.size() - 1;
+  for (auto i: frames.back().candidates) {
+    if (results[i].isSet()) continue;
+
+    const Part &part = parts[i][depth];
+    if (index < 0 ? part.key == key : part.index == index)
+      pending.push_back(i);
+  }
+}
+
+
+bool Selector::beginValue(bool container) {
+  // Returns true if the value should be written to the builder
+  if (builder.isSet()) return true;
+
+  if (skipDepth || pending.empty()) {
+    if (container) skipDepth++;
+    pending.clear();
+    return false;
+  }
+
+  // Build the value if a path ends here
+  for (auto i: pending)
+    if (parts[i].size() == frames.size()) {
+      builder = new Builder;
+      return true;
+    }
+
+  if (container) frames.push_back({0, pending});
+  pending.clear();
+
+  return false;
+}
+
+
+void Selector::endValue() {
+  if (builder->getDepth()) return;
+
+  ValuePtr value = builder->getRoot();
+  builder.release();
+
+  // Paths which end here or continue inside the value
+  for (auto i: pending)
+    if (results[i].isNull()) {
+      if (parts[i].size() == frames.size()) results[i] = value;
+      else {
+        Path path(paths[i].toString(frames.size()));
+        results[i] = path.select(*value, ValuePtr());
+      }
+
+      if (results[i].isSet()) found++;
+    }
+
+  pending.clear();
+}
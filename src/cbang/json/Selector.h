@@ -0,0 +1,114 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2021-2026, Cauldron Development  Oy
+                Copyright (c) 2003-2021, Cauldron Development LLC
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#pragma once
+
+#include "Sink.h"
+#include "Path.h"
+#include "Builder.h"
+
+#include <string>
+#include <vector>
+
+
+namespace cb {
+  namespace JSON {
+    /// Keeps only the values found at a set of paths from a stream of Sink
+    /// calls.  Paths use the same syntax as Path.  Only the selected values
+    /// are built and everything else is dropped as it arrives.  Parsers which
+    /// check wantsValue(), such as BufferReader, skip unwanted values without
+    /// decoding them.  Once every path is found the rest is skipped.
+    class Selector : public Sink {
+      struct Part {
+        std::string key;
+        int64_t index; // -1 if not a list index
+      };
+
+      struct Frame {
+        unsigned index;
+        std::vector<unsigned> candidates;
+      };
+
+      std::vector<Path> paths;
+      std::vector<std::vector<Part>> parts;
+      std::vector<ValuePtr> results;
+      unsigned found = 0;
+
+      std::vector<bool> stack; // True for lists
+      std::vector<Frame> frames;
+      std::vector<unsigned> pending;
+      unsigned skipDepth = 0;
+
+      SmartPointer<Builder> builder;
+
+    public:
+      Selector(const std::vector<std::string> &paths);
+
+      unsigned size() const {return paths.size();}
+      bool isComplete() const {return found == paths.size();}
+      const ValuePtr &get(unsigned i) const {return results.at(i);}
+      ValuePtr getResults() const;
+
+      static ValuePtr select(const char *data, size_t length,
+                             const std::vector<std::string> &paths);
+      static ValuePtr select(const std::string &data,
+                             const std::vector<std::string> &paths);
+
+      // From Sink
+      unsigned getDepth() const override {return stack.size();}
+      void close() override;
+      void reset() override;
+      bool wantsValue() const override;
+      void writeNull() override;
+      void writeBoolean(bool value) override;
+      void write(double value) override;
+      void write(uint64_t value) override;
+      void write(int64_t value) override;
+      void write(const std::string &value) override;
+      using Sink::write;
+      bool inList() const override;
+      void beginList(bool simple = false) override;
+      void beginAppend() override;
+      void endList() override;
+      bool inDict() const override;
+      void beginDict(bool simple = false) override;
+      bool has(const std::string &key) const override;
+      void beginInsert(const std::string &key) override;
+      void endDict() override;
+
+    protected:
+      void next(const std::string &key, int64_t index);
+      bool beginValue(bool container);
+      void endValue();
+    };
+  }
+}
@@ -50,6 +50,10 @@ namespace cb {
       virtual void close() = 0;
       virtual void reset() = 0;
 
+      /// False if the next value would be ignored.  A parser may then skip it
+      /// without writing it.  Checked after beginAppend() and beginInsert().
+      virtual bool wantsValue() const {return true;}
+
       // Element functions
       virtual void writeNull() = 0;
       virtual void writeBoolean(bool value) = 0;
@@ -0,0 +1,355 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2021-2026, Cauldron Development  Oy
+                Copyright (c) 2003-2021, Cauldron Development LLC
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include "StringWriter.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CBANG_JSON_SSE2
+
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define CBANG_JSON_NEON
+#endif
+
+using namespace std;
+using namespace cb::JSON;
+
+
+namespace {
+  inline bool isPlain(unsigned char c) {
+    return c != '"' && c != '\\' && 0x20 <= c && c < 0x7f;
+  }
+
+
+  // Find the first byte which cannot be copied as is.  The vector loops only
+  // find the block, the scalar loop finds the byte.
+  const char *scanPlain(const char *p, const char *end) {
+#if defined(CBANG_JSON_SSE2)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i slash = _mm_set1_epi8('\\');
+    const __m128i space = _mm_set1_epi8(0x20);
+    const __m128i del   = _mm_set1_epi8(0x7f);
+
+    for (; p + 16 <= end; p += 16) {
+      __m128i v = _mm_loadu_si128((const __m128i *)p);
+
+      // A signed compare catches control characters and bytes >= 0x80
+      __m128i x = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, slash)),
+        _mm_or_si128(_mm_cmplt_epi8(v, space), _mm_cmpeq_epi8(v, del)));
+
+      if (_mm_movemask_epi8(x)) break;
+    }
+
+#elif defined(CBANG_JSON_NEON)
+    for (; p + 16 <= end; p += 16) {
+      uint8x16_t v = vld1q_u8((const uint8_t *)p);
+
+      uint8x16_t x = vorrq_u8(
+        vorrq_u8(vceqq_u8(v, vdupq_n_u8('"')), vceqq_u8(v, vdupq_n_u8('\\'))),
+        vorrq_u8(vcltq_u8(v, vdupq_n_u8(0x20)), vcgeq_u8(v, vdupq_n_u8(0x7f))));
+
+      if (vmaxvq_u8(x)) break;
+    }
+#endif
+
+    while (p < end && isPlain(*p)) p++;
+    return p;
+  }
+
+
+  void encode(string &output, uint32_t code) {
+    static const char hex[] = "0123456789abcdef";
+
+    char buf[6] = {'\\', 'u', hex[(code >> 12) & 15], hex[(code >> 8) & 15],
+                   hex[(code >> 4) & 15], hex[code & 15]};
+    output.append(buf, 6);
+  }
+}
+
+
+void StringWriter::reset() {
+  NullSink::reset();
+  simple.clear();
+  first = true;
+}
+
+
+void StringWriter::writeNull() {
+  NullSink::writeNull();
+  output.append("null", 4);
+}
+
+
+void StringWriter::writeBoolean(bool value) {
+  NullSink::writeBoolean(value);
+  if (value) output.append("true", 4);
+  else output.append("false", 5);
+}
+
+
+void StringWriter::write(double value) {
+  NullSink::write(value);
+
+  // These values are parsed correctly by both Python and Javascript
+  if (std::isnan(value)) output.append("\"NaN\"");
+  else if (std::isinf(value) && 0 < value) output.append("\"Infinity\"");
+  else if (std::isinf(value) && value < 0) output.append("\"-Infinity\"");
+  else format(output, value, precision);
+}
+
+
+void StringWriter::write(uint64_t value) {
+  NullSink::write(value);
+
+  char buf[24];
+  output.append(buf, to_chars(buf, buf + sizeof(buf), value).ptr - buf);
+}
+
+
+void StringWriter::write(int64_t value) {
+  NullSink::write(value);
+
+  char buf[24];
+  output.append(buf, to_chars(buf, buf + sizeof(buf), value).ptr - buf);
+}
+
+
+void StringWriter::write(const string &value) {
+  NullSink::write(value);
+  writeString(value);
+}
+
+
+void StringWriter::beginList(bool simple) {
+  NullSink::beginList(simple);
+  this->simple.push_back(simple);
+  output += '[';
+  first = true;
+}
+
+
+void StringWriter::beginAppend() {
+  NullSink::beginAppend();
+  separate();
+}
+
+
+void StringWriter::endList() {
+  NullSink::endList();
+
+  if (!(compact || simple.back()) && !first) {
+    output += '\n';
+    indent();
+  }
+
+  output += ']';
+
+  first = false;
+  simple.pop_back();
+}
+
+
+void StringWriter::beginDict(bool simple) {
+  NullSink::beginDict(simple);
+  this->simple.push_back(simple);
+  output += '{';
+  first = true;
+}
+
+
+void StringWriter::beginInsert(const string &key) {
+  NullSink::beginInsert(key);
+  separate();
+
+  writeString(key);
+  output += ':';
+  if (!compact) output += ' ';
+}
+
+
+void StringWriter::endDict() {
+  NullSink::endDict();
+
+  if (!(simple.back() || compact) && !first) {
+    output += '\n';
+    indent();
+  }
+
+  output += '}';
+
+  first = false;
+  simple.pop_back();
+}
+
+
+void StringWriter::format(string &output, double value, int precision) {
+  char buf[300];
+  char *end = buf;
+
+  if (precision < 0) {
+#ifdef __cpp_lib_to_chars
+    end = to_chars(buf, buf + sizeof(buf), value).ptr;
+
+#else
+    // Use the fewest digits which read back exactly
+    for (int p = 15; p <= 17; p++) {
+      end = buf + snprintf(buf, sizeof(buf), "%.*g", p, value);
+      if (strtod(buf, 0) == value) break;
+    }
+#endif
+
+  } else {
+    // Digits beyond what a double holds only add zeros
+    precision = std::min(precision, 256);
+    bool big = value < -1e20 || 1e20 < value;
+
+#ifdef __cpp_lib_to_chars
+    end = to_chars(buf, buf + sizeof(buf), value,
+                   big ? chars_format::scientific : chars_format::fixed,
+                   precision).ptr;
+
+#else
+    end = buf + snprintf(buf, sizeof(buf), big ? "%.*e" : "%.*f", precision,
+                         value);
+#endif
+
+    // Drop trailing zeros from the fraction, keeping any exponent
+    char *e = find(buf, end, 'e');
+
+    if (find(buf, e, '.') != e) {
+      char *p = e;
+      while (p[-1] == '0') p--;
+      if (p[-1] == '.') p--;
+
+      memmove(p, e, end - e);
+      end -= e - p;
+    }
+  }
+
+  // Negative zero
+  if (end - buf == 2 && buf[0] == '-' && buf[1] == '0') {buf[0] = '0'; end--;}
+
+  output.append(buf, end - buf);
+}
+
+
+void StringWriter::escape(string &output, const char *s, size_t length) {
+  const char *end = s + length;
+
+  while (s < end) {
+    const char *run = s;
+    s = scanPlain(s, end);
+    output.append(run, s - run);
+    if (s == end) break;
+
+    unsigned char c = *s++;
+
+    switch (c) {
+    case '\\': output.append("\\\\", 2); break;
+    case '\"': output.append("\\\"", 2); break;
+    case '\b': output.append("\\b",  2); break;
+    case '\f': output.append("\\f",  2); break;
+    case '\n': output.append("\\n",  2); break;
+    case '\r': output.append("\\r",  2); break;
+    case '\t': output.append("\\t",  2); break;
+
+    default: {
+      // Control characters and DEL
+      if (c < 0x80) {encode(output, c); break;}
+
+      // Pass valid UTF-8, see Writer::escape()
+      unsigned width;
+      if      ((c & 0xe0) == 0xc0) width = 1;
+      else if ((c & 0xf0) == 0xe0) width = 2;
+      else if ((c & 0xf8) == 0xf0) width = 3;
+      else {encode(output, c); break;}
+
+      uint32_t code = c & (0x3f >> width);
+      const char *next = s;
+      bool valid = true;
+
+      for (unsigned i = 0; valid && i < width; i++)
+        if (next == end || (*next & 0xc0) != 0x80) valid = false;
+        else code = (code << 6) | (*next++ & 0x3f);
+
+      static const uint32_t minCode[] = {0x80, 0x800, 0x10000};
+      if (valid && (code < minCode[width - 1] ||
+                    (0xd800 <= code && code <= 0xdfff) || 0x10ffff < code))
+        valid = false;
+
+      if (!valid) encode(output, c);
+      else {
+        // JavaScript line separators
+        if (code == 0x2028 || code == 0x2029) encode(output, code);
+        else output.append(s - 1, next);
+        s = next;
+      }
+      break;
+    }
+    }
+  }
+}
+
+
+void StringWriter::writeString(const string &s) {
+  output += '"';
+  escape(output, s.data(), s.size());
+  output += '"';
+}
+
+
+void StringWriter::separate() {
+  if (first) first = false;
+  else {
+    output += ',';
+    if (simple.back() && !compact) output += ' ';
+  }
+
+  if (!compact && !simple.back()) {
+    output += '\n';
+    indent();
+  }
+}
+
+
+void StringWriter::indent() {
+  output.append((getDepth() + indentStart) * indentSpace, ' ');
+}
@@ -32,6 +32,7 @@
 
 #include "Value.h"
 #include "Path.h"
+#include "StringWriter.h"
 
 #include <cbang/config.h>
 
@@ -141,17 +142,18 @@ void Value::visit(visitor_t visitor, bool depthFirst) {
 
 void Value::write(ostream &stream, unsigned indentStart, bool compact,
                   unsigned indentSpace, int precision) const {
-  Writer writer(stream, indentStart, compact, indentSpace, precision);
-  write(writer);
+  string s = toString(indentStart, compact, indentSpace, precision);
+  stream.write(s.data(), s.size());
 }
 
 
 string Value::toString(unsigned indentStart, bool compact, unsigned indentSpace,
                        int precision) const {
-  ostringstream str;
-  write(str, indentStart, compact, indentSpace, precision);
-  str << flush;
-  return str.str();
+  string s;
+  StringWriter writer(s, indentStart, compact, indentSpace, precision);
+  write(writer);
+  writer.close();
+  return s;
 }
 
 
@@ -260,7 +260,7 @@ string Writer::escape(const string &s, const char *fmt) {
                       (0xd800 <= code && code <= 0xdfff) || 0x10ffff < code))
           valid = false;
 
-        if (!valid) result.append(encode(*it, fmt)); // Encode character
+        if (!valid) result.append(encode(c, fmt)); // Encode character
         else {
           if (code == 0x2028 || code == 0x2029)
             // Escape the JavaScript line separators U+2028 and U+2029,
@@ -0,0 +1,162 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2021-2026, Cauldron Development  Oy
+                Copyright (c) 2003-2021, Cauldron Development LLC
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include "AsyncLogWriter.h"
+#include "Logger.h"
+
+#include <cbang/String.h>
+#include <cbang/thread/SmartLock.h>
+#include <cbang/time/Timer.h>
+
+#include <iostream>
+#include <algorithm>
+
+using namespace std;
+using namespace cb;
+
+
+namespace {
+  // Shorter intervals would keep the writer thread spinning
+  const double minFlushInterval = 0.001;
+}
+
+
+AsyncLogWriter::AsyncLogWriter(Logger &logger, unsigned capacity, bool block,
+                               double flushInterval) :
+  logger(logger), queue(capacity), block(block),
+  flushInterval(std::max(flushInterval, minFlushInterval)), flushNow(false),
+  queued(0), written(0), flushed(0), dropped(0) {}
+
+
+AsyncLogWriter::~AsyncLogWriter() {join();}
+
+
+void AsyncLogWriter::write(const char *s, unsigned n) {
+  if (!n) return; // The writer skips empty lines, see sync()
+
+  string line(s, n);
+
+  if (!queue.try_enqueue(std::move(line))) {
+    if (!block || !isRunning()) {dropped++; return;}
+
+    // The writer signals after each batch it takes off the queue
+    SmartLock lock(&space);
+    while (!queue.try_enqueue(std::move(line))) {
+      if (!isRunning()) {dropped++; return;}
+      space.timedWait(0.1);
+    }
+  }
+
+  queued++;
+}
+
+
+void AsyncLogWriter::sync() {
+  uint64_t target = queued;
+  flushNow = true;
+  queue.try_enqueue(string()); // Wake the writer
+
+  SmartLock lock(&condition);
+  while (flushed < target && isRunning()) condition.timedWait(0.1);
+}
+
+
+void AsyncLogWriter::reportDropped() {
+  uint64_t count = dropped;
+  if (count == reported) return;
+
+  string msg = String::bar(SSTR("Dropped " << count - reported
+                                << " log lines")) +
+    (logger.getLogCRLF() ? "\r\n" : "\n");
+  logger.output(msg.data(), msg.size());
+  reported = count;
+}
+
+
+void AsyncLogWriter::run() {
+  const unsigned maxBatch = 1024;
+  double lastFlush = Timer::now();
+  bool dirty = false;
+  string line;
+
+  while (!shouldShutdown() || queue.peek()) {
+    // With nothing to flush only wake to check for shutdown
+    double timeout = dirty ? flushInterval : std::max(flushInterval, 0.1);
+    bool haveLine = queue.wait_dequeue_timed(line, timeout * 1e6);
+    unsigned count = 0;
+
+    try {
+      SmartLock lock(&logger.outputLock);
+
+      if (haveLine) {
+        do {
+          if (!line.empty()) {
+            logger.output(line.data(), line.size());
+            written++;
+            count++;
+          }
+        } while (count < maxBatch && queue.try_dequeue(line));
+
+        if (block) {
+          SmartLock spaceLock(&space);
+          space.broadcast();
+        }
+
+        dirty = dirty || count;
+        reportDropped();
+      }
+
+      double now = Timer::now();
+      if (dirty && (flushNow || lastFlush + flushInterval <= now ||
+                    shouldShutdown())) {
+        logger.flush();
+        flushed = written.load();
+        lastFlush = now;
+        dirty = false;
+      }
+
+    } catch (const std::exception &e) {
+      // Logging from here could deadlock a producer waiting for space
+      cerr << "Async log writer: " << e.what() << endl;
+
+      // Do not leave sync() waiting on output which failed
+      flushed = written.load();
+      dirty = false;
+    }
+
+    if (flushNow && !queue.peek()) {
+      flushNow = false;
+      SmartLock lock(&condition);
+      condition.broadcast();
+    }
+  }
+}
@@ -0,0 +1,93 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2021-2026, Cauldron Development  Oy
+                Copyright (c) 2003-2021, Cauldron Development LLC
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#pragma once
+
+#include <cbang/thread/Thread.h>
+#include <cbang/thread/Condition.h>
+
+#include <moodycamel/readerwriterqueue.h>
+
+#include <string>
+#include <atomic>
+#include <cstdint>
+
+
+namespace cb {
+  class Logger;
+
+  /**
+   * Writes log lines from a background thread in batches.
+   *
+   * Lines are queued without locking by the thread currently holding the
+   * Logger lock, so there is only ever one producer.  When the bounded queue
+   * is full lines are either dropped and counted or the producer waits for
+   * space.  Output is flushed at most every flushInterval seconds, unless a
+   * producer calls sync().  Empty lines are ignored.
+   */
+  class AsyncLogWriter : public Thread {
+    Logger &logger;
+    moodycamel::BlockingReaderWriterQueue<std::string> queue;
+    bool block;
+    double flushInterval;
+
+    Condition condition;
+    Condition space;
+    std::atomic<bool> flushNow;
+    std::atomic<uint64_t> queued;
+    std::atomic<uint64_t> written;
+    std::atomic<uint64_t> flushed;
+    std::atomic<uint64_t> dropped;
+    uint64_t reported = 0;
+
+  public:
+    AsyncLogWriter(Logger &logger, unsigned capacity, bool block,
+                   double flushInterval);
+    ~AsyncLogWriter();
+
+    uint64_t getQueued() const {return queued;}
+    uint64_t getWritten() const {return written;}
+    uint64_t getFlushed() const {return flushed;}
+    uint64_t getDropped() const {return dropped;}
+
+    void write(const char *s, unsigned n);
+
+    /// Block until all queued lines have been written and flushed.
+    void sync();
+
+  protected:
+    void reportDropped();
+
+    // From Thread
+    void run() override;
+  };
+}
@@ -39,8 +39,10 @@ using namespace cb;
 
 
 LogDevice::impl::impl(const string &prefix, const string &suffix,
-                      const string &trailer, const string &rateKey) :
-  prefix(prefix), suffix(suffix), trailer(trailer), rateKey(rateKey) {
+                      const string &trailer, const string &rateKey,
+                      bool urgent) :
+  prefix(prefix), suffix(suffix), trailer(trailer), rateKey(rateKey),
+  urgent(urgent) {
   Logger::instance().lock();
 }
 
@@ -112,7 +114,7 @@ bool LogDevice::impl::flush() {
   if (buffer.empty()) return true;
 
   // Write to log
-  Logger::instance().write(buffer);
+  Logger::instance().write(buffer, urgent);
 
   // Flush the buffer
   buffer.clear();
@@ -32,6 +32,7 @@
 
 #include "Logger.h"
 #include "LogStream.h"
+#include "AsyncLogWriter.h"
 
 #include <cbang/config.h>
 #include <cbang/Exception.h>
@@ -46,14 +47,44 @@
 #include <cbang/os/SystemUtilities.h>
 #include <cbang/thread/ThreadLocalStorage.h>
 #include <cbang/config/Options.h>
+#include <cbang/config/OptionActionSet.h>
 #include <cbang/event/Base.h>
 
 #include <iostream>
+#include <algorithm>
 
 using namespace std;
 using namespace cb;
 
 Mutex Logger::mutex;
+atomic<uint32_t> Logger::levelGeneration(1);
+
+
+namespace {
+  template <typename T>
+  class LevelOptionAction : public OptionActionSet<T> {
+  public:
+    LevelOptionAction(T &ref) : OptionActionSet<T>(ref) {}
+
+    // From OptionActionBase
+    int operator()(Option &option) override {
+      OptionActionSet<T>::operator()(option);
+      Logger::levelsChanged();
+      return 0;
+    }
+  };
+
+
+  template <typename T>
+  void addLevelTarget(Options &options, const string &name, T &target,
+                      const string &help) {
+    SmartPointer<OptionActionBase> action = new LevelOptionAction<T>(target);
+    auto option = options.add(name, 0, action, help);
+    option->setDefaultSetAction(action);
+    if (option->hasValue()) (*action)(*option);
+    options.setOptionDefault(*option, target);
+  }
+}
 
 
 Logger::Logger(Inaccessible) :
@@ -68,7 +99,7 @@ Logger::Logger(Inaccessible) :
 }
 
 
-Logger::~Logger() {}
+Logger::~Logger() {stopAsync();}
 
 
 bool Logger::lock(double timeout) const {return mutex.lock(timeout);}
@@ -85,15 +116,17 @@ void Logger::initEvents(Event::Base &base) {
 void Logger::addOptions(Options &options) {
   options.pushCategory("Logging");
   options.add("log", "Set log file.");
-  options.addTarget("verbosity", verbosity, "Set logging level for INFO "
+  addLevelTarget(options, "verbosity", verbosity, "Set logging level for "
+                 "INFO "
 #ifdef DEBUG
-                    "and DEBUG "
+                 "and DEBUG "
 #endif
-                    "messages.");
+                 "messages.");
   options.addTarget("log-crlf", logCRLF, "Print carriage return and line feed "
                     "at end of log lines.");
 #ifdef DEBUG
-  options.addTarget("log-debug", logDebug, "Disable or enable debugging info.");
+  addLevelTarget(options, "log-debug", logDebug,
+                 "Disable or enable debugging info.");
 #endif
   options.addTarget("log-time", logTime,
                     "Print time information with log entries.");
@@ -110,10 +143,10 @@ void Logger::addOptions(Options &options) {
                     "Print thread prefixes, if set, with log entries.");
   options.addTarget("log-domain", logDomain,
                     "Print domain information with log entries.");
-  options.addTarget("log-simple-domains", logSimpleDomains, "Remove any "
-                    "leading directories and trailing file extensions from "
-                    "domains so that source code file names can be easily used "
-                    "as log domains.");
+  addLevelTarget(options, "log-simple-domains", logSimpleDomains, "Remove "
+                 "any leading directories and trailing file extensions from "
+                 "domains so that source code file names can be easily used "
+                 "as log domains.");
   options.add("log-domain-levels", 0, this, &Logger::domainLevelsAction,
               "Set log levels by domain.  Format is:\n"
               "\t<domain>[:i|d|t]:<level> ...\n"
@@ -153,6 +186,17 @@ void Logger::addOptions(Options &options) {
   options.addTarget("log-rotate-period", logRotatePeriod,
                     "Rotate log once every so many seconds.  No periodic "
                     "rotation is performed if zero.");
+  options.addTarget("log-async", logAsync, "Write log output from a "
+                    "background thread.  Log lines are queued and written in "
+                    "batches.");
+  options.addTarget("log-async-queue", logAsyncQueue, "Maximum number of log "
+                    "lines waiting to be written in async mode.");
+  options.addTarget("log-async-block", logAsyncBlock, "In async mode, wait for "
+                    "space when the log queue is full instead of dropping "
+                    "lines.");
+  options.addTarget("log-flush-interval", logFlushInterval, "Maximum time in "
+                    "seconds between log flushes in async mode.  Errors are "
+                    "always flushed immediately.");
   options.popCategory();
 }
 
@@ -169,13 +213,30 @@ void Logger::setScreenStream(ostream &stream) {
 
 
 void Logger::setScreenStream(const SmartPointer<ostream> &stream) {
+  SmartLock lock(&outputLock);
   screenStream = stream;
 }
 
 
+void Logger::addListener(const SmartPointer<LogListener> &l) {
+  SmartLock lock(&outputLock);
+  listeners.insert(l);
+}
+
+
+void Logger::removeListener(const SmartPointer<LogListener> &l) {
+  SmartLock lock(&outputLock);
+  listeners.erase(l);
+}
+
+
 void Logger::startLogFile(const string &filename) {
   SmartLock lock(this);
 
+  // Queued lines belong in the old file
+  if (asyncWriter.isSet()) asyncWriter->sync();
+  SmartLock outLock(&outputLock);
+
   if (logRotate)
     try {
       if (logFile.isSet()) {
@@ -201,6 +262,31 @@ void Logger::restart() {
 }
 
 
+void Logger::setLogAsync(bool x) {
+  SmartLock lock(this);
+  logAsync = x;
+  if (!x) stopAsync();
+}
+
+
+void Logger::setVerbosity(unsigned x) {
+  verbosity = x;
+  levelsChanged();
+}
+
+
+void Logger::setLogDebug(bool x) {
+  logDebug = x;
+  levelsChanged();
+}
+
+
+void Logger::setLogSimpleDomains(bool x) {
+  logSimpleDomains = x;
+  levelsChanged();
+}
+
+
 void Logger::setLogDomainLevels(const string &levels) {
   Option::strings_t entries;
   String::tokenize(levels, entries, ", \t\r\n");
@@ -236,6 +322,14 @@ void Logger::setLogDomainLevels(const string &levels) {
 
     if (invalid) THROW("Invalid log domain level entry '" << entry << "'");
   }
+
+  levelsChanged();
+}
+
+
+uint64_t Logger::getDroppedLines() const {
+  SmartLock lock(this);
+  return asyncWriter.isSet() ? asyncWriter->getDropped() : 0;
 }
 
 
@@ -396,6 +490,7 @@ const char *Logger::endColor(int level) const {
 
 void Logger::writeRates(JSON::Sink &sink) const {
   SmartLock lock(this);
+  SmartLock ratesLock(rates.get());
 
   sink.beginDict();
 
@@ -427,6 +522,20 @@ bool Logger::enabled(const string &domain, int level) const {
 }
 
 
+uint64_t Logger::cacheSite(Site &site, const string &domain) const {
+  // Read the generation first so a concurrent change invalidates the result
+  uint64_t state = (uint64_t)levelGeneration.load() << 32;
+
+  auto clamp = [] (int x) {return (uint16_t)max(-1, min(x, 0x7fff));};
+  state |= (uint64_t)clamp(domainVerbosity(domain, LEVEL_INFO)) << 16;
+  state |= logDebug ? clamp(domainVerbosity(domain, LEVEL_DEBUG)) : 0xffff;
+
+  site.state.store(state, memory_order_release);
+
+  return state;
+}
+
+
 Logger::LogStream Logger::createStream(const string &_domain, int level,
                                        const string &_prefix,
                                        const char *filename, int line) {
@@ -455,8 +564,8 @@ Logger::LogStream Logger::createStream(const string &_domain, int level,
   }
 #endif
 
-  return new cb::LogStream(
-    new cb::LogDevice::impl(prefix, suffix, trailer, rateKey));
+  return new cb::LogStream(new cb::LogDevice::impl(
+    prefix, suffix, trailer, rateKey, (level & LEVEL_MASK) == LEVEL_ERROR));
 }
 
 
@@ -471,15 +580,46 @@ void Logger::logBar(const string &msg, uint64_t ts) const {
 }
 
 
-void Logger::write(const char *s, streamsize n) {
-  if (!logFile.isNull()) {logFile->write(s, n); logFileCount++;}
-  if (logToScreen && !screenStream.isNull()) screenStream->write(s, n);
-  for (auto &l: listeners) TRY_CATCH_ERROR(l->write(s, n));
+void Logger::write(const char *s, streamsize n, bool urgent) {
+  if (!logFile.isNull()) logFileCount++;
+
+  if (logAsync) {
+    if (asyncWriter.isNull()) {
+      asyncWriter = new AsyncLogWriter(
+        *this, logAsyncQueue, logAsyncBlock, logFlushInterval);
+      asyncWriter->start();
+    }
+
+    asyncWriter->write(s, n);
+    if (urgent) asyncWriter->sync();
+    return;
+  }
+
+  stopAsync(); // Async mode was turned off
+
+  SmartLock lock(&outputLock);
+  output(s, n);
   flush();
 }
 
 
-void Logger::write(const string &s) {write(s.data(), s.length());}
+void Logger::write(const string &s, bool urgent) {
+  write(s.data(), s.length(), urgent);
+}
+
+
+void Logger::output(const char *s, streamsize n) {
+  if (!logFile.isNull()) logFile->write(s, n);
+  if (logToScreen && !screenStream.isNull()) screenStream->write(s, n);
+
+  for (auto &l: listeners)
+    try {
+      l->write(s, n);
+    } catch (const std::exception &e) {
+      // Logging this could recurse or deadlock the async writer
+      cerr << "Log listener failed: " << e.what() << endl;
+    }
+}
 
 
 bool Logger::flush() {
@@ -489,6 +629,13 @@ bool Logger::flush() {
 }
 
 
+void Logger::stopAsync() {
+  if (asyncWriter.isNull()) return;
+  asyncWriter->join(); // Writes any queued lines
+  asyncWriter.release();
+}
+
+
 void Logger::rotate() {
   if (firstRotate) firstRotate = false;
   else if (logFileCount) startLogFile(logFilename);
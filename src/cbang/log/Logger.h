@@ -41,6 +41,7 @@
 #include <cbang/util/Singleton.h>
 #include <cbang/comp/Compression.h>
 #include <cbang/thread/Lockable.h>
+#include <cbang/thread/Mutex.h>
 #include <cbang/event/Event.h>
 
 #include <ostream>
@@ -48,6 +49,7 @@
 #include <map>
 #include <set>
 #include <vector>
+#include <atomic>
 
 
 namespace cb {
@@ -55,7 +57,7 @@ namespace cb {
   class Options;
   class CommandLine;
   class RateSet;
-  class Mutex;
+  class AsyncLogWriter;
   template <typename T> class ThreadLocalStorage;
 
   namespace JSON {class Sink;}
@@ -78,8 +80,12 @@ namespace cb {
       LEVEL_MASK    = (1 << 4) - 1
     };
 
+    /// Cached INFO and DEBUG verbosity of a single log call site
+    struct Site {std::atomic<uint64_t> state = {0};};
+
   private:
     static Mutex mutex;
+    static std::atomic<uint32_t> levelGeneration;
     std::string logFilename;
 
 #ifdef CBANG_DEBUG_LEVEL
@@ -113,6 +119,10 @@ namespace cb {
     std::string logRotateDir        = "logs";
     uint32_t    logRotatePeriod     = 0;
     unsigned    logRates            = 0;
+    bool        logAsync            = false;
+    unsigned    logAsyncQueue       = 65536;
+    bool        logAsyncBlock       = false;
+    double      logFlushInterval    = 1;
 
     SmartPointer<RateSet> rates;
     std::map<std::string, std::string> rateMessages;
@@ -120,9 +130,11 @@ namespace cb {
     SmartPointer<ThreadLocalStorage<unsigned>> threadIDStorage;
     SmartPointer<ThreadLocalStorage<std::string>> prefixStorage;
 
+    Mutex outputLock;
     SmartPointer<std::ostream> logFile;
     SmartPointer<std::ostream> screenStream;
     std::set<SmartPointer<LogListener>> listeners;
+    SmartPointer<AsyncLogWriter> asyncWriter;
 
     mutable unsigned idWidth = 1;
 
@@ -161,13 +173,12 @@ namespace cb {
     void setScreenStream(std::ostream &stream);
     void setScreenStream(const SmartPointer<std::ostream> &stream);
 
-    void addListener(const SmartPointer<LogListener> &l)
-      {listeners.insert(l);}
-    void removeListener(const SmartPointer<LogListener> &l)
-      {listeners.erase(l);}
+    /// In async mode listeners are called from the log writer thread
+    void addListener(const SmartPointer<LogListener> &l);
+    void removeListener(const SmartPointer<LogListener> &l);
 
-    void setVerbosity(unsigned x)       {verbosity        = x;}
-    void setLogDebug(bool x)            {logDebug         = x;}
+    void setVerbosity(unsigned x);
+    void setLogDebug(bool x);
     void setLogCRLF(bool x)             {logCRLF          = x;}
     void setLogTime(bool x)             {logTime          = x;}
     void setLogDate(bool x)             {logDate          = x;}
@@ -175,7 +186,7 @@ namespace cb {
     void setLogLevel(bool x)            {logLevel         = x;}
     void setLogPrefix(bool x)           {logPrefix        = x;}
     void setLogDomain(bool x)           {logDomain        = x;}
-    void setLogSimpleDomains(bool x)    {logSimpleDomains = x;}
+    void setLogSimpleDomains(bool x);
     void setLogThreadID(bool x)         {logThreadID      = x;}
     void setLogNoInfoHeader(bool x)     {logNoInfoHeader  = x;}
     void setLogHeader(bool x)           {logHeader        = x;}
@@ -186,10 +197,18 @@ namespace cb {
     void setLogRotateMax(unsigned x)    {logRotateMax     = x;}
     void setLogRotatePeriod(uint32_t x) {logRotatePeriod  = x;}
     void setLogRates(unsigned x)        {logRates         = x;}
+    void setLogAsync(bool x);
+    void setLogAsyncQueue(unsigned x)   {logAsyncQueue    = x;}
+    void setLogAsyncBlock(bool x)       {logAsyncBlock    = x;}
+    void setLogFlushInterval(double x)  {logFlushInterval = x;}
     void setLogDomainLevels(const std::string &levels);
+    /// Invalidates cached call site levels, call after changing verbosity
+    static void levelsChanged() {levelGeneration++;}
 
     unsigned getVerbosity() const {return verbosity;}
     bool getLogCRLF() const {return logCRLF;}
+    bool getLogAsync() const {return logAsync;}
+    uint64_t getDroppedLines() const;
     unsigned getHeaderWidth() const;
     const SmartPointer<RateSet> &getRates() const {return rates;}
 
@@ -209,22 +228,40 @@ namespace cb {
 
     // These functions should not be called directly.  Use the macros.
     bool enabled(const std::string &domain, int level) const;
+
+    template <typename T>
+    static bool enabled(Site &site, const T &domain, int level) {
+      // Raw, error and warning messages are always enabled
+      if ((level & LEVEL_MASK) < LEVEL_INFO) return true;
+
+      uint64_t state = site.state.load(std::memory_order_acquire);
+      if ((uint32_t)(state >> 32) != levelGeneration.load())
+        state = instance().cacheSite(site, domain);
+
+      int verbosity = (int16_t)(state >> (level & LEVEL_DEBUG ? 0 : 16));
+      return (level >> 8) <= verbosity;
+    }
+
     typedef SmartPointer<std::ostream> LogStream;
     LogStream createStream(const std::string &domain, int level,
                            const std::string &prefix = std::string(),
                            const char *filename = 0, int line = 0);
 
   protected:
+    uint64_t cacheSite(Site &site, const std::string &domain) const;
     void rateMessage(const std::string &key, const std::string &msg);
     void logBar(const std::string &msg, uint64_t ts) const;
-    void write(const char *s, std::streamsize n);
-    void write(const std::string &s);
+    void write(const char *s, std::streamsize n, bool urgent = false);
+    void write(const std::string &s, bool urgent = false);
+    void output(const char *s, std::streamsize n);
     bool flush();
+    void stopAsync();
 
     void rotate();
     void date();
 
     friend class LogDevice;
+    friend class AsyncLogWriter;
   };
 }
 
@@ -247,14 +284,23 @@ namespace cb {
 // Check if logging level is enabled
 #define CBANG_LOG_ENABLED(domain, level)                        \
   cb::Logger::instance().enabled(domain, level)
+
+// Same as above for CBANG_LOG_DOMAIN but cached per call site.  The cache is
+// only updated when the log configuration changes so CBANG_LOG_DOMAIN must
+// not vary at a single call site.
+#define CBANG_LOG_SITE_ENABLED(level)                                   \
+  cb::Logger::enabled(                                                  \
+    [] () -> cb::Logger::Site & {static cb::Logger::Site s; return s;}(), \
+    CBANG_LOG_DOMAIN, level)
+
 #ifdef DEBUG
 #define CBANG_LOG_DEBUG_ENABLED(x)                              \
-  CBANG_LOG_ENABLED(CBANG_LOG_DOMAIN, CBANG_LOG_DEBUG_LEVEL(x))
+  CBANG_LOG_SITE_ENABLED(CBANG_LOG_DEBUG_LEVEL(x))
 #else
 #define CBANG_LOG_DEBUG_ENABLED(x) false
 #endif
 #define CBANG_LOG_INFO_ENABLED(x)                               \
-  CBANG_LOG_ENABLED(CBANG_LOG_DOMAIN, CBANG_LOG_INFO_LEVEL(x))
+  CBANG_LOG_SITE_ENABLED(CBANG_LOG_INFO_LEVEL(x))
 
 
 // Create logger streams
@@ -290,10 +336,15 @@ namespace cb {
 #define CBANG_LOG(domain, level, msg)                           \
   CBANG_LOG_LOCATION(domain, level, msg, __FILE__, __LINE__)
 
-#define CBANG_LOG_LEVEL_LOCATION(level, msg, file, line)        \
-  CBANG_LOG_LOCATION(CBANG_LOG_DOMAIN, level, msg, file, line)
+#define CBANG_LOG_LEVEL_LOCATION(level, msg, file, line)                 \
+  do {                                                                  \
+    if (CBANG_LOG_SITE_ENABLED(level))                                  \
+      *CBANG_LOG_STREAM_LOCATION(CBANG_LOG_DOMAIN, level, file, line)   \
+        << msg;                                                         \
+  } while (false)
 
-#define CBANG_LOG_LEVEL(level, msg) CBANG_LOG(CBANG_LOG_DOMAIN, level, msg)
+#define CBANG_LOG_LEVEL(level, msg)                             \
+  CBANG_LOG_LEVEL_LOCATION(level, msg, __FILE__, __LINE__)
 
 #define CBANG_LOG_RAW(msg)      CBANG_LOG_LEVEL(CBANG_LOG_RAW_LEVEL,     msg)
 #define CBANG_LOG_ERROR(msg)    CBANG_LOG_LEVEL(CBANG_LOG_ERROR_LEVEL,   msg)
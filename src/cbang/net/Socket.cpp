@@ -138,6 +138,23 @@ void Socket::setReuseAddr(bool reuse) {
 }
 
 
+void Socket::setReusePort(bool reuse) {
+  assertOpen();
+
+#ifdef SO_REUSEPORT
+  int opt = reuse;
+
+  SysError::clear();
+  if (setsockopt((socket_t)socket, SOL_SOCKET, SO_REUSEPORT, (char *)&opt,
+                 sizeof(opt)))
+    THROW("Failed to set reuse port: " << SysError());
+
+#else
+  if (reuse) THROW("SO_REUSEPORT not supported");
+#endif
+}
+
+
 void Socket::setBlocking(bool blocking) {
   assertOpen();
 
@@ -277,6 +294,7 @@ void Socket::open(unsigned flags, const SockAddr &bindAddr) {
   if (  flags & Socket::NONBLOCKING)    setBlocking(false);
   if (!(flags & Socket::NOCLOSEONEXEC)) setCloseOnExec(true);
   if (  flags & Socket::REUSEADDR)      setReuseAddr(true);
+  if (  flags & Socket::REUSEPORT)      setReusePort(true);
   if (  flags & Socket::KEEPALIVE)      setKeepAlive(true);
 
   if (!bindAddr.isNull()) bind(bindAddr);
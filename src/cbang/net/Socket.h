@@ -79,6 +79,7 @@ namespace cb {
       REUSEADDR     = 1 << 6,
       KEEPALIVE     = 1 << 7,
       UNIX          = 1 << 8, ///< Create an AF_UNIX (Unix domain) socket
+      REUSEPORT     = 1 << 9, ///< Share the port between listening sockets
     };
 
 
@@ -96,6 +97,7 @@ namespace cb {
     bool canWrite(double timeout = 0) const;
 
     void setReuseAddr(bool reuse);
+    void setReusePort(bool reuse);
     void setBlocking(bool blocking);
     bool getBlocking() const {return blocking;}
     void setCloseOnExec(bool closeOnExec);
@@ -123,6 +123,15 @@ bool cb::SSL::wantsRead()  const {return lastErr == SSL_ERROR_WANT_READ;}
 bool cb::SSL::wantsWrite() const {return lastErr == SSL_ERROR_WANT_WRITE;}
 
 
+bool cb::SSL::isKTLSSend() const {
+#ifdef BIO_get_ktls_send
+  return BIO_get_ktls_send(SSL_get_wbio(ssl));
+#else
+  return false;
+#endif
+}
+
+
 void cb::SSL::setCipherList(const string &list) {
   if (!SSL_set_cipher_list(ssl, list.c_str()))
     THROW("Failed to set cipher list to: " << list << ": " << getErrorStr());
@@ -80,6 +80,7 @@ namespace cb {
 
     bool wantsRead() const;
     bool wantsWrite() const;
+    bool isKTLSSend() const; // Kernel encrypts outgoing records
 
     void setCipherList(const std::string &list);
 
@@ -0,0 +1,163 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2021-2026, Cauldron Development  Oy
+                Copyright (c) 2003-2021, Cauldron Development LLC
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+
+#include "Arena.h"
+
+#include <new>
+#include <cstdlib>
+
+using namespace cb;
+
+
+namespace {
+  struct BlockCache {
+    static const unsigned MAX_BLOCKS = 64;
+
+    void *head = 0;
+    unsigned count = 0;
+
+
+    ~BlockCache() {
+      while (head) {
+        void *next = *(void **)head;
+        free(head);
+        head = next;
+      }
+
+      count = MAX_BLOCKS; // Free anything returned during thread exit
+    }
+  };
+
+
+  thread_local BlockCache cache;
+
+
+  char *alignUp(char *ptr, size_t align) {
+    return (char *)(((uintptr_t)ptr + align - 1) & ~(uintptr_t)(align - 1));
+  }
+}
+
+
+Arena::Arena() :
+  start(alignUp((char *)this + sizeof(Arena), alignof(std::max_align_t))),
+  ptr(start), end((char *)this + BLOCK_SIZE) {}
+
+
+Arena::~Arena() {reset();}
+
+
+SmartPointer<Arena> Arena::create() {return ::new (getBlock()) Arena;}
+
+
+unsigned Arena::getBlockCount() const {
+  unsigned count = 1;
+  for (Chunk *b = blocks; b; b = b->next) count++;
+  return count;
+}
+
+
+void *Arena::allocate(size_t size, size_t align) {
+  allocations++;
+  bytes += size;
+
+  char *p = alignUp(ptr, align);
+  if (size <= (size_t)(end - p)) {
+    ptr = p + size;
+    return p;
+  }
+
+  // Large allocations get their own chunk so they do not waste a block
+  if (BLOCK_SIZE / 4 < size + align) {
+    Chunk *c = (Chunk *)malloc(sizeof(Chunk) + align + size);
+    if (!c) throw std::bad_alloc();
+    c->next = large;
+    large = c;
+    return alignUp((char *)(c + 1), align);
+  }
+
+  Chunk *b = (Chunk *)getBlock();
+  b->next = blocks;
+  blocks = b;
+
+  p = alignUp((char *)(b + 1), align);
+  ptr = p + size;
+  end = (char *)b + BLOCK_SIZE;
+
+  return p;
+}
+
+
+void Arena::reset() {
+  while (blocks) {
+    Chunk *next = blocks->next;
+    putBlock(blocks);
+    blocks = next;
+  }
+
+  while (large) {
+    Chunk *next = large->next;
+    free(large);
+    large = next;
+  }
+
+  ptr = start;
+  end = (char *)this + BLOCK_SIZE;
+  allocations = 0;
+  bytes = 0;
+}
+
+
+void Arena::operator delete(void *ptr) {putBlock(ptr);}
+
+
+void *Arena::getBlock() {
+  void *block = cache.head;
+
+  if (block) {
+    cache.head = *(void **)block;
+    cache.count--;
+    return block;
+  }
+
+  if (!(block = malloc(BLOCK_SIZE))) throw std::bad_alloc();
+  return block;
+}
+
+
+void Arena::putBlock(void *block) {
+  if (BlockCache::MAX_BLOCKS <= cache.count) return free(block);
+
+  *(void **)block = cache.head;
+  cache.head = block;
+  cache.count++;
+}
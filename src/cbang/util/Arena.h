@@ -0,0 +1,128 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2021-2026, Cauldron Development  Oy
+                Copyright (c) 2003-2021, Cauldron Development LLC
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+
+#pragma once
+
+#include <cbang/SmartPointer.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+
+namespace cb {
+  /**
+   * A bump allocator for short lived objects which die together, such as the
+   * parts of an HTTP request.  Memory is handed out from fixed size blocks and
+   * only released all at once, by reset() or when the last reference to the
+   * Arena goes away.  Blocks are recycled through a small per thread cache so
+   * steady state use does not touch malloc.
+   *
+   * An Arena is not thread safe.  It must only be used by one thread at a
+   * time.
+   */
+  class Arena : public RefCounted {
+  public:
+    static const unsigned BLOCK_SIZE = 4096;
+
+  protected:
+    struct Chunk {Chunk *next;};
+
+    Chunk *blocks = 0; // Blocks after the first
+    Chunk *large  = 0; // Allocations too big for a block
+    char *start;
+    char *ptr;
+    char *end;
+
+    unsigned allocations = 0;
+    uint64_t bytes = 0;
+
+    Arena();
+
+  public:
+    ~Arena();
+
+    static SmartPointer<Arena> create();
+
+    unsigned getAllocations() const {return allocations;}
+    uint64_t getBytes() const {return bytes;}
+    unsigned getBlockCount() const;
+
+    void *allocate(size_t size, size_t align = alignof(std::max_align_t));
+    void reset();
+
+    static void operator delete(void *ptr);
+
+  protected:
+    static void *getBlock();
+    static void putBlock(void *block);
+  };
+
+
+  /// An STL allocator which takes its memory from an Arena.  The allocator
+  /// holds a reference so the memory outlives any container using it.
+  /// Without an Arena it falls back to the global heap.
+  template <typename T>
+  class ArenaAllocator {
+  public:
+    typedef T value_type;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    SmartPointer<Arena> arena;
+
+    ArenaAllocator(const SmartPointer<Arena> &arena = 0) : arena(arena) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &o) : arena(o.arena) {}
+
+
+    T *allocate(size_t n) {
+      if (arena.isNull()) return (T *)::operator new(n * sizeof(T));
+      return (T *)arena->allocate(n * sizeof(T), alignof(T));
+    }
+
+
+    void deallocate(T *ptr, size_t n) {
+      if (arena.isNull()) ::operator delete(ptr);
+    }
+
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U> &o) const
+      {return arena.get() == o.arena.get();}
+
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U> &o) const {return !(*this == o);}
+  };
+}
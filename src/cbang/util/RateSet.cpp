@@ -33,6 +33,8 @@
 #include "RateSet.h"
 #include "RateCollectionNS.h"
 
+#include <cbang/thread/SmartLock.h>
+
 using namespace std;
 using namespace cb;
 
@@ -55,7 +57,33 @@ const Rate &RateSet::getRate(const std::string &key) const {
 }
 
 
+void RateSet::reset() {
+  SmartLock lock(this);
+  for (auto &p: rates) p.second.reset();
+}
+
+
+bool RateSet::has(const string &key) const {
+  SmartLock lock(this);
+  return rates.find(key) != rates.end();
+}
+
+
+double RateSet::get(const string &key, uint64_t now) const {
+  SmartLock lock(this);
+  return getRate(key).get(now);
+}
+
+
+void RateSet::event(const string &key, double value, uint64_t now) {
+  SmartLock lock(this);
+  getRate(key).event(value, now);
+}
+
+
 void RateSet::insert(JSON::Sink &sink, bool withTotals) const {
+  SmartLock lock(this);
+
   for (auto &p: *this)
     if (!withTotals) sink.insert(p.first, p.second.get());
     else {
@@ -38,14 +38,17 @@
 #include <cbang/Exception.h>
 #include <cbang/json/Serializable.h>
 #include <cbang/json/Sink.h>
+#include <cbang/thread/Mutex.h>
 
 #include <string>
 #include <map>
 
 
 namespace cb {
-  class RateSet :
-    public RateCollection, public JSON::Serializable, public RefCounted {
+  /// Events and the readers below may come from different threads.  Callers
+  /// which iterate or hold a Rate from getRate() should hold the lock.
+  class RateSet : public RateCollection, public JSON::Serializable,
+    public RefCounted, public Mutex {
     const unsigned size;
     const unsigned period;
 
@@ -61,18 +64,13 @@ namespace cb {
     Rate &getRate(const std::string &key);
     const Rate &getRate(const std::string &key) const;
 
-    void reset() {for (auto &p: rates)p.second.reset();}
-
-    bool has(const std::string &key) const
-    {return rates.find(key) != rates.end();}
-
-    double get(const std::string &key, uint64_t now = Time::now()) const
-    {return getRate(key).get(now);}
+    void reset();
+    bool has(const std::string &key) const;
+    double get(const std::string &key, uint64_t now = Time::now()) const;
 
     // From RateCollection
     void event(const std::string &key, double value = 1,
-      uint64_t now = Time::now()) override
-    {getRate(key).event(value, now);}
+      uint64_t now = Time::now()) override;
 
     typedef rates_t::const_iterator iterator;
     iterator begin() const {return rates.begin();}
@@ -34,7 +34,11 @@
 
 #include <cbang/Catch.h>
 #include <cbang/log/Logger.h>
-#include <cbang/io/VectorStream.h>
+#include <cbang/json/BufferReader.h>
+#include <cbang/json/CBORWriter.h>
+#include <cbang/json/CBORReader.h>
+#include <cbang/json/MessagePackWriter.h>
+#include <cbang/json/MessagePackReader.h>
 
 
 using namespace cb;
@@ -45,16 +49,21 @@ using namespace std;
 #define CBANG_LOG_PREFIX "WS" << getID() << ':'
 
 
-void JSONWebsocket::send(function<void (JSON::Sink &sink)> cb) {
-  VectorStream<> stream(msgBuf);
-  JSON::Writer writer(stream, 0, true);
+namespace {
+  template <typename T>
+  void serialize(T &&writer, const function<void (JSON::Sink &sink)> &cb) {
+    cb(writer);
+    writer.close();
+  }
+}
 
-  cb(writer);
 
-  writer.close();
-  stream.flush();
-  Websocket::send(msgBuf.data(), msgBuf.size());
+void JSONWebsocket::send(function<void (JSON::Sink &sink)> cb) {
   msgBuf.clear();
+  encode(format, msgBuf, cb);
+
+  OpCode opcode = format == FORMAT_JSON ? WS_OP_TEXT : WS_OP_BINARY;
+  Websocket::send(msgBuf.data(), msgBuf.size(), opcode);
 }
 
 
@@ -64,8 +73,37 @@ void JSONWebsocket::send(const JSON::Value &value) {
 }
 
 
+void JSONWebsocket::encode(format_t format, string &output,
+                           function<void (JSON::Sink &sink)> cb) {
+  switch (format) {
+  case FORMAT_JSON: return serialize(JSON::StringWriter(output, 0, true), cb);
+  case FORMAT_CBOR: return serialize(JSON::CBORWriter(output), cb);
+  case FORMAT_MSGPACK: return serialize(JSON::MessagePackWriter(output), cb);
+  }
+}
+
+
+bool JSONWebsocket::acceptProtocol(const string &protocol) {
+  if      (protocol == "json")    format = FORMAT_JSON;
+  else if (protocol == "cbor")    format = FORMAT_CBOR;
+  else if (protocol == "msgpack") format = FORMAT_MSGPACK;
+  else return false;
+
+  return true;
+}
+
+
 void JSONWebsocket::onMessage(const char *data, uint64_t length) {
-  auto value = JSON::Reader::parse(InputSource(data, length));
+  JSON::ValuePtr value;
+
+  if (getMessageOpCode() != WS_OP_BINARY)
+    value = JSON::BufferReader::parse(data, length);
+  else if (format == FORMAT_CBOR)
+    value = JSON::CBORReader(data, length).parse();
+  else if (format == FORMAT_MSGPACK)
+    value = JSON::MessagePackReader(data, length).parse();
+  else THROW("Binary message without a binary subprotocol");
+
   LOG_DEBUG(6, "Received: " << *value);
   onMessage(value);
 }
@@ -37,23 +37,41 @@
 #include <cbang/json/JSON.h>
 
 #include <functional>
-#include <vector>
+#include <string>
 
 
 namespace cb {
   namespace WS {
+    /// Sends and receives JSON messages.  Clients which request the ``cbor``
+    /// or ``msgpack`` subprotocol exchange binary frames in that encoding
+    /// instead of JSON text.  Text frames are always read as JSON.
     class JSONWebsocket : public Websocket {
-      std::vector<char> msgBuf;
+    public:
+      typedef enum {
+        FORMAT_JSON,    // Text frames, subprotocol "json" or none
+        FORMAT_CBOR,    // Binary frames, subprotocol "cbor"
+        FORMAT_MSGPACK, // Binary frames, subprotocol "msgpack"
+      } format_t;
+
+    private:
+      format_t format = FORMAT_JSON;
+      std::string msgBuf;
 
     public:
       using Websocket::Websocket;
 
+      format_t getFormat() const {return format;}
+
       void send(std::function<void (JSON::Sink &sink)> cb);
       virtual void send(const JSON::Value &msg);
 
+      static void encode(format_t format, std::string &output,
+                         std::function<void (JSON::Sink &sink)> cb);
+
       virtual void onMessage(const JSON::ValuePtr &msg) = 0;
 
       // From Websocket
+      bool acceptProtocol(const std::string &protocol) override;
       void onMessage(const char *data, uint64_t length) override;
 
     protected:
@@ -0,0 +1,101 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2021-2026, Cauldron Development  Oy
+                Copyright (c) 2003-2021, Cauldron Development LLC
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include "Mask.h"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CBANG_WS_SSE2
+#endif
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__aarch64__)
+#include <arm_neon.h>
+#define CBANG_WS_NEON
+#endif
+
+
+void cb::WS::mask(void *_data, uint64_t length, const uint8_t key[4],
+                  uint64_t offset) {
+  uint8_t *data = (uint8_t *)_data;
+
+  // Rotate the key to line up with the start of data
+  uint8_t k[4];
+  for (unsigned i = 0; i < 4; i++) k[i] = key[(offset + i) & 3];
+
+  uint32_t k32;
+  memcpy(&k32, k, 4);
+
+  // Each step below works in multiples of 4 bytes so the key stays aligned
+  uint64_t i = 0;
+
+#ifdef __AVX2__
+  const __m256i k256 = _mm256_set1_epi32(k32);
+
+  for (; i + 32 <= length; i += 32) {
+    __m256i *p = (__m256i *)(data + i);
+    _mm256_storeu_si256(p, _mm256_xor_si256(_mm256_loadu_si256(p), k256));
+  }
+#endif
+
+#if defined(CBANG_WS_SSE2)
+  const __m128i k128 = _mm_set1_epi32(k32);
+
+  for (; i + 16 <= length; i += 16) {
+    __m128i *p = (__m128i *)(data + i);
+    _mm_storeu_si128(p, _mm_xor_si128(_mm_loadu_si128(p), k128));
+  }
+
+#elif defined(CBANG_WS_NEON)
+  const uint8x16_t k128 = vreinterpretq_u8_u32(vdupq_n_u32(k32));
+
+  for (; i + 16 <= length; i += 16)
+    vst1q_u8(data + i, veorq_u8(vld1q_u8(data + i), k128));
+#endif
+
+  // Scalar fallback, a word at a time
+  const uint64_t k64 = (uint64_t)k32 << 32 | k32;
+
+  for (; i + 8 <= length; i += 8) {
+    uint64_t x;
+    memcpy(&x, data + i, 8);
+    x ^= k64;
+    memcpy(data + i, &x, 8);
+  }
+
+  for (; i < length; i++) data[i] ^= k[i & 3];
+}
@@ -31,6 +31,7 @@
 \******************************************************************************/
 
 #include "Websocket.h"
+#include "Mask.h"
 
 #include <cbang/Catch.h>
 #include <cbang/net/Swab.h>
@@ -46,6 +47,7 @@
 #endif
 
 #include <cstring> // memcpy()
+#include <algorithm>
 
 #undef CBANG_LOG_PREFIX
 #define CBANG_LOG_PREFIX "WS" << getID() << ':'
@@ -68,7 +70,25 @@ SmartPointer<HTTP::Conn> Websocket::connect(
     auto error = req.getConnectionError();
 
     if (error == CONN_ERR_OK && code == HTTP_SWITCHING_PROTOCOLS) {
+      // The server may only choose a subprotocol that was requested
+      string chosen = req.inFind("Sec-WebSocket-Protocol");
+
+      if (!chosen.empty()) {
+        vector<string> requested;
+        String::tokenize(protocols, requested, ", ");
+
+        if (find(requested.begin(), requested.end(), chosen) ==
+            requested.end() || !acceptProtocol(chosen)) {
+          onClose(WS_STATUS_PROTOCOL, "Unexpected protocol: " + chosen);
+          connection.release();
+          return;
+        }
+      }
+
+      protocol = chosen;
+
       LOG_DEBUG(4, "Opened new Websocket: " << getID());
+      input.add(req.getInputBuffer()); // Frames sent with the response
       start();
 
     } else {
@@ -88,6 +108,7 @@ SmartPointer<HTTP::Conn> Websocket::connect(
   req->outSet("Sec-WebSocket-Version", "13");
   req->outSet("Upgrade",               "websocket");
   req->outSet("Connection",            "upgrade");
+  if (!protocols.empty()) req->outSet("Sec-WebSocket-Protocol", protocols);
 
   auto con   = client.send(req);
   connection = con;
@@ -95,13 +116,13 @@ SmartPointer<HTTP::Conn> Websocket::connect(
 }
 
 
-void Websocket::send(const char *data, unsigned length) {
+void Websocket::send(const char *data, unsigned length, OpCode opcode) {
   const unsigned frameSize = 0xffff;
 
   for (unsigned i = 0; length; i += frameSize) {
     unsigned bytes = frameSize < length ? frameSize : length;
     length -= bytes;
-    writeFrame(i ? WS_OP_CONTINUE : WS_OP_TEXT, !length, data + i, bytes);
+    writeFrame(i ? (OpCode)WS_OP_CONTINUE : opcode, !length, data + i, bytes);
   }
 
   msgSent++;
@@ -111,6 +132,58 @@ void Websocket::send(const char *data, unsigned length) {
 void Websocket::send(const string &s) {send(s.data(), s.length());}
 
 
+bool Websocket::sendFrames(const Event::Buffer &frames) {
+  // Pre-framed messages are shared so they cannot carry a client mask
+  if (connection.isSet() && !connection->isIncoming())
+    THROW("Pre-framed messages can only be sent to clients");
+
+  if (maxQueued && maxQueued <= bytesQueued) {
+    msgDropped++;
+    LOG_DEBUG(4, "Output queue full, " << bytesQueued << " bytes queued");
+
+    if (overflow == OVERFLOW_CLOSE)
+      close(WS_STATUS_VIOLATION, "Output queue full");
+
+    return false;
+  }
+
+  // Reference the shared frames rather than copying them.  The FD pool thread
+  // drops the reference so the frames buffer must have locking enabled.
+  Event::Buffer out;
+  out.addRef(frames);
+  write(out, WS_OP_TEXT);
+  msgSent++;
+
+  return true;
+}
+
+
+Event::Buffer Websocket::frame(
+  const char *data, unsigned length, OpCode opcode) {
+  const unsigned frameSize = 0xffff;
+
+  Event::Buffer out;
+  out.expand(length + (length / frameSize + 1) * 4);
+
+  for (unsigned i = 0; length; i += frameSize) {
+    unsigned bytes = frameSize < length ? frameSize : length;
+    length -= bytes;
+
+    uint8_t header[14];
+    OpCode op = i ? (OpCode)WS_OP_CONTINUE : opcode;
+    out.add((char *)header, writeHeader(header, op, !length, bytes));
+    out.add(data + i, bytes);
+  }
+
+  return out;
+}
+
+
+Event::Buffer Websocket::frame(const string &s, OpCode opcode) {
+  return frame(s.data(), s.length(), opcode);
+}
+
+
 void Websocket::close(Status status, const string &msg) {
   LOG_DEBUG(4, CBANG_FUNC << '(' << status << ", " << msg << ')');
 
@@ -160,15 +233,26 @@ void Websocket::upgrade(HTTP::Request &req) {
     HTTP_NOT_IMPLEMENTED);
 #endif
 
+  // Choose the first requested subprotocol that is supported
+  vector<string> offered;
+  String::tokenize(req.inFind("Sec-WebSocket-Protocol"), offered, ", ");
+  for (auto &name: offered)
+    if (acceptProtocol(name)) {
+      protocol = name;
+      break;
+    }
+
   // Respond
   req.setVersion(Version(1, 1));
   req.outSet("Upgrade", "websocket");
   req.outSet("Connection", "upgrade");
   req.outSet("Sec-WebSocket-Accept", key);
+  if (!protocol.empty()) req.outSet("Sec-WebSocket-Protocol", protocol);
   req.reply(HTTP_SWITCHING_PROTOCOLS);
 
   connection = req.getConnection();
   id         = connection->getID();
+  input.add(connection->getInput()); // Frames sent with the request
   auto cb = [this] {
     SmartPointer<Websocket> self = this;
     connection.release();
@@ -180,127 +264,177 @@ void Websocket::upgrade(HTTP::Request &req) {
 }
 
 
-void Websocket::readHeader() {
-  auto cb = [this] (bool success) {
-    if (!success)
-      return close(WS_STATUS_PROTOCOL, "Failed to read header start");
+void Websocket::readFrames() {
+  SmartPointer<Websocket> self = this; // Callbacks may release this
 
-    uint8_t header[2];
-    input.copy((char *)header, 2);
+  // Decode every frame already buffered before reading again
+  while (isActive()) {
+    if (!headerSize) {
+      unsigned bytes = readHeader();
+      if (!isActive()) return;
+      if (bytes) return readMore(bytes);
+    }
 
-    // Client must set mask bit
-    bool mask = header[1] & (1 << 7);
-    if (mask != connection->isIncoming())
-      return close(WS_STATUS_PROTOCOL, "Header mask mismatch");
+    uint64_t frameSize = headerSize + bytesToRead;
+    if (input.getLength() < frameSize) return readMore(frameSize);
 
-    // Compute header size
-    uint8_t bytes = mask ? 6 : 2;
-    uint8_t size = header[1] & 0x7f;
-    if (size == 126) bytes += 2;
-    if (size == 127) bytes += 8;
+    input.drain(headerSize);
+    headerSize = 0;
+    readBody();
+  }
+}
 
-    auto cb = [this, mask, bytes, size] (bool success) {
-      if (!success)
-        return close(WS_STATUS_PROTOCOL, "Failed to read header end");
 
-      uint8_t header[14];
-      input.remove((char *)header, bytes);
+unsigned Websocket::readHeader() {
+  // Returns the number of bytes needed or zero if the header was decoded
+  unsigned length = input.getLength();
+  if (length < 2) return 2;
 
-      // Compute frame size
-      if      (size == 126) bytesToRead = hton16((uint16_t &)header[2]);
-      else if (size == 127) bytesToRead = hton64((uint64_t &)header[2]);
-      else                  bytesToRead = size;
-      if (bytesToRead & (1ULL << 63))
-        return close(WS_STATUS_PROTOCOL, "Invalid frame size");
+  uint8_t header[14];
+  input.copy((char *)header, length < 14 ? length : 14);
 
-      // Check opcode
-      wsOpCode = (OpCode::enum_t)(header[0] & 0xf);
+  // Client must set mask bit
+  bool mask = header[1] & (1 << 7);
+  if (mask != connection->isIncoming()) {
+    close(WS_STATUS_PROTOCOL, "Header mask mismatch");
+    return 0;
+  }
 
-      LOG_DEBUG(4, CBANG_FUNC << "() opcode=" << wsOpCode
-                << " bytes=" << bytesToRead);
+  // Compute header size
+  unsigned bytes = mask ? 6 : 2;
+  uint8_t size = header[1] & 0x7f;
+  if (size == 126) bytes += 2;
+  if (size == 127) bytes += 8;
+  if (length < bytes) return bytes;
+
+  // Compute frame size
+  if      (size == 126) bytesToRead = hton16((uint16_t &)header[2]);
+  else if (size == 127) bytesToRead = hton64((uint64_t &)header[2]);
+  else                  bytesToRead = size;
+  if (bytesToRead & (1ULL << 63)) {
+    close(WS_STATUS_PROTOCOL, "Invalid frame size");
+    return 0;
+  }
 
-      if (wsOpCode != WS_OP_CONTINUE) wsMsg.clear();
+  // Check opcode
+  wsOpCode = (OpCode::enum_t)(header[0] & 0xf);
 
-      // Check total message size
-      auto msgSize = wsMsg.size() + bytesToRead;
-      if (maxMessageSize && maxMessageSize < msgSize)
-        return close(WS_STATUS_TOO_BIG,
-          SSTR("Message size " << msgSize << ">" << maxMessageSize));
+  LOG_DEBUG(4, CBANG_FUNC << "() opcode=" << wsOpCode
+            << " bytes=" << bytesToRead);
 
-      // Copy mask
-      if (mask) memcpy(wsMask, &header[bytes - 4], 4);
+  // Control frames may be interleaved with the fragments of a message
+  bool isData = !(wsOpCode & 8);
+  if (isData && wsOpCode != WS_OP_CONTINUE) {
+    wsMsg.clear();
+    msgOpCode = wsOpCode;
+  }
 
-      // Last part of message?
-      wsFinish = header[0] & (1 << 7);
+  // Check total message size
+  auto msgSize = wsMsg.size() + bytesToRead;
+  if ((maxMessageSize && maxMessageSize < msgSize) ||
+      std::numeric_limits<unsigned>::max() - bytes < bytesToRead) {
+    close(WS_STATUS_TOO_BIG,
+          SSTR("Message size " << msgSize << ">" << maxMessageSize));
+    return 0;
+  }
 
-      // Control frames must not be fragmented
-      if ((wsOpCode & 8) && !wsFinish)
-        return close(WS_STATUS_PROTOCOL, "Fragmented control frame");
+  // Copy mask
+  if (mask) memcpy(wsMask, &header[bytes - 4], 4);
 
-      readBody();
-    };
+  // Last part of message?
+  wsFinish = header[0] & (1 << 7);
 
-    // Read rest of header
-    getConnection()->read(WeakCall(this, cb), input, bytes);
-  };
+  // Control frames must not be fragmented
+  if ((wsOpCode & 8) && !wsFinish) {
+    close(WS_STATUS_PROTOCOL, "Fragmented control frame");
+    return 0;
+  }
 
-  // Read first part of header
-  getConnection()->read(WeakCall(this, cb), input, 2);
+  headerSize = bytes;
+  return 0;
 }
 
 
 void Websocket::readBody() {
-  auto cb = [this] (bool success) {
-    if (!success) return close(WS_STATUS_PROTOCOL, "Failed to ready body");
+  // The payload is at the front of the input buffer
+  bool incoming = connection->isIncoming();
 
-    if (bytesToRead) {
-      uint64_t offset = wsMsg.size();
-      wsMsg.resize(offset + bytesToRead);
-      input.remove(&wsMsg[offset], bytesToRead);
+  if (!(wsOpCode & 8) && wsFinish && wsMsg.empty()) {
+    // Unfragmented message, deliver it from the buffer.  The pullup does not
+    // copy if the frame arrived in one read.
+    char *data = input.pullup(bytesToRead);
+    if (incoming) mask(data, bytesToRead, wsMask);
 
-      // Demask client messages
-      if (connection->isIncoming())
-        for (uint64_t i = 0; i < bytesToRead; i++)
-          wsMsg[offset +  i] ^= wsMask[i & 3];
+    LOG_DEBUG(5, "Frame body\n" << String::hexdump(data, bytesToRead)
+              << '\n');
 
-      LOG_DEBUG(5, "Frame body\n"
-                << String::hexdump(string(wsMsg.begin() + offset, wsMsg.end()))
-                << '\n');
-    }
+    message(data, bytesToRead);
+    input.drain(bytesToRead);
+    return;
+  }
 
-    switch (wsOpCode) {
-    case WS_OP_CONTINUE:
-    case WS_OP_TEXT:
-    case WS_OP_BINARY:
-      if (wsFinish) {
-        message(wsMsg.data(), wsMsg.size());
-        wsMsg.clear();
-      }
-      break;
+  uint64_t offset = wsMsg.size();
+  if (bytesToRead) {
+    wsMsg.resize(offset + bytesToRead);
+    input.remove(&wsMsg[offset], bytesToRead);
 
-    case WS_OP_CLOSE: {
-      // Get close status
-      Status status = WS_STATUS_NONE;
-      if (1 < bytesToRead)
-        status = (Status::enum_t)hton16(*(uint16_t *)wsMsg.data());
+    // Demask client messages
+    if (incoming) mask(&wsMsg[offset], bytesToRead, wsMask);
 
-      // Send close response and close payload if any
-      string payload;
-      if (2 < wsMsg.size()) payload = string(wsMsg.begin() + 2, wsMsg.end());
-      return close(status, payload);
+    LOG_DEBUG(5, "Frame body\n"
+              << String::hexdump(&wsMsg[offset], bytesToRead) << '\n');
+  }
+
+  switch (wsOpCode) {
+  case WS_OP_CONTINUE:
+  case WS_OP_TEXT:
+  case WS_OP_BINARY:
+    if (wsFinish) {
+      message(wsMsg.data(), wsMsg.size());
+      wsMsg.clear();
     }
+    break;
+
+  case WS_OP_CLOSE: {
+    // Get close status
+    Status status = WS_STATUS_NONE;
+    if (1 < bytesToRead)
+      status = (Status::enum_t)hton16(*(uint16_t *)&wsMsg[offset]);
+
+    // Send close response and close payload if any
+    string payload;
+    if (2 < bytesToRead)
+      payload = string(wsMsg.begin() + offset + 2, wsMsg.end());
+    wsMsg.resize(offset);
+    return close(status, payload);
+  }
 
-    case WS_OP_PING: onPing(string(wsMsg.begin(), wsMsg.end())); break;
-    case WS_OP_PONG: onPong(string(wsMsg.begin(), wsMsg.end())); break;
+  case WS_OP_PING: case WS_OP_PONG: {
+    string payload(wsMsg.begin() + offset, wsMsg.end());
+    wsMsg.resize(offset);
+
+    if (wsOpCode == WS_OP_PING) onPing(payload);
+    else onPong(payload);
+    break;
+  }
+
+  default: return close(WS_STATUS_PROTOCOL, "Invalid opcode");
+  }
+}
 
-    default: return close(WS_STATUS_PROTOCOL, "Invalid opcode");
-    }
 
-    // Read next message
-    if (isActive()) readHeader();
+void Websocket::readMore(unsigned bytes) {
+  auto cb = [this] (bool success) {
+    if (success) readFrames();
+    else close(WS_STATUS_PROTOCOL, "Failed to read frame");
   };
 
-  getConnection()->read(WeakCall(this, cb), input, bytesToRead);
+  // Read ahead so small frames arriving together need only one read
+  const unsigned readAhead = 64 * 1024;
+  unsigned length = input.getLength() + readAhead;
+  if (length < bytes) length = bytes;
+
+  getConnection()->readAtLeast(WeakCall(this, cb), input, bytes, length);
 }
 
 
@@ -319,38 +453,39 @@ void Websocket::onPong(const string &payload) {
 }
 
 
-void Websocket::writeFrame(
-  OpCode opcode, bool finish, const void *data, uint64_t len) {
-  LOG_DEBUG(4, CBANG_FUNC << '(' << opcode << ", " << finish << ", " << len
-            << ')');
-
-  if (!isActive()) {
-    close(WS_STATUS_DIRTY_CLOSE, "Write attempted when inactive");
-    THROW("Websocket not active");
-  }
-
-  uint8_t header[14];
-  uint8_t bytes = 2;
-
+unsigned Websocket::writeHeader(
+  uint8_t *header, OpCode opcode, bool finish, uint64_t len) {
   // Opcode
   header[0] = (finish ? (1 << 7) : 0) | opcode;
 
   // Format payload length
-  if (len < 126) header[1] = len;
+  if (len < 126) {
+    header[1] = len;
+    return 2;
+  }
 
-  else if (len <= 0xffff) {
+  if (len <= 0xffff) {
     header[1] = 126;
     (uint16_t &)header[2] = hton16(len);
-    bytes = 4;
-
-  } else {
-    header[1] = 127;
-    (uint64_t &)header[2] = hton64(len);
-    bytes = 10;
+    return 4;
   }
 
+  header[1] = 127;
+  (uint64_t &)header[2] = hton64(len);
+  return 10;
+}
+
+
+void Websocket::writeFrame(
+  OpCode opcode, bool finish, const void *data, uint64_t len) {
+  LOG_DEBUG(4, CBANG_FUNC << '(' << opcode << ", " << finish << ", " << len
+            << ')');
+
+  uint8_t header[14];
+  uint8_t bytes = writeHeader(header, opcode, finish, len);
+
   // Create mask
-  bool mask = !connection->isIncoming();
+  bool mask = connection.isSet() && !connection->isIncoming();
   if (mask) {
     header[1] |= 1 << 7; // Set mask bit
 
@@ -365,15 +500,24 @@ void Websocket::writeFrame(
   out.add((char *)data, len);
 
   // Mask data
-  if (mask) {
-    uint8_t *ptr  = (uint8_t *)out.pullup(len + bytes) + bytes;
-    uint8_t *mask = &header[bytes - 4];
+  if (mask) WS::mask(out.pullup(len + bytes) + bytes, len, &header[bytes - 4]);
+
+  write(out, opcode);
+}
+
 
-    for (uint64_t i = 0; i < len; i++)
-      ptr[i] ^= mask[i & 3];
+void Websocket::write(const Event::Buffer &out, OpCode opcode) {
+  if (!isActive()) {
+    close(WS_STATUS_DIRTY_CLOSE, "Write attempted when inactive");
+    THROW("Websocket not active");
   }
 
-  auto cb = [this, opcode] (bool success) {
+  unsigned length = out.getLength();
+  bytesQueued += length;
+
+  auto cb = [this, opcode, length] (bool success) {
+    bytesQueued -= length;
+
     // Close connection if write fails or this is a close op code
     if (!success || opcode == WS_OP_CLOSE) shutdown();
   };
@@ -433,7 +577,7 @@ void Websocket::message(const char *data, uint64_t length) {
 void Websocket::start() {
   active = true;
   onOpen();
-  readHeader();
+  readFrames();
   schedulePing();
 }
 
@@ -49,15 +49,27 @@ namespace cb {
 
   namespace WS {
     class Websocket : virtual public RefCounted, public Enum {
+    public:
+      typedef enum {
+        OVERFLOW_DROP,  // Drop pre-framed messages while the queue is full
+        OVERFLOW_CLOSE, // Close the connection when the queue is full
+      } overflow_t;
+
+    private:
       SmartPointer<HTTP::Conn>::Weak connection;
       uint64_t id = ~0;
       bool active = false;
 
       unsigned maxMessageSize = std::numeric_limits<int>::max();
 
+      std::string protocols;
+      std::string protocol;
+
       Event::Buffer input;
+      unsigned headerSize = 0;
       uint64_t bytesToRead = 0;
       OpCode wsOpCode;
+      OpCode msgOpCode = WS_OP_TEXT;
       uint8_t wsMask[4];
       bool wsFinish = false;
       std::vector<char> wsMsg;
@@ -66,8 +78,13 @@ namespace cb {
       SmartPointer<Event::Event> pingEvent;
       SmartPointer<Event::Event> pongEvent;
 
+      uint64_t maxQueued = 0;
+      overflow_t overflow = OVERFLOW_DROP;
+      uint64_t bytesQueued = 0;
+
       uint64_t msgSent = 0;
       uint64_t msgReceived = 0;
+      uint64_t msgDropped = 0;
 
     public:
       Websocket(const SmartPointer<HTTP::Conn> &conn = 0) : connection(conn) {}
@@ -80,27 +97,52 @@ namespace cb {
       const SmartPointer<HTTP::Conn>::Weak &getConnection() const
       {return connection;}
 
+      /// Subprotocols requested by connect(), most preferred first
+      const std::string &getProtocols() const {return protocols;}
+      void setProtocols(const std::string &protocols)
+      {this->protocols = protocols;}
+
+      /// The subprotocol agreed in the handshake, if any
+      const std::string &getProtocol() const {return protocol;}
+
+      /// The opcode of the message being delivered, text or binary
+      OpCode getMessageOpCode() const {return msgOpCode;}
+
       unsigned getMaxMessageSize() const {return maxMessageSize;}
       void setMaxMessageSize(unsigned size) {maxMessageSize = size;}
 
+      uint64_t getMaxQueued() const {return maxQueued;}
+      void setMaxQueued(uint64_t bytes) {maxQueued = bytes;}
+      overflow_t getOverflow() const {return overflow;}
+      void setOverflow(overflow_t overflow) {this->overflow = overflow;}
+      uint64_t getBytesQueued() const {return bytesQueued;}
+
       uint64_t getMessagesSent() const {return msgSent;}
       uint64_t getMessagesReceived() const {return msgReceived;}
+      uint64_t getMessagesDropped() const {return msgDropped;}
 
       SmartPointer<HTTP::Conn> connect(HTTP::Client &client, const URI &uri);
 
-      void send(const char *data, unsigned length);
+      void send(const char *data, unsigned length,
+                OpCode opcode = WS_OP_TEXT);
       void send(const std::string &s);
       void send(const char *s) {send(std::string(s));}
+      bool sendFrames(const Event::Buffer &frames);
+
+      static Event::Buffer frame(const char *data, unsigned length,
+                                 OpCode opcode = WS_OP_TEXT);
+      static Event::Buffer frame(const std::string &s,
+                                 OpCode opcode = WS_OP_TEXT);
 
       void close(Status status, const std::string &msg);
       void ping(const std::string &payload = "");
 
       void upgrade(HTTP::Request &req);
 
-      void readHeader();
-      void readBody();
+      void readFrames();
 
       // Callbacks
+      virtual bool acceptProtocol(const std::string &protocol) {return false;}
       virtual void onOpen() {}
       virtual void onMessage(const char *data, uint64_t length) = 0;
       virtual void onClose(Status status, const std::string &msg) {}
@@ -109,8 +151,14 @@ namespace cb {
       virtual void onPong(const std::string &payload);
 
     protected:
+      unsigned readHeader();
+      void readBody();
+      void readMore(unsigned bytes);
+      static unsigned writeHeader(
+        uint8_t *header, OpCode opcode, bool finish, uint64_t len);
       void writeFrame(
         OpCode opcode, bool finish, const void *data, uint64_t len);
+      void write(const Event::Buffer &out, OpCode opcode);
       void pong();
       void schedulePong();
       void schedulePing();
@@ -34,26 +34,47 @@
 
 #include <cbang/json/Value.h>
 #include <cbang/json/Reader.h>
+#include <cbang/json/BufferReader.h>
+#include <cbang/json/StringWriter.h>
 #include <cbang/json/YAMLReader.h>
+#include <cbang/json/CBORWriter.h>
+#include <cbang/json/CBORReader.h>
+#include <cbang/json/MessagePackWriter.h>
+#include <cbang/json/MessagePackReader.h>
+#include <cbang/json/Selector.h>
+#include <cbang/String.h>
+#include <cbang/os/SystemUtilities.h>
 
 #include <iostream>
+#include <algorithm>
 
 using namespace std;
 using namespace cb::JSON;
 
 
+ValuePtr parse(bool buffer, bool strict) {
+  if (!buffer) return Reader(cin, strict).parse();
+
+  string input = cb::SystemUtilities::read(cin);
+  return BufferReader(input, strict).parse();
+}
+
+
 int main(int argc, char *argv[]) {
   try {
     ValuePtr data;
 
+    // --buffer runs the same cases through BufferReader
+    bool buffer = 1 < argc && string(argv[argc - 1]) == "--buffer";
+    if (buffer) argc--;
+
     // Malformed UTF-8 is repaired by default and rejected with --strict, so the
     // two behaviors need separate cases over the same inputs.  Print why it was
     // rejected rather than letting it reach the handler below: the message is
     // the point of the case, and a stack trace is not comparable between builds.
     if (argc == 2 && string(argv[1]) == "--strict") {
       try {
-        Reader reader(cin, true);
-        data = reader.parse();
+        data = parse(buffer, true);
         if (!data.isNull()) cout << *data;
       } catch (const cb::Exception &e) {
         cout << "rejected: " << e.getMessage() << endl;
@@ -69,9 +90,97 @@ int main(int argc, char *argv[]) {
         cout << *docs[i];
       }
 
-    } else {
+    } else if (argc == 2 && string(argv[1]) == "--shortest") {
+      // Write doubles with the shortest text that reads back exactly
+      data = parse(buffer, false);
+      cout << StringWriter::toString(*data);
+
+    } else if (argc == 2 && string(argv[1]) == "--cbor") {
+      // Encode as CBOR, print the encoding and then the decoded value
+      Reader reader(cin);
+      string cbor = CBORWriter::encode(*reader.parse());
+
+      for (unsigned i = 0; i < cbor.size(); i++)
+        cout << cb::String::printf("%02x", (uint8_t)cbor[i]);
+      cout << '\n' << *CBORReader::parse(cbor);
+
+    } else if (argc == 2 && string(argv[1]) == "--cbor-decode") {
+      // Decode each line of hex encoded CBOR
+      string line;
+      while (getline(cin, line)) {
+        string cbor;
+        for (unsigned i = 0; i + 1 < line.size(); i += 2)
+          cbor += (char)stoi(line.substr(i, 2), 0, 16);
+
+        try {
+          cout << CBORReader::parse(cbor)->toString(0, true) << '\n';
+        } catch (const cb::Exception &e) {
+          cout << "rejected: " << e.getMessage() << '\n';
+        }
+      }
+
+    } else if (argc == 2 && string(argv[1]) == "--msgpack") {
+      // Encode as MessagePack, print the encoding and then the decoded value
       Reader reader(cin);
-      data = reader.parse();
+      string msgpack = MessagePackWriter::encode(*reader.parse());
+
+      for (unsigned i = 0; i < msgpack.size(); i++)
+        cout << cb::String::printf("%02x", (uint8_t)msgpack[i]);
+      cout << '\n' << *MessagePackReader::parse(msgpack);
+
+    } else if (argc == 2 && string(argv[1]) == "--msgpack-decode") {
+      // Decode each line of hex encoded MessagePack
+      string line;
+      while (getline(cin, line)) {
+        string msgpack;
+        for (unsigned i = 0; i + 1 < line.size(); i += 2)
+          msgpack += (char)stoi(line.substr(i, 2), 0, 16);
+
+        try {
+          cout << MessagePackReader::parse(msgpack)->toString(0, true) << '\n';
+        } catch (const cb::Exception &e) {
+          cout << "rejected: " << e.getMessage() << '\n';
+        }
+      }
+
+    } else if (argc == 3 && string(argv[1]) == "--select") {
+      // Select comma separated paths while parsing and check the result
+      // against selecting each path from the whole document
+      vector<string> paths;
+      cb::String::tokenize(argv[2], paths, ",");
+
+      string input = cb::SystemUtilities::read(cin);
+      data = Selector::select(input, paths);
+      cout << *data << '\n';
+
+      auto doc = BufferReader::parse(input);
+      for (auto &path: paths) {
+        auto value = Path(path).select(*doc, ValuePtr());
+        if (value.isNull() ? data->has(path) : *value != *data->get(path))
+          cout << "mismatch: " << path << '\n';
+      }
+
+    } else if (argc == 3 && string(argv[1]) == "--erase") {
+      // Erase comma separated keys from a dict and check every key is found,
+      // or not, afterwards
+      vector<string> keys;
+      cb::String::tokenize(argv[2], keys, ",");
+
+      data = parse(buffer, false);
+      auto orig = data->copy();
+      for (auto &key: keys) data->erase(key);
+      cout << *data << '\n';
+
+      for (auto e: orig->entries()) {
+        bool erased = find(keys.begin(), keys.end(), e.key()) != keys.end();
+        auto it = data->find(e.key());
+
+        if (erased ? !!it : !it || *it.value() != *e.value())
+          cout << "mismatch: " << e.key() << '\n';
+      }
+
+    } else {
+      data = parse(buffer, false);
       if (!data.isNull()) cout << *data;
     }
 
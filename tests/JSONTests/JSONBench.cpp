@@ -0,0 +1,130 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2021-2026, Cauldron Development  Oy
+                Copyright (c) 2003-2021, Cauldron Development LLC
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include <cbang/Catch.h>
+
+#include <cbang/json/Reader.h>
+#include <cbang/json/BufferReader.h>
+#include <cbang/json/Builder.h>
+#include <cbang/json/NullSink.h>
+#include <cbang/os/SystemUtilities.h>
+#include <cbang/time/Timer.h>
+#include <cbang/String.h>
+
+#include <iostream>
+#include <functional>
+
+using namespace std;
+using namespace cb;
+using namespace cb::JSON;
+
+
+// Compares Reader and BufferReader.  Pass real payloads as files, otherwise a
+// list of timeseries style entries is generated.  Not run by the test suite.
+//
+//   JSONBench [-n <iterations>] [<file>...]
+
+
+string example() {
+  string s = "[";
+
+  for (unsigned i = 0; i < 1000; i++)
+    s += SSTR((i ? "," : "") << "\n  {\"time\": \"2024-01-01T00:00:"
+              << String::printf("%02u", i % 60) << "Z\", \"data\": {"
+              << "\"id\": " << (1000000 + i) << ", \"load\": " << i * 0.37
+              << ", \"name\": \"client-" << i << "\", \"ok\": true}}");
+
+  return s + "\n]\n";
+}
+
+
+double bench(unsigned n, const string &data,
+             const function<void (const string &data)> &parse) {
+  Timer timer(true);
+  for (unsigned i = 0; i < n; i++) parse(data);
+  return n * data.size() / timer.delta() / (1 << 20);
+}
+
+
+void run(unsigned n, const string &name, const string &data) {
+  auto reader = [] (const string &data) {
+    Builder builder;
+    Reader(InputSource(data)).parse(builder);
+  };
+
+  auto bufferReader = [] (const string &data) {
+    Builder builder;
+    BufferReader(data).parse(builder);
+  };
+
+  auto readerNull = [] (const string &data) {
+    NullSink sink;
+    Reader(InputSource(data)).parse(sink);
+  };
+
+  auto bufferReaderNull = [] (const string &data) {
+    NullSink sink;
+    BufferReader(data).parse(sink);
+  };
+
+  cout << name << " (" << data.size() << " bytes x " << n << ")\n"
+       << String::printf("  %-22s %8.1f MiB/s\n", "Reader",
+                         bench(n, data, reader))
+       << String::printf("  %-22s %8.1f MiB/s\n", "BufferReader",
+                         bench(n, data, bufferReader))
+       << String::printf("  %-22s %8.1f MiB/s\n", "Reader, no DOM",
+                         bench(n, data, readerNull))
+       << String::printf("  %-22s %8.1f MiB/s\n", "BufferReader, no DOM",
+                         bench(n, data, bufferReaderNull));
+}
+
+
+int main(int argc, char *argv[]) {
+  try {
+    unsigned n = 100;
+    vector<string> files;
+
+    for (int i = 1; i < argc; i++)
+      if (string(argv[i]) == "-n" && i + 1 < argc)
+        n = String::parseU32(argv[++i]);
+      else files.push_back(argv[i]);
+
+    if (files.empty()) run(n, "<example>", example());
+
+    for (auto &path: files)
+      run(n, path, SystemUtilities::read(path));
+
+    return 0;
+
+  } CBANG_CATCH_ERROR;
+  return 1;
+}
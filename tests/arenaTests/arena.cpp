@@ -0,0 +1,134 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2021-2026, Cauldron Development  Oy
+                Copyright (c) 2003-2021, Cauldron Development LLC
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+
+#include <cbang/util/Arena.h>
+#include <cbang/Catch.h>
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <memory>
+
+using namespace cb;
+using namespace std;
+
+
+void print(const char *msg, const Arena &arena) {
+  cout << msg << ": allocations=" << arena.getAllocations()
+       << " bytes=" << arena.getBytes()
+       << " blocks=" << arena.getBlockCount() << endl;
+}
+
+
+bool aligned(void *ptr, size_t align) {return !((uintptr_t)ptr % align);}
+
+
+void testArena() {
+  auto arena = Arena::create();
+  print("new", *arena);
+
+  bool ok = true;
+  for (unsigned i = 1; i < 64; i++) {
+    size_t align = (size_t)1 << (i % 5);
+    ok = aligned(arena->allocate(i, align), align) && ok;
+  }
+  cout << "aligned=" << ok << endl;
+  print("small", *arena);
+
+  for (unsigned i = 0; i < 16; i++) arena->allocate(512);
+  print("blocks", *arena);
+
+  unsigned blocks = arena->getBlockCount();
+  arena->allocate(Arena::BLOCK_SIZE * 2);
+  cout << "large uses a block=" << (blocks != arena->getBlockCount()) << endl;
+
+  arena->reset();
+  print("reset", *arena);
+}
+
+
+void testAllocator() {
+  auto arena = Arena::create();
+
+  {
+    ArenaAllocator<int> alloc(arena);
+    vector<int, ArenaAllocator<int>> v(alloc);
+    for (int i = 0; i < 1000; i++) v.push_back(i);
+
+    int sum = 0;
+    for (auto x: v) sum += x;
+    cout << "sum=" << sum << endl;
+
+    typedef basic_string<char, char_traits<char>, ArenaAllocator<char>> str_t;
+    str_t s(alloc);
+    for (int i = 0; i < 10; i++) s += "0123456789";
+    cout << "length=" << s.length() << endl;
+
+    cout << "refs=" << arena.getRefCount() << endl;
+  }
+
+  cout << "refs=" << arena.getRefCount() << endl;
+  print("containers", *arena);
+
+  // Shared objects keep the Arena alive
+  Arena *ptr = arena.get();
+  auto shared = allocate_shared<string>(ArenaAllocator<string>(arena), "abc");
+  arena.release();
+  print("shared", *ptr);
+  cout << "value=" << *shared << endl;
+
+  // Without an Arena the allocator uses the heap
+  vector<int, ArenaAllocator<int>> heap;
+  heap.push_back(1);
+  cout << "heap=" << heap.back() << endl;
+}
+
+
+int main(int argc, char *argv[]) {
+  try {
+    if (argc != 2) {
+      cout << "Usage: " << argv[0] << " arena|allocator" << endl;
+      return 1;
+    }
+
+    string test = argv[1];
+    if (test == "arena") testArena();
+    else if (test == "allocator") testAllocator();
+    else THROW("Unknown test " << test);
+
+    return 0;
+
+  } CATCH_ERROR;
+
+  return 1;
+}
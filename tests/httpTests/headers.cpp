@@ -0,0 +1,112 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2021-2026, Cauldron Development  Oy
+                Copyright (c) 2003-2021, Cauldron Development LLC
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+// Test driver for HTTP::Headers.  Parses the header lines on stdin, applies
+// the operations given as arguments in order and prints the headers:
+//
+//   headers [--fill <n>] [get:<name> | insert:<name>=<value> |
+//     prepend:<name>=<value> | remove:<name>]... < headers
+//
+// --fill appends <n> distinct headers to the input before parsing and only
+// the number of headers is printed.
+
+#include <cbang/Catch.h>
+#include <cbang/Exception.h>
+#include <cbang/String.h>
+#include <cbang/http/Headers.h>
+#include <cbang/event/Buffer.h>
+
+#include <iostream>
+
+using namespace cb;
+using namespace std;
+
+
+int main(int argc, char *argv[]) {
+  try {
+    int i = 1;
+    unsigned fill = 0;
+    if (i + 1 < argc && string(argv[i]) == "--fill") {
+      fill = String::parseU32(argv[i + 1]);
+      i += 2;
+    }
+
+    string input;
+    string line;
+    while (getline(cin, line)) input += line + "\r\n";
+    for (unsigned j = 0; j < fill; j++)
+      input += SSTR("X-Fill-" << j << ": " << j << "\r\n");
+
+    Event::Buffer buf;
+    buf.add(input + "\r\n");
+
+    HTTP::Headers hdrs;
+    try {
+      hdrs.parse(buf);
+    } catch (const Exception &e) {
+      cout << "rejected: " << e.getMessage() << endl;
+      return 0;
+    }
+
+    for (; i < argc; i++) {
+      string arg = argv[i];
+      auto colon = arg.find(':');
+      if (colon == string::npos) THROW("Invalid operation: " << arg);
+
+      string op   = arg.substr(0, colon);
+      string name = arg.substr(colon + 1);
+      string value;
+
+      auto equals = name.find('=');
+      if (equals != string::npos) {
+        value = name.substr(equals + 1);
+        name  = name.substr(0, equals);
+      }
+
+      if (op == "get") {
+        if (hdrs.has(name)) cout << name << " = " << hdrs.get(name) << '\n';
+        else cout << name << " missing\n";
+
+      } else if (op == "insert") hdrs.insert(name, value);
+      else if (op == "prepend") hdrs.insert(name, value, true);
+      else if (op == "remove") hdrs.remove(name);
+      else THROW("Invalid operation: " << arg);
+    }
+
+    if (fill) cout << hdrs.size() << " headers\n";
+    else cout << "--\n" << hdrs;
+
+    return 0;
+  } CATCH_ERROR;
+
+  return 1;
+}
@@ -0,0 +1,150 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2021-2026, Cauldron Development  Oy
+                Copyright (c) 2003-2021, Cauldron Development LLC
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+// Test driver for HTTP pipelining.  Sends a batch of pipelined requests to a
+// server whose handler never replies and prints how many requests the server
+// read, including the first one which is always read:
+//
+//   pipeline <max-pipelined> <requests>
+
+#include <cbang/Catch.h>
+#include <cbang/String.h>
+#include <cbang/http/Server.h>
+#include <cbang/http/Request.h>
+#include <cbang/http/RequestHandlerFactory.h>
+#include <cbang/event/Base.h>
+#include <cbang/event/Event.h>
+#include <cbang/log/Logger.h>
+
+#include <iostream>
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+using namespace cb;
+using namespace std;
+
+
+namespace {
+  class CountingServer : public HTTP::Server {
+  public:
+    unsigned count = 0;
+
+    using HTTP::Server::Server;
+
+    SmartPointer<HTTP::Request>
+    createRequest(const HTTP::RequestParams &params) override {
+      count++;
+      return HTTP::Server::createRequest(params);
+    }
+  };
+
+
+  int connectLoopback(uint16_t port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+
+    sockaddr_in addr = {};
+    addr.sin_family      = AF_INET;
+    addr.sin_port        = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    if (connect(fd, (sockaddr *)&addr, sizeof(addr)))
+      THROW("Failed to connect to port " << port);
+
+    return fd;
+  }
+
+
+  uint16_t freePort() {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+
+    sockaddr_in addr = {};
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+
+    if (::bind(fd, (sockaddr *)&addr, len) ||
+        getsockname(fd, (sockaddr *)&addr, &len))
+      THROW("Failed to find a free port");
+
+    close(fd);
+    return ntohs(addr.sin_port);
+  }
+}
+
+
+int main(int argc, char *argv[]) {
+  try {
+    if (argc != 3) THROW("Usage: " << argv[0] << " <max-pipelined> <requests>");
+
+    Logger::instance().setScreenStream(cerr);
+    Logger::instance().setLogTime(false);
+    Logger::instance().setLogColor(false);
+    Exception::printLocations    = false;
+    Exception::enableStackTraces = false;
+
+    unsigned maxPipelined = String::parseU32(argv[1]);
+    unsigned requests     = String::parseU32(argv[2]);
+
+    Event::Base base;
+    CountingServer server(base);
+    server.setMaxPipelined(maxPipelined);
+
+    // Hold every request without replying
+    auto cb = [] (HTTP::Request &req) {return true;};
+    server.addHandler(HTTP::RequestHandlerFactory::create(cb));
+
+    uint16_t port = freePort();
+    server.addListenPort(SockAddr::parse("127.0.0.1:" + String(port)));
+
+    string batch;
+    for (unsigned i = 0; i < requests; i++)
+      batch += "GET /" + String(i) + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+
+    int fd = connectLoopback(port);
+    if (write(fd, batch.data(), batch.size()) != (ssize_t)batch.size())
+      THROW("Failed to write requests");
+
+    auto exit = base.newEvent([&base] () {base.loopExit();}, 0);
+    exit->add(0.5);
+    base.loop();
+
+    cout << server.count << endl;
+    close(fd);
+
+    return 0;
+  } CATCH_ERROR;
+
+  return 1;
+}
@@ -0,0 +1,94 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2021-2026, Cauldron Development  Oy
+                Copyright (c) 2003-2021, Cauldron Development LLC
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+// Checks that a Timeseries rollup survives being dropped mid interval.  The
+// first <split> samples of the list on stdin are rolled up and stored as CBOR,
+// as Timeseries does, then a new Rollup is loaded from the stored value and
+// takes the rest.  It should match a Rollup which saw every sample.
+//
+//   rollup <split> < samples.json
+
+#include <cbang/Catch.h>
+#include <cbang/api/Rollup.h>
+#include <cbang/json/Reader.h>
+#include <cbang/json/Builder.h>
+#include <cbang/json/CBORWriter.h>
+#include <cbang/json/CBORReader.h>
+
+#include <iostream>
+
+using namespace std;
+using namespace cb;
+
+
+JSON::ValuePtr toJSON(const API::Rollup &rollup) {
+  return JSON::Builder::build(
+    [&] (JSON::Sink &sink) {rollup.write(sink);});
+}
+
+
+int main(int argc, char *argv[]) {
+  try {
+    if (argc != 2) {
+      cerr << "Usage: " << argv[0] << " <split>" << endl;
+      return 1;
+    }
+
+    unsigned split = stoul(argv[1]);
+    auto samples = JSON::Reader(cin).parse();
+    const uint64_t start = 3600;
+
+    API::Rollup before;
+    API::Rollup whole;
+    before.reset(start);
+    whole.reset(start);
+
+    for (unsigned i = 0; i < samples->size(); i++) {
+      if (i < split) before.add(samples->get(i));
+      whole.add(samples->get(i));
+    }
+
+    string stored = JSON::CBORWriter::encode(before);
+
+    API::Rollup after;
+    after.load(start, *JSON::CBORReader::parse(stored));
+    for (unsigned i = split; i < samples->size(); i++)
+      after.add(samples->get(i));
+
+    cout << "restored: " << toJSON(after)->toString(0, true) << '\n'
+         << "expected: " << toJSON(whole)->toString(0, true) << '\n';
+
+    return 0;
+  } CATCH_ERROR;
+
+  return 1;
+}
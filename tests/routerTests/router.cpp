@@ -0,0 +1,250 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2021-2026, Cauldron Development  Oy
+                Copyright (c) 2003-2021, Cauldron Development LLC
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+// Drives HTTP::HandlerGroup's compiled router and checks it against linear
+// dispatch, trying every handler in turn as HandlerGroup used to.
+//
+//   router <METHOD> <path> [<METHOD> <path> ...]
+//   router --bench [iterations]
+//
+// For each request prints the handlers called, in order, and the URL args.
+// With --bench times both dispatchers with 10, 100 and 1000 routes.
+
+#include <cbang/Catch.h>
+#include <cbang/Exception.h>
+#include <cbang/String.h>
+#include <cbang/http/HandlerGroup.h>
+#include <cbang/http/Request.h>
+#include <cbang/http/RequestParams.h>
+#include <cbang/json/Value.h>
+#include <cbang/log/Logger.h>
+#include <cbang/time/Timer.h>
+
+#include <iostream>
+#include <iomanip>
+
+using namespace cb;
+using namespace cb::HTTP;
+using namespace std;
+
+
+struct Routes {
+  HandlerGroup group;
+  vector<RequestHandlerPtr> linear;
+  vector<string> trace;
+
+
+  RequestHandlerPtr handler(const string &name, bool take = true) {
+    return new RequestFunctionHandler([this, name, take] (Request &req) {
+      trace.push_back(name);
+      return take;
+    });
+  }
+
+
+  void add(unsigned methods, const string &pattern, const string &name,
+           bool take = true) {
+    auto h = handler(name, take);
+    group.addHandler(methods, pattern, h);
+    linear.push_back(group.createMatcher(methods, pattern, h));
+  }
+
+
+  void add(const string &name, bool take) {
+    auto h = handler(name, take);
+    group.addHandler(h);
+    linear.push_back(h);
+  }
+
+
+  void addGroup(unsigned methods, const string &pattern, const string &prefix,
+                const string &name) {
+    auto g = group.addGroup(methods, pattern, prefix);
+    g->addHandler(Method::HTTP_GET, "/ping", handler(name));
+    g->addHandler(Method::HTTP_ANY, "/(?P<rest>.*)", handler(name + "Any"));
+    linear.push_back(group.createMatcher(methods, pattern, g));
+  }
+
+
+  void dispatchLinear(Request &req, const RequestCont &next) {
+    RequestCont chain = next;
+    for (auto it = linear.rbegin(); it != linear.rend(); ++it) {
+      auto handler = *it;
+      RequestCont rest = chain;
+      chain = [handler, rest] (Request &req) {(*handler)(req, rest);};
+    }
+
+    chain(req);
+  }
+
+
+  string run(const string &method, const string &path, bool compiled) {
+    RequestParams params;
+    params.method = Method::parse(method, Method::HTTP_GET);
+    params.uri    = URI(path);
+    Request req(params);
+
+    trace.clear();
+    bool fell = false;
+    auto next = [&fell] (Request &) {fell = true;};
+
+    if (compiled) group(req, next);
+    else dispatchLinear(req, next);
+
+    string s = String::join(trace, ", ");
+    if (fell) s += (s.empty() ? "" : ", ") + string("<next>");
+
+    return s + " " + req.getArgs()->toString();
+  }
+};
+
+
+void addTestRoutes(Routes &r) {
+  r.add(Method::HTTP_ANY, "^/\\.well-known/acme-challenge/.*", "acme");
+  r.add("log", false);
+  r.add(Method::HTTP_GET, "/", "index");
+  r.add(Method::HTTP_GET, "/api/users", "users");
+  r.add(Method::HTTP_GET | Method::HTTP_POST, "/api/users/(?P<id>\\d+)",
+        "user");
+  r.add(Method::HTTP_DELETE, "/api/users/(?P<id>\\d+)", "deleteUser");
+  r.add(Method::HTTP_GET, "/api/(?P<name>[^/]+)/info", "info");
+  r.add(Method::HTTP_GET, "/files/.*", "files", false);
+  r.add(Method::HTTP_GET, "/files/(?P<file>.*)\\.txt", "text");
+  r.add(Method::HTTP_GET, "/files/(?P<file>.*)", "file", false);
+  r.add(Method::HTTP_ANY, "/a/x|/b/y", "alt");
+  r.add(Method::HTTP_GET, "(?i)/case/.*", "case");
+  r.add(Method::HTTP_GET, "/opt?ional", "optional");
+  r.add(Method::HTTP_GET, "/end$", "end");
+  r.add(Method::HTTP_ANY, "/api/users", "anyUsers", false);
+  r.addGroup(Method::HTTP_ANY, "/v2/.*", "/v2", "v2");
+  r.add(Method::HTTP_GET, "", "notFound");
+}
+
+
+void addBenchRoutes(Routes &r, unsigned n) {
+  for (unsigned i = 0; i < n; i++) {
+    string base = SSTR("/api/v1/resource" << i);
+
+    switch (i % 3) {
+    case 0: r.add(Method::HTTP_GET, base, "list"); break;
+    case 1: r.add(Method::HTTP_GET, base + "/(?P<id>\\d+)", "get"); break;
+    case 2:
+      r.add(Method::HTTP_PUT | Method::HTTP_POST, base + "/(?P<id>\\d+)/.*",
+            "set");
+      break;
+    }
+  }
+}
+
+
+string benchPath(unsigned i) {
+  string base = SSTR("/api/v1/resource" << i);
+
+  switch (i % 3) {
+  case 0: return base;
+  case 1: return base + "/42";
+  default: return base + "/42/name";
+  }
+}
+
+
+void bench(unsigned iterations) {
+  cout << setw(6) << "routes" << setw(14) << "linear ns/req"
+       << setw(16) << "compiled ns/req" << setw(9) << "speedup" << endl;
+
+  for (unsigned n: {10, 100, 1000}) {
+    Routes r;
+    addBenchRoutes(r, n);
+
+    vector<SmartPointer<Request>> reqs;
+    for (unsigned i = 0; i < n; i++) {
+      RequestParams params;
+      params.method = i % 3 == 2 ? Method::HTTP_POST : Method::HTTP_GET;
+      params.uri    = URI(benchPath(i));
+      reqs.push_back(new Request(params));
+    }
+
+    auto next = [] (Request &) {THROW("Not routed");};
+    double times[2];
+
+    for (int compiled = 0; compiled < 2; compiled++) {
+      // Stop early after a second, linear dispatch is slow with many routes
+      double start = Timer::now();
+      unsigned i;
+
+      for (i = 0; i < iterations && (i % 16 || Timer::now() < start + 1); i++) {
+        // Stride through the routes so each one is hit equally often
+        Request &req = *reqs[(i * 7919) % n];
+        if (compiled) r.group(req, next);
+        else r.dispatchLinear(req, next);
+      }
+
+      times[compiled] = (Timer::now() - start) * 1e9 / i;
+    }
+
+    cout << fixed << setprecision(1) << setw(6) << n << setw(14) << times[0]
+         << setw(16) << times[1] << setw(8) << times[0] / times[1] << 'x'
+         << endl;
+  }
+}
+
+
+int main(int argc, char *argv[]) {
+  try {
+    Logger::instance().setScreenStream(cerr);
+
+    if (1 < argc && string(argv[1]) == "--bench") {
+      bench(2 < argc ? String::parseU32(argv[2]) : 100000);
+      return 0;
+    }
+
+    Routes r;
+    addTestRoutes(r);
+    int ret = 0;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+      string compiled = r.run(argv[i], argv[i + 1], true);
+      string linear   = r.run(argv[i], argv[i + 1], false);
+
+      cout << argv[i] << ' ' << argv[i + 1] << " => " << compiled << endl;
+
+      if (compiled != linear) {
+        cout << "  MISMATCH linear => " << linear << endl;
+        ret = 1;
+      }
+    }
+
+    return ret;
+  } CATCH_ERROR;
+
+  return 1;
+}
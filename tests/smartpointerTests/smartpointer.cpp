@@ -5,12 +5,15 @@
 //   ./test_smartpointer            -- run all tests
 //   ./test_smartpointer <name>     -- run one named test
 //   ./test_smartpointer --list     -- list all test names
+//   ./test_smartpointer --bench [iterations] -- time common operations
 
 #include <cbang/SmartPointer.h>
 
 #include <atomic>
+#include <chrono>
 #include <cstring>
 #include <functional>
+#include <iomanip>
 #include <iostream>
 #include <map>
 #include <stdexcept>
@@ -484,6 +487,48 @@ bool test_weak_weak_copy() {
   return true;
 }
 
+bool test_make_shared() {
+  Tracker::reset();
+  { auto p = makeShared<Tracker>();
+    CHECK(p.isSet(),           "makeShared pointer set");
+    CHECK(p.getRefCount() == 1, "refcount 1");
+    CHECK(Tracker::live == 1,  "object constructed");
+    SmartPointer<Tracker>::Weak w = p;
+    auto q = p;
+    CHECK(p.getRefCount() == 2, "refcount 2 after copy");
+    p.release(); q.release();
+    CHECK(Tracker::live == 0,  "object destroyed with last strong ref");
+    CHECK(!w.isSet(),          "weak invalid after destroy"); }
+
+  TrackerRC::reset();
+  { auto p = makeShared<TrackerRC>();
+    SmartPointer<TrackerRC> q = p.get();
+    CHECK(p.getRefCount() == 2, "RefCounted reuses the shared counter");
+    bool threw = false;
+    try { q.adopt(); } catch (...) { threw = true; }
+    CHECK(threw, "adopt of makeShared pointer throws"); }
+  CHECK(TrackerRC::live == 0, "RefCounted object destroyed");
+  return true;
+}
+
+bool test_move() {
+  Tracker::reset();
+  SmartPointer<Tracker> a = new Tracker;
+  SmartPointer<Tracker> b = std::move(a);
+  CHECK(a.isNull(),           "source null after move");
+  CHECK(b.getRefCount() == 1, "count unchanged by move construction");
+  SmartPointer<Tracker> c = new Tracker;
+  c = std::move(b);
+  CHECK(b.isNull(),           "source null after move assignment");
+  CHECK(Tracker::live == 1,   "overwritten object freed");
+  CHECK(c.getRefCount() == 1, "count unchanged by move assignment");
+  c = std::move(c);
+  CHECK(c.isSet(),            "self move keeps pointer");
+  c.release();
+  CHECK(Tracker::live == 0,   "object destroyed");
+  return true;
+}
+
 // ---------------------------------------------------------------------------
 // Registry
 // ---------------------------------------------------------------------------
@@ -528,6 +573,46 @@ static void registerAll() {
   REGISTER(test_chain_assignment);
   REGISTER(test_operator_arrow_and_deref);
   REGISTER(test_weak_weak_copy);
+  REGISTER(test_make_shared);
+  REGISTER(test_move);
+}
+
+// ---------------------------------------------------------------------------
+// Benchmarks
+// ---------------------------------------------------------------------------
+struct BenchRC : public RefCounted {int value = 1;};
+
+// Reports the best of several runs to filter out scheduling noise
+template <typename F>
+static void timeIt(const char *name, unsigned iterations, F f) {
+  double best = 0;
+
+  for (int run = 0; run < 5; run++) {
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < iterations; i++) f();
+    std::chrono::duration<double, std::nano> d =
+      std::chrono::steady_clock::now() - start;
+    if (!run || d.count() < best) best = d.count();
+  }
+
+  std::cout << std::left << std::setw(24) << name << std::right
+            << std::fixed << std::setprecision(1) << std::setw(8)
+            << best / iterations << " ns/op\n";
+}
+
+static void bench(unsigned iterations) {
+  SmartPointer<BenchRC> p = new BenchRC;
+  SmartPointer<BenchRC>::Weak w = p;
+  volatile int sink = 0;
+
+  timeIt("copy", iterations, [&] {SmartPointer<BenchRC> c = p;});
+  timeIt("dereference", iterations, [&] {sink = sink + p->value;});
+  timeIt("weak lock", iterations,
+         [&] {SmartPointer<BenchRC> s = w; sink = sink + s->value;});
+  timeIt("new + destroy", iterations,
+         [&] {SmartPointer<BenchRC> s = new BenchRC;});
+  timeIt("makeShared + destroy", iterations,
+         [&] {auto s = makeShared<BenchRC>();});
 }
 
 // ---------------------------------------------------------------------------
@@ -536,6 +621,11 @@ static void registerAll() {
 int main(int argc, char *argv[]) {
   registerAll();
 
+  if (argc >= 2 && std::strcmp(argv[1], "--bench") == 0) {
+    bench(argc >= 3 ? std::stoul(argv[2]) : 2000000);
+    return 0;
+  }
+
   if (argc == 2 && std::strcmp(argv[1], "--list") == 0) {
     for (auto &kv : registry()) std::cout << kv.first << "\n";
     return 0;
@@ -0,0 +1,320 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2021-2026, Cauldron Development  Oy
+                Copyright (c) 2003-2021, Cauldron Development LLC
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+// Test driver for Websocket subprotocol negotiation.
+//
+//   websocket server <offered> <format>:<json>
+//
+// Opens a JSONWebsocket on an HTTP::Server, requests the comma separated
+// <offered> subprotocols, or none if "-", and sends <json> in a text frame
+// when <format> is "json" or else in a binary frame encoded as <format>.
+// Prints the agreed subprotocol, what the server received and its reply.
+//
+//   websocket client <offered> <chosen>
+//
+// Connects a JSONWebsocket which offers <offered> to a server which picks
+// <chosen>, or none if "-".  Prints whether the client opened or closed.
+
+#include <cbang/Catch.h>
+#include <cbang/String.h>
+#include <cbang/http/Server.h>
+#include <cbang/http/Client.h>
+#include <cbang/http/Request.h>
+#include <cbang/http/RequestHandlerFactory.h>
+#include <cbang/event/Base.h>
+#include <cbang/event/Event.h>
+#include <cbang/ws/JSONWebsocket.h>
+#include <cbang/json/BufferReader.h>
+#include <cbang/log/Logger.h>
+#include <cbang/net/URI.h>
+
+#include <iostream>
+#include <thread>
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+using namespace cb;
+using namespace std;
+
+
+namespace {
+  class TestWebsocket : public WS::JSONWebsocket {
+    string name;
+
+  public:
+    TestWebsocket(const string &name) : name(name) {}
+
+    // From WS::JSONWebsocket
+    void onMessage(const JSON::ValuePtr &msg) override {
+      cout << name << " message: " << *msg << endl;
+      send(*msg);
+    }
+
+    void onOpen() override
+      {cout << name << " open: " << getProtocol() << endl;}
+
+    void onClose(WS::Status status, const string &msg) override
+      {cout << name << " close: " << status << ' ' << msg << endl;}
+  };
+
+
+  int listenLoopback(uint16_t &port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+
+    sockaddr_in addr = {};
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+
+    if (::bind(fd, (sockaddr *)&addr, len) || listen(fd, 1) ||
+        getsockname(fd, (sockaddr *)&addr, &len))
+      THROW("Failed to listen on loopback");
+
+    port = ntohs(addr.sin_port);
+    return fd;
+  }
+
+
+  int connectLoopback(uint16_t port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+
+    sockaddr_in addr = {};
+    addr.sin_family      = AF_INET;
+    addr.sin_port        = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    if (connect(fd, (sockaddr *)&addr, sizeof(addr)))
+      THROW("Failed to connect to port " << port);
+
+    return fd;
+  }
+
+
+  uint16_t freePort() {
+    uint16_t port;
+    close(listenLoopback(port));
+    return port;
+  }
+
+
+  void writeAll(int fd, const string &data) {
+    if (write(fd, data.data(), data.size()) != (ssize_t)data.size())
+      THROW("Failed to write");
+  }
+
+
+  // Reads until the end of the HTTP header block
+  string readHeaders(int fd) {
+    string data;
+    char c;
+
+    while (data.find("\r\n\r\n") == string::npos && read(fd, &c, 1) == 1)
+      data += c;
+
+    return data;
+  }
+
+
+  string getHeader(const string &headers, const string &name) {
+    string key = "\r\n" + String::toLower(name) + ":";
+    auto i = String::toLower(headers).find(key);
+    if (i == string::npos) return "";
+
+    i += key.length();
+    return String::trim(headers.substr(i, headers.find("\r\n", i) - i));
+  }
+
+
+  // A client frame with an all zero mask, so the payload is unchanged
+  string maskedFrame(WS::OpCode opcode, const string &payload) {
+    if (125 < payload.size()) THROW("Payload too long");
+
+    string frame;
+    frame += (char)(0x80 | opcode);
+    frame += (char)(0x80 | payload.size());
+    frame += string(4, 0);
+    return frame + payload;
+  }
+
+
+  void printFrames(const string &data) {
+    for (unsigned i = 0; i + 2 <= data.size();) {
+      unsigned opcode = data[i] & 0x0f;
+      unsigned length = data[i + 1] & 0x7f;
+      string payload = data.substr(i + 2, length);
+      i += 2 + length;
+
+      if (opcode == WS::OpCode::WS_OP_TEXT)
+        cout << "reply text: " << payload << '\n';
+
+      else if (opcode == WS::OpCode::WS_OP_BINARY) {
+        cout << "reply binary: ";
+        for (auto c: payload) cout << String::printf("%02x", (uint8_t)c);
+        cout << '\n';
+
+      } else if (opcode == WS::OpCode::WS_OP_CLOSE && 2 <= length)
+        cout << "reply close: "
+             << ((uint8_t)payload[0] << 8 | (uint8_t)payload[1]) << '\n';
+    }
+  }
+
+
+  void server(const string &offered, const string &message) {
+    Event::Base base;
+    HTTP::Server server(base);
+    SmartPointer<TestWebsocket> ws;
+
+    auto cb = [&ws] (HTTP::Request &req) {
+      ws = new TestWebsocket("server");
+      ws->upgrade(req);
+      return true;
+    };
+    server.addHandler(HTTP::RequestHandlerFactory::create(cb));
+
+    uint16_t port = freePort();
+    server.addListenPort(SockAddr::parse("127.0.0.1:" + String(port)));
+
+    size_t colon = message.find(':');
+    string format = message.substr(0, colon);
+    auto value = JSON::BufferReader::parse(message.substr(colon + 1));
+
+    WS::JSONWebsocket::format_t fmt;
+    if (format == "json") fmt = WS::JSONWebsocket::FORMAT_JSON;
+    else if (format == "cbor") fmt = WS::JSONWebsocket::FORMAT_CBOR;
+    else if (format == "msgpack") fmt = WS::JSONWebsocket::FORMAT_MSGPACK;
+    else THROW("Invalid format: " << format);
+
+    string payload;
+    WS::JSONWebsocket::encode(fmt, payload,
+      [&] (JSON::Sink &sink) {value->write(sink);});
+
+    string request =
+      "GET / HTTP/1.1\r\nHost: localhost\r\nUpgrade: websocket\r\n"
+      "Connection: Upgrade\r\nSec-WebSocket-Version: 13\r\n"
+      "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n";
+    if (offered != "-")
+      request += "Sec-WebSocket-Protocol: " + offered + "\r\n";
+    request += "\r\n";
+    bool text = format == "json";
+    request += maskedFrame(text ? WS::OpCode::WS_OP_TEXT :
+                           WS::OpCode::WS_OP_BINARY, payload);
+
+    int fd = connectLoopback(port);
+    writeAll(fd, request);
+
+    auto exit = base.newEvent([&base] () {base.loopExit();}, 0);
+    exit->add(0.5);
+    base.loop();
+
+    string headers = readHeaders(fd);
+    string protocol = getHeader(headers, "Sec-WebSocket-Protocol");
+    cout << "protocol: " << (protocol.empty() ? "-" : protocol) << '\n';
+
+    // The replies have arrived by now, read what is there
+    string frames;
+    char buf[4096];
+    ssize_t n;
+    while (0 < (n = recv(fd, buf, sizeof(buf), MSG_DONTWAIT)))
+      frames.append(buf, n);
+    printFrames(frames);
+
+    close(fd);
+  }
+
+
+  void client(const string &offered, const string &chosen) {
+    uint16_t port;
+    int listenFD = listenLoopback(port);
+
+    // Answer the handshake with <chosen> whatever was offered
+    thread peer([listenFD, chosen] () {
+      int fd = accept(listenFD, 0, 0);
+      readHeaders(fd);
+
+      string response =
+        "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\n"
+        "Connection: Upgrade\r\n"
+        "Sec-WebSocket-Accept: s3pPLMBiTxaQ9kYGzzhZRbK+xOo=\r\n";
+      if (chosen != "-")
+        response += "Sec-WebSocket-Protocol: " + chosen + "\r\n";
+      writeAll(fd, response + "\r\n");
+
+      char c;
+      while (read(fd, &c, 1) == 1) continue;
+      close(fd);
+    });
+
+    Event::Base base;
+    HTTP::Client httpClient(base);
+    SmartPointer<TestWebsocket> ws = new TestWebsocket("client");
+    if (offered != "-") ws->setProtocols(offered);
+
+    URI uri("http://127.0.0.1:" + String(port));
+    auto conn = ws->connect(httpClient, uri);
+
+    auto exit = base.newEvent([&base] () {base.loopExit();}, 0);
+    exit->add(0.5);
+    base.loop();
+
+    conn.release();
+    ws.release();
+    shutdown(listenFD, SHUT_RDWR);
+    close(listenFD);
+    peer.detach();
+  }
+}
+
+
+int main(int argc, char *argv[]) {
+  try {
+    if (argc != 4)
+      THROW("Usage: " << argv[0] << " server|client <offered> <arg>");
+
+    Logger::instance().setScreenStream(cerr);
+    Logger::instance().setLogTime(false);
+    Logger::instance().setLogColor(false);
+    Exception::printLocations    = false;
+    Exception::enableStackTraces = false;
+
+    string mode = argv[1];
+    if (mode == "server") server(argv[2], argv[3]);
+    else if (mode == "client") client(argv[2], argv[3]);
+    else THROW("Invalid mode: " << mode);
+
+    return 0;
+  } CATCH_ERROR;
+
+  return 1;
+}